@@ -9,19 +9,63 @@ CONFIG += c++17
 #DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0x060000    # disables all the APIs deprecated before Qt 6.0.0
 
 SOURCES += \
+    changejournal.cpp \
+    macro.cpp \
+    macroplayer.cpp \
     main.cpp \
     mainwindow.cpp \
+    processfilter.cpp \
     processinfo.cpp \
-    processmanager.cpp
+    processmanager.cpp \
+    processranking.cpp \
+    processsnapshot.cpp \
+    processwatchdog.cpp \
+    snapshotcache.cpp \
+    snapshotexporter.cpp \
+    startuptimeline.cpp \
+    stringpool.cpp \
+    titlewatch.cpp \
+    topprocessesdialog.cpp \
+    tracer.cpp \
+    win32backend.cpp \
+    windowanimator.cpp \
+    windowbackend.cpp \
+    windowspatialindex.cpp \
+    windowtree.cpp \
+    windowtreedialog.cpp
 
 HEADERS += \
+    changejournal.h \
+    macro.h \
+    macroplayer.h \
     mainwindow.h \
+    platform.h \
+    processfilter.h \
     processinfo.h \
-    processmanager.h
+    processmanager.h \
+    processranking.h \
+    processsnapshot.h \
+    processwatchdog.h \
+    snapshotcache.h \
+    snapshotexporter.h \
+    startuptimeline.h \
+    stringpool.h \
+    titlewatch.h \
+    topprocessesdialog.h \
+    tracer.h \
+    win32backend.h \
+    windowanimator.h \
+    windowbackend.h \
+    windowspatialindex.h \
+    windowtree.h \
+    windowtreedialog.h
 
 FORMS += \
     mainwindow.ui
 
+# GetProcessMemoryInfo, DwmGetWindowAttribute
+win32: LIBS += -lpsapi -ldwmapi
+
 # Default rules for deployment.
 qnx: target.path = /tmp/$${TARGET}/bin
 else: unix:!android: target.path = /opt/$${TARGET}/bin
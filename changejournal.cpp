@@ -0,0 +1,373 @@
+#include "changejournal.h"
+#include "tracer.h"
+
+#pragma region Constructor and Destructor
+
+/**
+ * @brief Creates an empty journal.
+ */
+ChangeJournal::ChangeJournal(WindowBackend *backend, qint64 maxBytes)
+    : backend(backend ? backend : WindowBackend::systemBackend()), maxBytes(maxBytes), usedBytes(0), open(false),
+      unverified(0) {
+    pending.committedAt = 0;
+    pending.bytes = 0;
+}
+
+/**
+ * @brief Destructor.
+ */
+ChangeJournal::~ChangeJournal() {}
+
+#pragma endregion
+
+#pragma region Transactions
+
+/**
+ * @brief Starts staging changes.
+ */
+bool ChangeJournal::begin(const QString &label) {
+    if (open) {
+        return false;
+    }
+    open = true;
+    pending.label = label;
+    return true;
+}
+
+/**
+ * @brief Returns true while a transaction is being staged.
+ */
+bool ChangeJournal::isOpen() const {
+    return open;
+}
+
+/**
+ * @brief Stages a new window title.
+ */
+void ChangeJournal::setTitle(HWND hWnd, const QString &title) {
+    if (open) {
+        staged(hWnd, Title).title[1] = title;
+    }
+}
+
+/**
+ * @brief Stages the TopMost flag.
+ */
+void ChangeJournal::setTopMost(HWND hWnd, bool topMost) {
+    if (open) {
+        staged(hWnd, TopMost).topMost[1] = topMost;
+    }
+}
+
+/**
+ * @brief Stages a new window rectangle.
+ */
+void ChangeJournal::setGeometry(HWND hWnd, const RECT &rect) {
+    if (open) {
+        staged(hWnd, Geometry).geometry[1] = rect;
+    }
+}
+
+/**
+ * @brief Stages a new opacity.
+ */
+void ChangeJournal::setOpacity(HWND hWnd, int opacity) {
+    if (open) {
+        staged(hWnd, Opacity).opacity[1] = static_cast<quint8>(qBound(0, opacity, 255));
+    }
+}
+
+/**
+ * @brief Records the old values, applies the staged changes as one batch and adds the entry to the history.
+ */
+int ChangeJournal::commit() {
+    if (!open) {
+        return 0;
+    }
+    TRACE_SCOPE("ChangeJournal::commit");
+
+    Entry entry;
+    entry.label = pending.label;
+    entry.committedAt = backend->tickCount();
+    entry.bytes = 0;
+    entry.changes.reserve(pending.changes.size());
+    for (Change &change : pending.changes) {
+        if (recordCurrent(change)) {
+            entry.changes.append(change);
+        }
+    }
+    rollback();
+    if (entry.changes.isEmpty()) {
+        return 0;
+    }
+
+    int applied = apply(entry, 1, false);   // The owners were just recorded
+
+    for (const Entry &undone : redoEntries) {
+        usedBytes -= undone.bytes;
+    }
+    redoEntries.clear();
+    if (!mergeIntoLast(entry)) {
+        entry.bytes = entryBytes(entry);
+        usedBytes += entry.bytes;
+        undoEntries.append(entry);
+    }
+    trim();
+    return applied;
+}
+
+/**
+ * @brief Discards the staged changes.
+ */
+void ChangeJournal::rollback() {
+    open = false;
+    pending.label.clear();
+    pending.changes.clear();
+    pendingIndex.clear();
+}
+
+// Staged change of a window, created on first use; marks the property as staged
+ChangeJournal::Change &ChangeJournal::staged(HWND hWnd, Property property) {
+    auto it = pendingIndex.constFind(hWnd);
+    int index;
+    if (it != pendingIndex.constEnd()) {
+        index = it.value();
+    } else {
+        Change change = { hWnd, 0, 0, 0, { 255, 255 }, { false, false }, { {}, {} }, { QString(), QString() } };
+        index = static_cast<int>(pending.changes.size());
+        pending.changes.append(change);
+        pendingIndex.insert(hWnd, index);
+    }
+    Change &change = pending.changes[index];
+    change.properties |= property;
+    return change;
+}
+
+// Fill in the owning process and the current values of the staged properties; false if the window is gone
+bool ChangeJournal::recordCurrent(Change &change) {
+    change.processId = backend->windowProcessId(change.hWnd);
+    if (change.processId == 0) {
+        return false;
+    }
+    change.creationTime = backend->processCreationTime(change.processId);
+
+    if (change.properties & Title) {
+        const int titleCapacity = 512;
+        char16_t title[titleCapacity];
+        int length = backend->windowTitle(change.hWnd, title, titleCapacity);
+        change.title[0] = QString::fromUtf16(title, length);
+    }
+    if (change.properties & TopMost) {
+        change.topMost[0] = backend->isTopMost(change.hWnd);
+    }
+    if ((change.properties & Geometry) && !backend->windowRect(change.hWnd, change.geometry[0])) {
+        return false;
+    }
+    if (change.properties & Opacity) {
+        int opacity = 255;  // Windows that are not layered are fully opaque
+        backend->windowOpacity(change.hWnd, opacity);
+        change.opacity[0] = static_cast<quint8>(opacity);
+    }
+    return true;
+}
+
+// Merge a commit into the previous entry if it repeats the same change on the same windows shortly after
+bool ChangeJournal::mergeIntoLast(const Entry &entry) {
+    if (undoEntries.isEmpty()) {
+        return false;
+    }
+    Entry &last = undoEntries.last();
+    if (last.label != entry.label || entry.committedAt - last.committedAt > mergeWindowMs
+        || last.changes.size() != entry.changes.size()) {
+        return false;
+    }
+    for (int i = 0; i < entry.changes.size(); ++i) {
+        const Change &previous = last.changes[i];
+        const Change &next = entry.changes[i];
+        if (previous.hWnd != next.hWnd || previous.processId != next.processId
+            || previous.creationTime != next.creationTime || previous.properties != next.properties) {
+            return false;
+        }
+    }
+
+    // Keep the values from before the first commit, take the new values of this one
+    for (int i = 0; i < entry.changes.size(); ++i) {
+        Change &change = last.changes[i];
+        const Change &next = entry.changes[i];
+        change.title[1] = next.title[1];
+        change.topMost[1] = next.topMost[1];
+        change.geometry[1] = next.geometry[1];
+        change.opacity[1] = next.opacity[1];
+    }
+    last.committedAt = entry.committedAt;
+    usedBytes -= last.bytes;
+    last.bytes = entryBytes(last);
+    usedBytes += last.bytes;
+    return true;
+}
+
+#pragma endregion
+
+#pragma region History
+
+/**
+ * @brief Restores the old values of the most recent entry.
+ */
+int ChangeJournal::undo() {
+    if (undoEntries.isEmpty()) {
+        return -1;
+    }
+    TRACE_SCOPE("ChangeJournal::undo");
+    Entry entry = undoEntries.takeLast();
+    int applied = apply(entry, 0, true);
+    redoEntries.append(entry);
+    return applied;
+}
+
+/**
+ * @brief Applies the most recently undone entry again.
+ */
+int ChangeJournal::redo() {
+    if (redoEntries.isEmpty()) {
+        return -1;
+    }
+    TRACE_SCOPE("ChangeJournal::redo");
+    Entry entry = redoEntries.takeLast();
+    int applied = apply(entry, 1, true);
+    undoEntries.append(entry);
+    return applied;
+}
+
+/**
+ * @brief Returns the windows skipped by the last undo() or redo() for an unknown creation time.
+ */
+int ChangeJournal::unverifiedCount() const {
+    return unverified;
+}
+
+/**
+ * @brief Returns true if an entry can be undone.
+ */
+bool ChangeJournal::canUndo() const {
+    return !undoEntries.isEmpty();
+}
+
+/**
+ * @brief Returns true if an entry can be redone.
+ */
+bool ChangeJournal::canRedo() const {
+    return !redoEntries.isEmpty();
+}
+
+/**
+ * @brief Returns the label of the entry undo() would revert.
+ */
+QString ChangeJournal::undoLabel() const {
+    return undoEntries.isEmpty() ? QString() : undoEntries.last().label;
+}
+
+/**
+ * @brief Returns the label of the entry redo() would apply.
+ */
+QString ChangeJournal::redoLabel() const {
+    return redoEntries.isEmpty() ? QString() : redoEntries.last().label;
+}
+
+/**
+ * @brief Returns the approximate memory used by the entries.
+ */
+qint64 ChangeJournal::memoryUsage() const {
+    return usedBytes;
+}
+
+/**
+ * @brief Changes the memory limit.
+ */
+void ChangeJournal::setMaxBytes(qint64 maxBytes) {
+    this->maxBytes = maxBytes;
+    trim();
+}
+
+/**
+ * @brief Removes all entries and discards a staged transaction.
+ */
+void ChangeJournal::clear() {
+    rollback();
+    undoEntries.clear();
+    redoEntries.clear();
+    usedBytes = 0;
+}
+
+// Apply one side of an entry: titles, TopMost and opacity per window, all rectangles in one batch.
+// Windows that closed or now belong to another process (ID reuse) are skipped; when verifying, so are
+// windows whose process had no readable creation time, as a reused ID cannot be ruled out for them.
+int ChangeJournal::apply(const Entry &entry, int side, bool verifyProcess) {
+    TRACE_SCOPE("ChangeJournal::apply");
+    QHash<DWORD, qint64> creationTimes;     // One lookup per process, not per window
+    QVector<WindowBackend::GeometryUpdate> geometry;
+    int applied = 0;
+    unverified = 0;
+
+    for (const Change &change : entry.changes) {
+        if (backend->windowProcessId(change.hWnd) != change.processId) {
+            continue;
+        }
+        if (verifyProcess) {
+            if (change.creationTime == 0) {
+                ++unverified;
+                continue;
+            }
+            auto it = creationTimes.find(change.processId);
+            if (it == creationTimes.end()) {
+                it = creationTimes.insert(change.processId, backend->processCreationTime(change.processId));
+            }
+            if (it.value() != change.creationTime) {
+                continue;
+            }
+        }
+
+        if (change.properties & Title) {
+            backend->setWindowTitle(change.hWnd, change.title[side]);
+        }
+        if (change.properties & TopMost) {
+            backend->setTopMost(change.hWnd, change.topMost[side]);
+        }
+        if (change.properties & Opacity) {
+            backend->setWindowOpacity(change.hWnd, change.opacity[side]);
+        }
+        if (change.properties & Geometry) {
+            WindowBackend::GeometryUpdate update = { change.hWnd, change.geometry[side] };
+            geometry.append(update);
+        }
+        ++applied;
+    }
+
+    if (!geometry.isEmpty()) {
+        backend->setWindowGeometries(geometry);
+    }
+    return applied;
+}
+
+// Drop the oldest undo entries until the history fits, keeping the newest one; if undone entries still
+// exceed the limit, drop redo entries starting with the one that would be redone last
+void ChangeJournal::trim() {
+    while (usedBytes > maxBytes && undoEntries.size() > 1) {
+        usedBytes -= undoEntries.first().bytes;
+        undoEntries.removeFirst();
+    }
+    while (usedBytes > maxBytes && !redoEntries.isEmpty()) {
+        usedBytes -= redoEntries.first().bytes;
+        redoEntries.removeFirst();
+    }
+}
+
+// Approximate memory of an entry; new titles shared between windows are counted for each window
+qint64 ChangeJournal::entryBytes(const Entry &entry) {
+    qint64 bytes = sizeof(Entry) + entry.label.size() * qint64(sizeof(QChar)) + entry.changes.size() * qint64(sizeof(Change));
+    for (const Change &change : entry.changes) {
+        bytes += (change.title[0].size() + change.title[1].size()) * qint64(sizeof(QChar));
+    }
+    return bytes;
+}
+
+#pragma endregion
@@ -0,0 +1,215 @@
+#ifndef CHANGEJOURNAL_H
+#define CHANGEJOURNAL_H
+
+#include <QHash>
+#include <QString>
+#include <QVector>
+#include "platform.h" // For the HWND, DWORD and RECT types
+#include "windowbackend.h"
+
+/**
+ * @class ChangeJournal
+ * @brief Applies window property changes in transactions and keeps an undo/redo history of them.
+ *
+ * Changes are staged between begin() and commit(). commit() reads the current value of every staged
+ * property, applies all changes as one batch (geometry in a single WindowBackend::setWindowGeometries()
+ * call) and records the old and new values as one journal entry. undo() and redo() apply the recorded
+ * values as a batch again.
+ *
+ * Each recorded window carries the ID and creation time of its owning process. A window whose process
+ * has exited, or whose handle now belongs to a different process that reused the ID, is skipped on
+ * undo and redo instead of being changed by mistake. Windows of processes whose creation time could not
+ * be read (elevated or protected processes) cannot be told apart from a reused ID and are skipped too.
+ *
+ * The history is bounded by memory: when the recorded entries exceed the limit, the oldest undo entries
+ * are dropped, then the redo entries furthest from the current state. Entries store only the staged
+ * properties, and equal new titles share their string data. Committing the same label for the same
+ * windows within a short time merges into the previous entry, so typing a title or dragging a spin box
+ * is a single undo step.
+ *
+ * A journal is used by one thread at a time, like the ProcessManager owning it.
+ */
+class ChangeJournal {
+public:
+    /**
+     * @brief Journaled window properties (flags).
+     */
+    enum Property {
+        Title = 1,          // Window title
+        TopMost = 2,        // TopMost flag
+        Geometry = 4,       // Position and size
+        Opacity = 8         // Opacity (0-255)
+    };
+
+    static const qint64 mergeWindowMs = 1000;  // Commits with the same label and windows merge within this time
+
+    #pragma region Constructors and Destructor
+
+    /**
+     * @brief Creates an empty journal.
+     * @param backend The backend used for all system calls; nullptr selects WindowBackend::systemBackend().
+     *        The backend is not owned and must outlive the journal.
+     * @param maxBytes Memory limit of the recorded entries.
+     */
+    explicit ChangeJournal(WindowBackend *backend = nullptr, qint64 maxBytes = 4 * 1024 * 1024);
+
+    /**
+     * @brief Destructor.
+     */
+    ~ChangeJournal();
+
+    #pragma endregion
+
+    #pragma region Transactions
+
+    /**
+     * @brief Starts staging changes.
+     * @param label Describes the change in logs and undo menus.
+     * @return False if a transaction is already open.
+     */
+    bool begin(const QString &label);
+
+    /**
+     * @brief Returns true between begin() and commit() or rollback().
+     */
+    bool isOpen() const;
+
+    /**
+     * @brief Stages a new window title.
+     */
+    void setTitle(HWND hWnd, const QString &title);
+
+    /**
+     * @brief Stages the TopMost flag.
+     */
+    void setTopMost(HWND hWnd, bool topMost);
+
+    /**
+     * @brief Stages a new window rectangle in screen coordinates.
+     */
+    void setGeometry(HWND hWnd, const RECT &rect);
+
+    /**
+     * @brief Stages a new opacity (0-255).
+     */
+    void setOpacity(HWND hWnd, int opacity);
+
+    /**
+     * @brief Records the current values of the staged properties, applies the staged changes and adds
+     *        them to the history. Clears the redo history.
+     * @return The number of windows changed (windows that no longer exist are skipped).
+     */
+    int commit();
+
+    /**
+     * @brief Discards the staged changes.
+     */
+    void rollback();
+
+    #pragma endregion
+
+    #pragma region History
+
+    /**
+     * @brief Restores the values recorded before the most recent entry.
+     * @return The number of windows restored, or -1 if there is nothing to undo.
+     */
+    int undo();
+
+    /**
+     * @brief Applies the most recently undone entry again.
+     * @return The number of windows changed, or -1 if there is nothing to redo.
+     */
+    int redo();
+
+    /**
+     * @brief Returns the number of windows the last undo() or redo() skipped because the creation time of
+     *        their process could not be read, so a reused process ID could not be ruled out.
+     */
+    int unverifiedCount() const;
+
+    /**
+     * @brief Returns true if an entry can be undone.
+     */
+    bool canUndo() const;
+
+    /**
+     * @brief Returns true if an entry can be redone.
+     */
+    bool canRedo() const;
+
+    /**
+     * @brief Returns the label of the entry undo() would revert ("" if none).
+     */
+    QString undoLabel() const;
+
+    /**
+     * @brief Returns the label of the entry redo() would apply ("" if none).
+     */
+    QString redoLabel() const;
+
+    /**
+     * @brief Returns the approximate memory used by the recorded entries in bytes.
+     */
+    qint64 memoryUsage() const;
+
+    /**
+     * @brief Changes the memory limit, dropping the oldest entries if needed.
+     */
+    void setMaxBytes(qint64 maxBytes);
+
+    /**
+     * @brief Removes all entries and discards a staged transaction.
+     */
+    void clear();
+
+    #pragma endregion
+
+private:
+    /**
+     * @brief Old and new values of one window; index 0 is the value before, index 1 after the change.
+     */
+    struct Change {
+        HWND hWnd;              // Changed window
+        DWORD processId;        // Owning process
+        qint64 creationTime;    // Creation time of the owning process, guards against ID reuse
+        quint8 properties;      // Recorded Property flags
+        quint8 opacity[2];      // Opacity
+        bool topMost[2];        // TopMost flag
+        RECT geometry[2];       // Rectangle in screen coordinates
+        QString title[2];       // Title (empty unless Title is recorded)
+    };
+
+    /**
+     * @brief One committed transaction.
+     */
+    struct Entry {
+        QString label;          // Description
+        qint64 committedAt;     // WindowBackend::tickCount() of the last commit merged into the entry
+        QVector<Change> changes;// Recorded windows
+        qint64 bytes;           // Approximate memory use
+    };
+
+    Change &staged(HWND hWnd, Property property);
+    bool recordCurrent(Change &change);
+    bool mergeIntoLast(const Entry &entry);
+    int apply(const Entry &entry, int side, bool verifyProcess);
+    void trim();
+    static qint64 entryBytes(const Entry &entry);
+
+    #pragma region Member Variables
+
+    WindowBackend *backend;             // System calls (not owned)
+    qint64 maxBytes;                    // Memory limit of the entries
+    qint64 usedBytes;                   // Memory used by undoEntries and redoEntries
+    bool open;                          // A transaction is being staged
+    int unverified;                     // Windows skipped by the last undo() or redo() for an unknown creation time
+    Entry pending;                      // Staged transaction (new values in side 1)
+    QHash<HWND, int> pendingIndex;      // Position of each staged window in pending.changes
+    QVector<Entry> undoEntries;         // Committed entries, oldest first
+    QVector<Entry> redoEntries;         // Undone entries, most recently undone last
+
+    #pragma endregion
+};
+
+#endif // CHANGEJOURNAL_H
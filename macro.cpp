@@ -0,0 +1,281 @@
+#include "macro.h"
+#include <QFile>
+#include <QSaveFile>
+#include <climits>
+
+namespace {
+
+const char macroMagic[3] = { 'C', 'W', 'M' };
+const quint8 macroVersion = 1;
+
+// Fields stored for each operation
+enum Field {
+    HasText = 1,
+    HasValue = 2,
+    HasValue2 = 4
+};
+
+int fieldsOf(int operation) {
+    switch (operation) {
+    case Macro::SelectProcess:   return HasText | HasValue;
+    case Macro::WaitForTitle:    return HasText | HasValue;
+    case Macro::SetTitle:        return HasText;
+    case Macro::SetTopMost:      return HasValue;
+    case Macro::Resize:          return HasValue | HasValue2;
+    case Macro::SetOpacity:      return HasValue;
+    case Macro::Command:         return HasValue;
+    case Macro::CommandOnFilter: return HasText | HasValue;
+    default:                     return -1;
+    }
+}
+
+const char *const commandNames[] = { "kill", "maximize", "minimize", "focus" };
+
+QString commandName(int command) {
+    return command >= 0 && command < 4 ? QString(commandNames[command]) : QString("command %1").arg(command);
+}
+
+void writeVarint(QByteArray &out, quint64 value) {
+    while (value >= 0x80) {
+        out.append(static_cast<char>((value & 0x7F) | 0x80));
+        value >>= 7;
+    }
+    out.append(static_cast<char>(value));
+}
+
+void writeSigned(QByteArray &out, qint64 value) {
+    writeVarint(out, (static_cast<quint64>(value) << 1) ^ static_cast<quint64>(value >> 63));
+}
+
+// Reads from a byte range and remembers the first failure
+struct Reader {
+    const uchar *data;
+    qsizetype size;
+    qsizetype position;
+    bool ok;
+
+    quint64 varint() {
+        quint64 value = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            if (position >= size) {
+                break;
+            }
+            uchar byte = data[position++];
+            value |= quint64(byte & 0x7F) << shift;
+            if ((byte & 0x80) == 0) {
+                return value;
+            }
+        }
+        ok = false;
+        return 0;
+    }
+
+    int signedValue() {
+        quint64 encoded = varint();
+        qint64 value = static_cast<qint64>(encoded >> 1) ^ -static_cast<qint64>(encoded & 1);
+        if (value < INT_MIN || value > INT_MAX) {
+            ok = false;
+            return 0;
+        }
+        return static_cast<int>(value);
+    }
+
+    QString text() {
+        quint64 length = varint();
+        if (!ok || length > quint64(size - position)) {
+            ok = false;
+            return QString();
+        }
+        QString value = QString::fromUtf8(reinterpret_cast<const char *>(data + position), static_cast<qsizetype>(length));
+        position += static_cast<qsizetype>(length);
+        return value;
+    }
+};
+
+} // namespace
+
+#pragma region Steps
+
+/**
+ * @brief Appends a step; consecutive changes of the same property keep only the last value.
+ */
+void Macro::append(const Step &step) {
+    bool replaces = !steps.isEmpty() && steps.last().operation == step.operation
+        && (step.operation == SetTitle || step.operation == Resize || step.operation == SetOpacity);
+    if (replaces) {
+        steps.last() = step;
+    } else {
+        steps.append(step);
+    }
+}
+
+/**
+ * @brief Removes all steps.
+ */
+void Macro::clear() {
+    steps.clear();
+}
+
+/**
+ * @brief Returns the number of steps.
+ */
+int Macro::size() const {
+    return static_cast<int>(steps.size());
+}
+
+/**
+ * @brief Returns true if the macro has no steps.
+ */
+bool Macro::isEmpty() const {
+    return steps.isEmpty();
+}
+
+/**
+ * @brief Returns a step.
+ */
+const Macro::Step &Macro::step(int index) const {
+    return steps[index];
+}
+
+/**
+ * @brief Returns a one-line description of a step for logs.
+ */
+QString Macro::describe(const Step &step) {
+    switch (step.operation) {
+    case SelectProcess:
+        return QString("select %1 (wait up to %2 ms)").arg(step.text).arg(step.value);
+    case WaitForTitle:
+        return QString("select window \"%1\" (wait up to %2 ms)").arg(step.text).arg(step.value);
+    case SetTitle:
+        return QString("set title \"%1\"").arg(step.text);
+    case SetTopMost:
+        return step.value ? QString("set topmost") : QString("remove topmost");
+    case Resize:
+        return QString("resize %1x%2").arg(step.value).arg(step.value2);
+    case SetOpacity:
+        return QString("set opacity %1").arg(step.value);
+    case Command:
+        return commandName(step.value);
+    case CommandOnFilter:
+        return QString("%1 where %2").arg(commandName(step.value), step.text);
+    default:
+        return QString("unknown operation %1").arg(step.operation);
+    }
+}
+
+#pragma endregion
+
+#pragma region Files
+
+/**
+ * @brief Encodes the steps; only the fields an operation uses are written.
+ */
+QByteArray Macro::encode() const {
+    QByteArray out(macroMagic, sizeof(macroMagic));
+    out.append(static_cast<char>(macroVersion));
+    writeVarint(out, static_cast<quint64>(steps.size()));
+
+    for (const Step &step : steps) {
+        int fields = fieldsOf(step.operation);
+        out.append(static_cast<char>(step.operation));
+        if (fields & HasText) {
+            QByteArray text = step.text.toUtf8();
+            writeVarint(out, static_cast<quint64>(text.size()));
+            out.append(text);
+        }
+        if (fields & HasValue) {
+            writeSigned(out, step.value);
+        }
+        if (fields & HasValue2) {
+            writeSigned(out, step.value2);
+        }
+    }
+    return out;
+}
+
+/**
+ * @brief Decodes into a temporary list, so a damaged file leaves the current steps untouched.
+ */
+bool Macro::decode(const QByteArray &data, QString *errorString) {
+    auto fail = [errorString](const QString &reason) {
+        if (errorString) {
+            *errorString = reason;
+        }
+        return false;
+    };
+
+    if (data.size() < 4 || !data.startsWith(QByteArray(macroMagic, sizeof(macroMagic)))) {
+        return fail("Not a cWin macro");
+    }
+    if (static_cast<quint8>(data[3]) != macroVersion) {
+        return fail(QString("Unsupported macro version %1").arg(static_cast<quint8>(data[3])));
+    }
+
+    Reader reader = { reinterpret_cast<const uchar *>(data.constData()), data.size(), 4, true };
+    quint64 count = reader.varint();
+    if (!reader.ok || count > quint64(data.size())) {  // Every step takes at least one byte
+        return fail("Damaged macro header");
+    }
+
+    QVector<Step> decoded;
+    decoded.reserve(static_cast<int>(count));
+    for (quint64 i = 0; i < count; ++i) {
+        if (reader.position >= reader.size) {
+            return fail("Macro is truncated");
+        }
+        int operation = reader.data[reader.position++];
+        int fields = fieldsOf(operation);
+        if (fields < 0) {
+            return fail(QString("Unknown operation %1 in step %2").arg(operation).arg(i + 1));
+        }
+
+        Step step = { static_cast<Operation>(operation), QString(), 0, 0 };
+        if (fields & HasText) {
+            step.text = reader.text();
+        }
+        if (fields & HasValue) {
+            step.value = reader.signedValue();
+        }
+        if (fields & HasValue2) {
+            step.value2 = reader.signedValue();
+        }
+        if (!reader.ok) {
+            return fail(QString("Damaged step %1").arg(i + 1));
+        }
+        decoded.append(step);
+    }
+
+    steps = decoded;
+    return true;
+}
+
+/**
+ * @brief Writes the encoded macro, replacing the file atomically.
+ */
+bool Macro::save(const QString &path, QString *errorString) const {
+    QSaveFile file(path);
+    QByteArray data = encode();
+    if (!file.open(QIODevice::WriteOnly) || file.write(data) != data.size() || !file.commit()) {
+        if (errorString) {
+            *errorString = file.errorString();
+        }
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Reads and decodes a macro file.
+ */
+bool Macro::load(const QString &path, QString *errorString) {
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        if (errorString) {
+            *errorString = file.errorString();
+        }
+        return false;
+    }
+    return decode(file.readAll(), errorString);
+}
+
+#pragma endregion
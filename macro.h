@@ -0,0 +1,122 @@
+#ifndef MACRO_H
+#define MACRO_H
+
+#include <QByteArray>
+#include <QString>
+#include <QVector>
+
+/**
+ * @class Macro
+ * @brief A recorded sequence of window operations that can be saved and replayed by a MacroPlayer.
+ *
+ * Steps name their target by process name or window title instead of process ID, so a macro stays valid
+ * across restarts of the target applications. Selecting a target waits for its window, which lets a macro
+ * start an application's sequence before the application has finished opening.
+ *
+ * Consecutive SetTitle, Resize and SetOpacity steps replace each other while recording, so typing a title
+ * or dragging a spin box stores only the final value.
+ *
+ * Binary format (little endian, integers as LEB128 varints, signed values zigzag encoded):
+ * @code
+ *   "CWM" u8 version varint stepCount
+ *   step: u8 operation, then the fields of the operation in this order:
+ *         text   = varint byteLength + UTF-8 bytes
+ *         value  = zigzag varint
+ *         value2 = zigzag varint
+ * @endcode
+ * A typical step takes 2 to 20 bytes.
+ */
+class Macro {
+public:
+    /**
+     * @brief Step operations; the numbers are stored in macro files and must not change.
+     */
+    enum Operation {
+        SelectProcess = 1,  // Wait for a window of process `text`, at most `value` ms, and make it the target
+        WaitForTitle = 2,   // Wait for a window whose title contains `text`, at most `value` ms, and make it the target
+        SetTitle = 3,       // Set the target window title to `text`
+        SetTopMost = 4,     // Set (value 1) or clear (value 0) TopMost
+        Resize = 5,         // Resize the target window to `value` x `value2`
+        SetOpacity = 6,     // Set the target window opacity to `value`
+        Command = 7,        // Execute ProcessManager::WindowCommand `value` on the target
+        CommandOnFilter = 8 // Execute ProcessManager::WindowCommand `value` on every process matching filter query `text`
+    };
+
+    /**
+     * @brief One operation and its arguments; unused fields are empty or zero.
+     */
+    struct Step {
+        Operation operation;    // What to do
+        QString text;           // Process name, title or filter query
+        int value;              // Timeout, flag, width, opacity or command
+        int value2;             // Height
+    };
+
+    #pragma region Steps
+
+    /**
+     * @brief Appends a step, replacing the last step if both set the same property.
+     */
+    void append(const Step &step);
+
+    /**
+     * @brief Removes all steps.
+     */
+    void clear();
+
+    /**
+     * @brief Returns the number of steps.
+     */
+    int size() const;
+
+    /**
+     * @brief Returns true if the macro has no steps.
+     */
+    bool isEmpty() const;
+
+    /**
+     * @brief Returns a step.
+     */
+    const Step &step(int index) const;
+
+    /**
+     * @brief Returns a one-line description of a step for logs.
+     */
+    static QString describe(const Step &step);
+
+    #pragma endregion
+
+    #pragma region Files
+
+    /**
+     * @brief Encodes the steps in the binary macro format.
+     */
+    QByteArray encode() const;
+
+    /**
+     * @brief Replaces the steps with the steps of an encoded macro.
+     * @param data The encoded macro.
+     * @param errorString Receives the reason on failure (optional).
+     * @return False if the data is not a valid macro; the macro is left unchanged.
+     */
+    bool decode(const QByteArray &data, QString *errorString = nullptr);
+
+    /**
+     * @brief Writes the macro to a file.
+     * @return False if the file could not be written; errorString receives the reason (optional).
+     */
+    bool save(const QString &path, QString *errorString = nullptr) const;
+
+    /**
+     * @brief Reads a macro file.
+     * @return False if the file could not be read or is invalid; errorString receives the reason (optional).
+     */
+    bool load(const QString &path, QString *errorString = nullptr);
+
+    #pragma endregion
+
+private:
+    QVector<Step> steps;    // Steps in execution order
+};
+
+#endif // MACRO_H
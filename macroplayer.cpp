@@ -0,0 +1,116 @@
+#include "macroplayer.h"
+#include <QElapsedTimer>
+#include "processfilter.h"
+#include "processmanager.h"
+#include "tracer.h"
+
+#pragma region Constructor
+
+/**
+ * @brief Constructs a player on the given backend, or on the system backend.
+ */
+MacroPlayer::MacroPlayer(WindowBackend *backend)
+    : backend(backend ? backend : WindowBackend::systemBackend()), cancelled(false) {}
+
+#pragma endregion
+
+#pragma region Playback
+
+/**
+ * @brief Runs the steps in order. Property steps act on the process selected by the last waiting step, and the
+ *        first step that fails ends the run.
+ */
+bool MacroPlayer::run(const Macro &macro, std::function<void(const QString &)> logCallback) {
+    TRACE_SCOPE("MacroPlayer::run");
+    QElapsedTimer elapsed;
+    elapsed.start();
+
+    ProcessManager manager(backend);
+    manager.setLogCallback(logCallback);
+    DWORD processId = 0;
+
+    for (int i = 0; i < macro.size(); ++i) {
+        if (cancelled.load()) {
+            logCallback(QString("Macro cancelled before step %1").arg(i + 1));
+            return false;
+        }
+
+        const Macro::Step &step = macro.step(i);
+        logCallback(QString("Step %1/%2: %3").arg(i + 1).arg(macro.size()).arg(Macro::describe(step)));
+
+        bool needsTarget = step.operation != Macro::SelectProcess && step.operation != Macro::WaitForTitle
+                           && step.operation != Macro::CommandOnFilter;
+        if (needsTarget && processId == 0) {
+            logCallback("No target process; a macro has to select a process first");
+            return false;
+        }
+        bool isCommand = step.operation == Macro::Command || step.operation == Macro::CommandOnFilter;
+        if (isCommand && (step.value < ProcessManager::Kill || step.value > ProcessManager::Focus)) {
+            logCallback(QString("Invalid window command %1").arg(step.value));
+            return false;
+        }
+
+        bool succeeded = false;
+        switch (step.operation) {
+        case Macro::SelectProcess:
+            succeeded = manager.waitForProcessWindow(step.text, step.value, &cancelled);
+            processId = manager.getProcessInfo().getProcessId();
+            break;
+        case Macro::WaitForTitle:
+            succeeded = manager.waitForWindowTitle(step.text, step.value, &cancelled);
+            processId = manager.getProcessInfo().getProcessId();
+            break;
+        case Macro::SetTitle:
+            succeeded = manager.SetProcessWindowTitle(step.text, processId);
+            break;
+        case Macro::SetTopMost:
+            succeeded = manager.SetProcessWindowTopMost(step.value != 0, processId);
+            break;
+        case Macro::Resize:
+            succeeded = manager.SetProcessWindowSize(step.value, step.value2, processId);
+            break;
+        case Macro::SetOpacity:
+            succeeded = manager.SetProcessWindowTransparency(step.value, processId);
+            break;
+        case Macro::Command:
+            succeeded = manager.ExecuteWindowCommand(static_cast<ProcessManager::WindowCommand>(step.value), processId);
+            if (step.value == ProcessManager::Kill) {
+                processId = 0;  // The target is gone; the next step has to select a new one
+            }
+            break;
+        case Macro::CommandOnFilter: {
+            ProcessFilter filter;
+            if (!filter.compile(step.text)) {
+                logCallback(QString("Invalid filter: %1").arg(filter.errorString()));
+                break;
+            }
+            succeeded = manager.ExecuteWindowCommandOnFilter(filter, static_cast<ProcessManager::WindowCommand>(step.value));
+            break;
+        }
+        }
+
+        if (!succeeded) {
+            logCallback(QString("Macro failed at step %1").arg(i + 1));
+            return false;
+        }
+    }
+
+    logCallback(QString("Macro finished: %1 steps in %2 ms").arg(macro.size()).arg(elapsed.elapsed()));
+    return true;
+}
+
+/**
+ * @brief Requests the running macro to stop.
+ */
+void MacroPlayer::cancel() {
+    cancelled.store(true);
+}
+
+/**
+ * @brief Allows the next run.
+ */
+void MacroPlayer::reset() {
+    cancelled.store(false);
+}
+
+#pragma endregion
@@ -0,0 +1,51 @@
+#ifndef MACROPLAYER_H
+#define MACROPLAYER_H
+
+#include <QString>
+#include <atomic>
+#include <functional>
+#include "macro.h"
+#include "windowbackend.h"
+
+/**
+ * @class MacroPlayer
+ * @brief Replays a Macro step by step with its own ProcessManager.
+ *
+ * run() blocks until the macro has finished, failed or was cancelled, so it is meant to be called from a
+ * worker thread (or from main() in headless mode). Waiting steps block on window events of the backend and
+ * continue as soon as the awaited window appears. cancel() may be called from any thread and also ends a
+ * wait that is in progress.
+ */
+class MacroPlayer {
+public:
+    /**
+     * @brief Constructor.
+     * @param backend The backend used for all system calls; nullptr selects WindowBackend::systemBackend().
+     *        The backend is not owned and must outlive the player.
+     */
+    explicit MacroPlayer(WindowBackend *backend = nullptr);
+
+    /**
+     * @brief Runs all steps in order and stops at the first step that fails.
+     * @param macro The macro to replay.
+     * @param logCallback Receives progress and error messages; called on the running thread.
+     * @return True if every step succeeded.
+     */
+    bool run(const Macro &macro, std::function<void(const QString &)> logCallback);
+
+    /**
+     * @brief Stops the current run before its next step or wait. Later runs stop at once until reset() is called.
+     */
+    void cancel();
+
+    /**
+     * @brief Clears a previous cancel(); call before starting a new run.
+     */
+    void reset();
+
+private:
+    WindowBackend *backend;         // System calls (not owned)
+    std::atomic<bool> cancelled;    // Set by cancel(), read while running
+};
+
+#endif // MACROPLAYER_H
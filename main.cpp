@@ -1,11 +1,80 @@
 #include "mainwindow.h"
+#include "startuptimeline.h"
+#include "macro.h"
+#include "macroplayer.h"
 
 #include <QApplication>
+#include <QCommandLineParser>
+#include <QFile>
+#include <QTextStream>
+#include <cstdio>
+
+namespace {
+
+// cWin is a GUI program, so when it is started from a console its standard output goes nowhere until it
+// attaches to the parent's console; output redirected to a file or pipe is left alone
+void attachParentConsole()
+{
+#ifdef _WIN32
+    HANDLE output = GetStdHandle(STD_OUTPUT_HANDLE);
+    if ((output == NULL || output == INVALID_HANDLE_VALUE) && AttachConsole(ATTACH_PARENT_PROCESS)) {
+        FILE *stream = nullptr;
+        freopen_s(&stream, "CONOUT$", "w", stdout);
+    }
+#endif
+}
+
+} // namespace
 
 int main(int argc, char *argv[])
 {
+    StartupTimeline::start();
     QApplication a(argc, argv);
+
+    // Startup timings for regression checks: cWin --startup-report startup.json --exit-after-startup
+    QCommandLineParser parser;
+    parser.addHelpOption();
+    QCommandLineOption reportOption("startup-report", "Write the startup phase timings as JSON to <file>.", "file");
+    QCommandLineOption exitOption("exit-after-startup", "Quit once the startup report is written.");
+    QCommandLineOption macroOption("run-macro", "Replay a macro file without showing the window and exit.", "file");
+    QCommandLineOption logOption("log", "Write the --run-macro output to <file> instead of the console.", "file");
+    parser.addOption(reportOption);
+    parser.addOption(exitOption);
+    parser.addOption(macroOption);
+    parser.addOption(logOption);
+    parser.process(a);
+
+    // Headless replay: cWin --run-macro setup.cwm (exit code 0 if every step succeeded)
+    if (parser.isSet(macroOption)) {
+        attachParentConsole();
+        QTextStream out(stdout);
+        QFile logFile(parser.value(logOption));
+        if (parser.isSet(logOption)) {
+            if (!logFile.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text)) {
+                out << QString("Cannot write log: %1").arg(logFile.errorString()) << Qt::endl;
+                return 2;
+            }
+            out.setDevice(&logFile);
+        }
+
+        Macro macro;
+        QString error;
+        if (!macro.load(parser.value(macroOption), &error)) {
+            out << QString("Cannot load macro: %1").arg(error) << Qt::endl;
+            return 2;
+        }
+        MacroPlayer player;
+        bool succeeded = player.run(macro, [&out](const QString &logMessage) {
+            out << logMessage << Qt::endl;
+        });
+        return succeeded ? 0 : 1;
+    }
+    if (parser.isSet(reportOption)) {
+        StartupTimeline::setReport(parser.value(reportOption), parser.isSet(exitOption));
+    }
+
     MainWindow w;
+    StartupTimeline::mark(StartupTimeline::UiConstructed);
     w.show();
     return a.exec();
 }
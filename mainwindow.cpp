@@ -1,7 +1,17 @@
 #include "mainwindow.h"
 #include "ui_mainwindow.h"
 #include <QDateTime>
+#include <QCoreApplication>
+#include <QFileDialog>
+#include <QMessageBox>
+#include <QCompleter>
+#include <QScreen>
+#include <QSet>
+#include <QSignalBlocker>
+#include <QStandardPaths>
 #include <windows.h>
+#include "tracer.h"
+#include "startuptimeline.h"
 
 //#region Constructor and Destructor
 
@@ -12,7 +22,9 @@
  */
 MainWindow::MainWindow(QWidget *parent)
     : QMainWindow(parent)
-    , ui(new Ui::MainWindow), isTopMost(false)
+    , ui(new Ui::MainWindow), isTopMost(false), topProcessesDialog(nullptr), windowTreeDialog(nullptr),
+      completionModel(nullptr), refreshThread(nullptr), macroThread(nullptr), macroSucceeded(false),
+      updatingDetails(false), filterChangeSkipped(false)
 {
     ui->setupUi(this);
 
@@ -22,6 +34,7 @@ MainWindow::MainWindow(QWidget *parent)
     // Add selection options for process search
     ui->cbProcessSearchType->addItem("Search by Process Name");
     ui->cbProcessSearchType->addItem("Search by Process ID (WIP)");
+    ui->cbProcessSearchType->addItem("Search by Filter Query");
 
     // Add command options for process window management
     ui->cbProcessWindowCommands->addItem("Select a Command...");
@@ -39,6 +52,48 @@ MainWindow::MainWindow(QWidget *parent)
     connect(ui->sbProcessWindowHeight, &QSpinBox::valueChanged, this, &MainWindow::onSbProcessWindowSize_Changed);
     connect(ui->sbProcessWindowWidth, &QSpinBox::valueChanged, this, &MainWindow::onSbProcessWindowSize_Changed);
     connect(ui->sbProcessWindowTransparency, &QSpinBox::valueChanged, this, &MainWindow::onSbProcessWindowTransparency_Changed);
+    connect(ui->aTopProcesses, &QAction::triggered, this, &MainWindow::onATopProcesses_Triggered);
+    connect(ui->aWindowTree, &QAction::triggered, this, &MainWindow::onAWindowTree_Triggered);
+    connect(ui->aRecordMacro, &QAction::toggled, this, &MainWindow::onARecordMacro_Toggled);
+    connect(ui->aRunMacro, &QAction::triggered, this, &MainWindow::onARunMacro_Triggered);
+    connect(ui->aStopMacro, &QAction::triggered, this, &MainWindow::onAStopMacro_Triggered);
+    connect(ui->aUndo, &QAction::triggered, this, &MainWindow::onAUndo_Triggered);
+    connect(ui->aRedo, &QAction::triggered, this, &MainWindow::onARedo_Triggered);
+    connect(ui->aWatchdog, &QAction::toggled, this, &MainWindow::onAWatchdog_Toggled);
+    connect(ui->aTitleWatch, &QAction::toggled, this, &MainWindow::onATitleWatch_Toggled);
+    connect(ui->aExportSnapshot, &QAction::triggered, this, &MainWindow::onAExportSnapshot_Triggered);
+    connect(ui->aTelemetryExport, &QAction::toggled, this, &MainWindow::onATelemetryExport_Toggled);
+    connect(ui->aTracing, &QAction::toggled, this, &MainWindow::onATracing_Toggled);
+    connect(ui->aExportTrace, &QAction::triggered, this, &MainWindow::onAExportTrace_Triggered);
+
+    // Operations not started from "Get Process" (watchdog actions) log here as well
+    processManager.setLogCallback([this](const QString &logMessage) {
+        Log(logMessage);
+    });
+
+    // Sample all processes once per second while a consumer needs it
+    samplingTimer = new QTimer(this);
+    samplingTimer->setInterval(1000);
+    connect(samplingTimer, &QTimer::timeout, this, &MainWindow::onSamplingTimer_Timeout);
+
+    // Animate watchdog fades once per display frame
+    animator = new WindowAnimator(nullptr, this);
+    if (screen() != nullptr && screen()->refreshRate() > 0) {
+        animator->setFrameRate(screen()->refreshRate());
+    }
+    connect(animator, &WindowAnimator::idle, this, &MainWindow::onAnimator_Idle);
+    processManager.setAnimator(animator);
+    processManager.trackWindowLayout(true);     // Fades of covered windows are applied at once
+
+    // Offer process names and recent targets while typing
+    completionModel = new QStringListModel(this);
+    QCompleter *completer = new QCompleter(completionModel, this);
+    completer->setCaseSensitivity(Qt::CaseInsensitive);
+    ui->txtProcessName->setCompleter(completer);
+
+    // Show the previous run's data right away; a fresh enumeration reconciles in the background
+    loadSnapshotCache();
+    startBackgroundRefresh();
 
     // Resize the main window to appropriate dimensions
     this->resize(540, 535);
@@ -50,9 +105,35 @@ MainWindow::MainWindow(QWidget *parent)
  */
 MainWindow::~MainWindow()
 {
+    // A running macro may be blocked in a wait; cancelling ends it within a moment
+    if (macroThread != nullptr) {
+        macroPlayer.cancel();
+        macroThread->wait();
+    }
+
+    // Let the launch enumeration finish, then keep the newest snapshot and the recent targets for the next start
+    if (refreshThread != nullptr) {
+        refreshThread->wait();
+    }
+    snapshotCache.close();
+    const ProcessSnapshot &latest = sampledSnapshot.captureTime() > freshSnapshot.captureTime() ? sampledSnapshot : freshSnapshot;
+    if (!latest.isEmpty()) {
+        saveSnapshotCache(latest);
+    }
+
     delete ui;
 }
 
+/**
+ * Paints the window; the first call marks the first paint of the startup, which shows the cached
+ * details of the most recent target when a snapshot cache was loaded.
+ */
+void MainWindow::paintEvent(QPaintEvent *event)
+{
+    QMainWindow::paintEvent(event);
+    StartupTimeline::mark(StartupTimeline::FirstPaint);
+}
+
 //#endregion
 
 //#region Slot Implementations
@@ -64,7 +145,10 @@ MainWindow::~MainWindow()
 void MainWindow::onCbProcessTopMost_CheckedChanged()
 {
     bool TopMost = ui->cbProcessTopMost->isChecked();
-    processManager.SetProcessWindowTopMost(TopMost, info.getProcessId());
+    applyToTargets("Set TopMost", [this, TopMost](HWND hWnd) {
+        processManager.SetWindowTopMost(hWnd, TopMost);
+    });
+    recordStep({ Macro::SetTopMost, QString(), TopMost ? 1 : 0, 0 });
 }
 
 /**
@@ -74,7 +158,10 @@ void MainWindow::onCbProcessTopMost_CheckedChanged()
 void MainWindow::onTxtProcessTitle_TextChanged()
 {
     QString Title = ui->txtProcessTitle->text();
-    processManager.SetProcessWindowTitle(Title, info.getProcessId());
+    applyToTargets("Set title", [this, &Title](HWND hWnd) {
+        processManager.SetWindowTitle(hWnd, Title);
+    });
+    recordStep({ Macro::SetTitle, Title, 0, 0 });
 }
 
 /**
@@ -101,7 +188,10 @@ void MainWindow::onCWinTopMost_Changed()
 void MainWindow::onSbProcessWindowTransparency_Changed()
 {
     int value = ui->sbProcessWindowTransparency->value();
-    processManager.SetProcessWindowTransparency(value);
+    applyToTargets("Set opacity", [this, value](HWND hWnd) {
+        processManager.SetWindowTransparency(hWnd, value);
+    });
+    recordStep({ Macro::SetOpacity, QString(), value, 0 });
 }
 
 /**
@@ -111,9 +201,27 @@ void MainWindow::onSbProcessWindowTransparency_Changed()
 void MainWindow::onBtnGetProcess_Clicked()
 {
     QString processNameOrId = ui->txtProcessName->text();
-    processManager.getProcessDetails(processNameOrId, [this](const QString &logMessage) {
+    processManager.setTargetWindow(NULL);   // A new search starts at the main window again
+    auto logCallback = [this](const QString &logMessage) {
         Log(logMessage); // Display logs in the UI
-    });
+    };
+
+    if (isFilterSearch()) {
+        // Compile once, the same filter is reused for bulk commands
+        processFilter.compile(processNameOrId);
+        filterTargetsAge.invalidate();
+        processManager.getProcessDetailsByFilter(processFilter, logCallback);
+    } else {
+        processManager.getProcessDetails(processNameOrId, logCallback);
+        if (processManager.getProcessInfo().getProcessId() != 0) {
+            addRecentTarget(processNameOrId.trimmed());
+            // Macros select by name, process IDs do not survive a restart of the target
+            QString processName = processManager.getProcessInfo().getProcessName();
+            if (!processName.isEmpty()) {
+                recordStep({ Macro::SelectProcess, processName, macroWaitMs, 0 });
+            }
+        }
+    }
 
     updateProcessDetails();
     ShowOrHideProcessOptions();
@@ -128,6 +236,30 @@ void MainWindow::onBtnExecuteProcessCommand_Clicked()
     int command = ui->cbProcessWindowCommands->currentIndex();
     QString msg;
 
+    // Filter searches execute the command on every matching process
+    if (isFilterSearch() && command >= 1 && command <= 4) {
+        static const ProcessManager::WindowCommand commands[] = {
+            ProcessManager::Kill, ProcessManager::Maximize, ProcessManager::Minimize, ProcessManager::Focus
+        };
+        // Killing every match cannot be undone; show how many processes the query hits first
+        if (commands[command - 1] == ProcessManager::Kill) {
+            int matches = resolveFilterTargets().size();
+            QString question = QString("Kill all %1 processes matching \"%2\"?").arg(matches).arg(processFilter.query());
+            if (matches == 0 || QMessageBox::warning(this, "Kill Processes", question, QMessageBox::Yes | QMessageBox::No,
+                                                     QMessageBox::No) != QMessageBox::Yes) {
+                Log(QString("Bulk kill cancelled (%1 matches)").arg(matches));
+                return;
+            }
+        }
+
+        msg = QString("Execute command -> %1, Target -> filter \"%2\"").arg(ui->cbProcessWindowCommands->currentText(), processFilter.query());
+        Log(msg);
+        processManager.ExecuteWindowCommandOnFilter(processFilter, commands[command - 1]);
+        filterTargetsAge.invalidate();  // Commands may close or end matches
+        recordStep({ Macro::CommandOnFilter, processFilter.query(), commands[command - 1], 0 });
+        return;
+    }
+
     switch(command)
     {
     case 0:
@@ -157,6 +289,10 @@ void MainWindow::onBtnExecuteProcessCommand_Clicked()
         Log("Invalid command!"); // Invalid command
         break;
     }
+
+    if (command >= 1 && command <= 4) {
+        recordStep({ Macro::Command, QString(), command - 1, 0 });   // Combo box order matches WindowCommand
+    }
 }
 
 /**
@@ -168,13 +304,450 @@ void MainWindow::onSbProcessWindowSize_Changed()
     int height = ui->sbProcessWindowHeight->value();
     int width = ui->sbProcessWindowWidth->value();
 
-    processManager.SetProcessWindowSize(height, width);
+    applyToTargets("Resize", [this, height, width](HWND hWnd) {
+        processManager.SetWindowSize(hWnd, height, width);
+    });
+    recordStep({ Macro::Resize, QString(), height, width });
+}
+
+/**
+ * Slot function called when the "Top Processes" menu action is triggered.
+ * Opens the top processes view and starts periodic sampling.
+ */
+void MainWindow::onATopProcesses_Triggered()
+{
+    if (topProcessesDialog == nullptr) {
+        topProcessesDialog = new TopProcessesDialog(this);
+        connect(topProcessesDialog, &QDialog::finished, this, &MainWindow::updateSamplingTimer);
+    }
+
+    topProcessesDialog->show();
+    topProcessesDialog->raise();
+    updateSamplingTimer();
+    onSamplingTimer_Timeout(); // Show data immediately instead of after the first interval
+}
+
+/**
+ * Slot function called when the "Window Tree" menu action is triggered.
+ * Shows the windows of the current process; child windows are enumerated as their nodes are expanded.
+ */
+void MainWindow::onAWindowTree_Triggered()
+{
+    if (info.getProcessId() == 0) {
+        Log("No process selected");
+        return;
+    }
+
+    if (windowTreeDialog == nullptr) {
+        windowTreeDialog = new WindowTreeDialog(&processManager.getWindowTree(), this);
+        connect(windowTreeDialog, &WindowTreeDialog::targetWindowSelected, this, &MainWindow::onWindowTreeDialog_TargetSelected);
+    }
+
+    windowTreeDialog->showProcess(info.getProcessId(), processManager.getTargetWindow());
+    windowTreeDialog->show();
+    windowTreeDialog->raise();
+}
+
+/**
+ * Slot function called when a window is picked in the window tree.
+ * All window operations of the current process act on the picked window from now on.
+ */
+void MainWindow::onWindowTreeDialog_TargetSelected(HWND hWnd)
+{
+    processManager.setTargetWindow(hWnd);
+    if (hWnd != NULL) {
+        Log(QString("Target window -> 0x%1").arg(reinterpret_cast<quintptr>(hWnd), 0, 16));
+    } else {
+        Log("Target window -> main window");
+    }
+
+    processManager.refreshWindowInfo();
+    updateProcessDetails();
+
+    // Top-level windows are found again by title on replay; child windows have no stable identity
+    if (hWnd != NULL && processManager.getWindowTree().parent(hWnd) == NULL) {
+        QString title = processManager.getWindowTree().describe(hWnd).title;
+        if (!title.isEmpty()) {
+            recordStep({ Macro::WaitForTitle, title, macroWaitMs, 0 });
+        }
+    }
+}
+
+/**
+ * Slot function called when the enumeration started at launch has finished.
+ * Reports what changed since the cached snapshot, switches the completions to the fresh data and rewrites the cache.
+ */
+void MainWindow::onRefreshThread_Finished()
+{
+    refreshThread->deleteLater();
+    refreshThread = nullptr;
+
+    if (snapshotCache.isOpen()) {
+        QSet<DWORD> cachedIds;
+        for (int row = 0; row < snapshotCache.size(); ++row) {
+            cachedIds.insert(snapshotCache.processId(row));
+        }
+        int started = 0;
+        for (int row = 0; row < freshSnapshot.size(); ++row) {
+            if (!cachedIds.remove(freshSnapshot.processId(row))) {
+                ++started;
+            }
+        }
+        Log(QString("Refreshed %1 processes: %2 started and %3 exited since the cached snapshot")
+                .arg(freshSnapshot.size()).arg(started).arg(cachedIds.size()));
+        snapshotCache.close(); // Unmap before the file is replaced
+    } else {
+        Log(QString("Found %1 running processes").arg(freshSnapshot.size()));
+    }
+
+    QStringList processNames;
+    processNames.reserve(freshSnapshot.size());
+    for (int row = 0; row < freshSnapshot.size(); ++row) {
+        processNames.append(freshSnapshot.processName(row).toString());
+    }
+    setCompletions(processNames);
+
+    saveSnapshotCache(freshSnapshot);
+    StartupTimeline::mark(StartupTimeline::FreshData);
+}
+
+/**
+ * Slot function called by the sampling timer.
+ * Captures a snapshot and updates the rankings and their view.
+ */
+void MainWindow::onSamplingTimer_Timeout()
+{
+    TRACE_SCOPE("MainWindow::onSamplingTimer_Timeout");
+    processManager.captureSnapshot(sampledSnapshot);
+    {
+        TRACE_SCOPE("ProcessRanking::update");
+        ranking.update(sampledSnapshot);
+    }
+
+    if (ui->aWatchdog->isChecked()) {
+        TRACE_SCOPE("ProcessWatchdog::evaluate");
+        for (const ProcessWatchdog::Trigger &trigger : watchdog.evaluate(sampledSnapshot, ranking)) {
+            applyWatchdogTrigger(trigger);
+        }
+    }
+
+    if (ui->aTitleWatch->isChecked()) {
+        for (const TitleWatch::Match &match : processManager.scanWindowTitles(sampledSnapshot, titleWatch)) {
+            logTitleMatch(match);
+        }
+    }
+
+    if (ui->aTelemetryExport->isChecked()) {
+        TRACE_SCOPE("SnapshotExporter::write");
+        if (!telemetryExporter.write(sampledSnapshot)) {
+            Log(QString("Telemetry export failed: %1").arg(telemetryExporter.errorString()));
+            ui->aTelemetryExport->setChecked(false);
+        }
+    }
+
+    if (topProcessesDialog != nullptr && topProcessesDialog->isVisible()) {
+        topProcessesDialog->showRanking(ranking);
+    }
+}
+
+/**
+ * Slot function called when the last window animation has finished.
+ * Logs the frame timing of the finished animations and starts a new measurement.
+ */
+void MainWindow::onAnimator_Idle()
+{
+    WindowAnimator::FrameStats stats = animator->frameStatistics();
+    Log(QString("Animation: %1 frames, %2 dropped, frame avg %3 ms / max %4 ms, apply avg %5 ms")
+            .arg(stats.frames).arg(stats.droppedFrames)
+            .arg(stats.averageFrameUs / 1000.0, 0, 'f', 1).arg(stats.maxFrameUs / 1000.0, 0, 'f', 1)
+            .arg(stats.averageApplyUs / 1000.0, 0, 'f', 2));
+    animator->resetFrameStatistics();
+}
+
+/**
+ * Slot function called when the "Undo" menu action is triggered.
+ * Restores the windows changed by the most recent change.
+ */
+void MainWindow::onAUndo_Triggered()
+{
+    processManager.undo();
+    updateUndoActions();
+    showRestoredValues();
+}
+
+/**
+ * Slot function called when the "Redo" menu action is triggered.
+ * Applies the most recently undone change again.
+ */
+void MainWindow::onARedo_Triggered()
+{
+    processManager.redo();
+    updateUndoActions();
+    showRestoredValues();
+}
+
+/**
+ * Slot function called when the "Record Macro" menu action is toggled.
+ * Starts a new recording, or asks for a file and saves the recorded steps.
+ */
+void MainWindow::onARecordMacro_Toggled()
+{
+    if (ui->aRecordMacro->isChecked()) {
+        recordedMacro.clear();
+        filterChangeSkipped = false;
+        Log("Recording macro");
+        return;
+    }
+
+    if (recordedMacro.isEmpty()) {
+        Log("Macro recording stopped, nothing was recorded");
+        return;
+    }
+    QString path = QFileDialog::getSaveFileName(this, "Save Macro", QString(), "cWin Macro (*.cwm)");
+    if (path.isEmpty()) {
+        Log("Macro discarded");
+        return;
+    }
+
+    QString error;
+    if (recordedMacro.save(path, &error)) {
+        Log(QString("Saved macro with %1 steps to %2").arg(recordedMacro.size()).arg(path));
+    } else {
+        Log(QString("Cannot write %1: %2").arg(path, error));
+    }
+}
+
+/**
+ * Slot function called when the "Run Macro..." menu action is triggered.
+ * Replays a macro file on a worker thread; the log messages are forwarded to the UI thread.
+ */
+void MainWindow::onARunMacro_Triggered()
+{
+    if (macroThread != nullptr) {
+        return;
+    }
+    QString path = QFileDialog::getOpenFileName(this, "Run Macro", QString(), "cWin Macro (*.cwm)");
+    if (path.isEmpty()) {
+        return;
+    }
+
+    QString error;
+    if (!runningMacro.load(path, &error)) {
+        Log(QString("Cannot load macro %1: %2").arg(path, error));
+        return;
+    }
+    Log(QString("Running macro %1 (%2 steps)").arg(path).arg(runningMacro.size()));
+
+    macroPlayer.reset();
+    macroThread = QThread::create([this] {
+        macroSucceeded = macroPlayer.run(runningMacro, [this](const QString &logMessage) {
+            QMetaObject::invokeMethod(this, [this, logMessage] { Log(logMessage); }, Qt::QueuedConnection);
+        });
+    });
+    macroThread->setParent(this);
+    connect(macroThread, &QThread::finished, this, &MainWindow::onMacroThread_Finished);
+    ui->aRunMacro->setEnabled(false);
+    ui->aStopMacro->setEnabled(true);
+    macroThread->start();
+}
+
+/**
+ * Slot function called when the "Stop Macro" menu action is triggered.
+ */
+void MainWindow::onAStopMacro_Triggered()
+{
+    macroPlayer.cancel();
+}
+
+/**
+ * Slot function called when the macro worker thread has finished.
+ * Re-enables the macro actions and reports a failed replay.
+ */
+void MainWindow::onMacroThread_Finished()
+{
+    macroThread->deleteLater();
+    macroThread = nullptr;
+    ui->aRunMacro->setEnabled(true);
+    ui->aStopMacro->setEnabled(false);
+    if (!macroSucceeded) {
+        Log("Macro stopped");
+    }
+}
+
+/**
+ * Slot function called when the "Watchdog" menu action is toggled.
+ * Loads watchdog.rules from the application directory when enabled.
+ */
+void MainWindow::onAWatchdog_Toggled()
+{
+    if (ui->aWatchdog->isChecked()) {
+        QString path = QCoreApplication::applicationDirPath() + "/watchdog.rules";
+        int rules = watchdog.loadRules(path, [this](const QString &logMessage) {
+            Log(logMessage);
+        });
+
+        if (rules < 0) {
+            QSignalBlocker blocker(ui->aWatchdog);  // Unchecking must not run the "disabled" branch
+            ui->aWatchdog->setChecked(false);       // Nothing to watch without a rule file
+            return;
+        }
+        Log(QString("Watchdog enabled with %1 rules").arg(rules));
+    } else {
+        watchdog.clearRules();
+        Log("Watchdog disabled");
+    }
+
+    updateSamplingTimer();
+}
+
+/**
+ * Slot function called when the "Title Watch" menu action is toggled.
+ * Loads titlewatch.patterns from the application directory when enabled.
+ */
+void MainWindow::onATitleWatch_Toggled()
+{
+    if (ui->aTitleWatch->isChecked()) {
+        QString path = QCoreApplication::applicationDirPath() + "/titlewatch.patterns";
+        int patterns = titleWatch.loadPatterns(path, [this](const QString &logMessage) {
+            Log(logMessage);
+        });
+
+        if (patterns <= 0) {
+            if (patterns == 0) {
+                Log("Title watch has no patterns");
+            }
+            QSignalBlocker blocker(ui->aTitleWatch);  // Unchecking must not run the "disabled" branch
+            ui->aTitleWatch->setChecked(false); // Nothing to watch without patterns
+            return;
+        }
+        Log(QString("Title watch enabled with %1 patterns").arg(patterns));
+    } else {
+        titleWatch.clear();
+        Log("Title watch disabled");
+    }
+
+    updateSamplingTimer();
+}
+
+/**
+ * Slot function called when the "Export Snapshot..." menu action is triggered.
+ * The format is chosen from the file extension.
+ */
+void MainWindow::onAExportSnapshot_Triggered()
+{
+    QString path = QFileDialog::getSaveFileName(this, "Export Snapshot", QString(),
+                                                "CSV (*.csv);;JSON Lines (*.jsonl);;Columnar Binary (*.cwsb)");
+    if (path.isEmpty()) {
+        return;
+    }
+
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        Log(QString("Cannot write %1: %2").arg(path, file.errorString()));
+        return;
+    }
+
+    SnapshotExporter exporter;
+    if (path.endsWith(".jsonl", Qt::CaseInsensitive)) {
+        exporter.setFormat(SnapshotExporter::JsonLines);
+    } else if (path.endsWith(".cwsb", Qt::CaseInsensitive)) {
+        exporter.setFormat(SnapshotExporter::Columnar);
+    }
+    exporter.setDevice(&file);
+
+    ProcessSnapshot snapshot;
+    processManager.captureSnapshot(snapshot);
+    if (exporter.write(snapshot)) {
+        Log(QString("Exported %1 processes to %2").arg(snapshot.size()).arg(path));
+    } else {
+        Log(QString("Export failed: %1").arg(exporter.errorString()));
+    }
+    exporter.close();
+}
+
+/**
+ * Slot function called when the "Telemetry Export" menu action is toggled.
+ * Samples are written as JSON Lines diffs to hourly rotating files (at most 16 MB, 24 files kept).
+ */
+void MainWindow::onATelemetryExport_Toggled()
+{
+    if (ui->aTelemetryExport->isChecked()) {
+        QString directory = QStandardPaths::writableLocation(QStandardPaths::AppLocalDataLocation) + "/telemetry";
+        telemetryExporter.setFormat(SnapshotExporter::JsonLines);
+        telemetryExporter.setMode(SnapshotExporter::Diff);
+        telemetryExporter.setRotation(directory, "cwin-snapshot", 16 * 1024 * 1024, 60 * 60 * 1000, 24);
+        Log(QString("Telemetry export to %1").arg(directory));
+    } else {
+        telemetryExporter.close();
+        Log(QString("Telemetry export stopped, %1 records written").arg(telemetryExporter.recordsWritten()));
+    }
+
+    updateSamplingTimer();
+}
+
+/**
+ * Slot function called when the "Record Trace" menu action is toggled.
+ * Enabling starts a new session; the spans recorded so far stay available for export after disabling.
+ */
+void MainWindow::onATracing_Toggled()
+{
+    Tracer::setEnabled(ui->aTracing->isChecked());
+    Log(ui->aTracing->isChecked() ? "Trace recording started" : "Trace recording stopped");
+}
+
+/**
+ * Slot function called when the "Export Trace..." menu action is triggered.
+ * The file can be opened in Perfetto or chrome://tracing.
+ */
+void MainWindow::onAExportTrace_Triggered()
+{
+    QString path = QFileDialog::getSaveFileName(this, "Export Trace", QString(), "Chrome Trace (*.json)");
+    if (path.isEmpty()) {
+        return;
+    }
+
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        Log(QString("Cannot write %1: %2").arg(path, file.errorString()));
+        return;
+    }
+
+    qint64 events = Tracer::writeChromeTrace(&file);
+    if (events < 0) {
+        Log(QString("Trace export failed: %1").arg(file.errorString()));
+        return;
+    }
+
+    QString msg = QString("Exported %1 trace events to %2").arg(events).arg(path);
+    qint64 dropped = Tracer::droppedEvents();
+    if (dropped > 0) {
+        msg += QString(" (%1 dropped, buffers full)").arg(dropped);
+    }
+    Log(msg);
 }
 
 //#endregion
 
 //#region Helper Methods
 
+/**
+ * Starts or stops the sampling timer depending on whether any consumer is active.
+ */
+void MainWindow::updateSamplingTimer()
+{
+    bool needed = (topProcessesDialog != nullptr && topProcessesDialog->isVisible())
+                  || ui->aWatchdog->isChecked()
+                  || ui->aTitleWatch->isChecked()
+                  || ui->aTelemetryExport->isChecked();
+
+    if (needed && !samplingTimer->isActive()) {
+        ranking.clear(); // Stale CPU times would produce a bogus first delta
+        samplingTimer->start();
+    } else if (!needed && samplingTimer->isActive()) {
+        samplingTimer->stop();
+    }
+}
+
 /**
  * Shows or hides the process options based on whether valid process details were retrieved.
  */
@@ -202,10 +775,13 @@ void MainWindow::ShowOrHideProcessOptions()
 void MainWindow::updateProcessDetails()
 {
     info = processManager.getProcessInfo();
+    updatingDetails = true;     // The controls below fire their change slots
 
     // Update process title and name
     ui->txtProcessTitle->setText(info.getProcessTitle());
-    ui->txtProcessName->setText(info.getProcessName());
+    if (!isFilterSearch()) {
+        ui->txtProcessName->setText(info.getProcessName()); // Keep the query text in filter mode
+    }
 
     // Update the TopMost checkbox
     ui->cbProcessTopMost->setChecked(info.getTopMost() == "Yes");
@@ -214,6 +790,266 @@ void MainWindow::updateProcessDetails()
     ui->sbProcessWindowHeight->setValue(info.getHeight());
     ui->sbProcessWindowWidth->setValue(info.getWidth());
     ui->sbProcessWindowTransparency->setValue(info.getOpacity());
+    updatingDetails = false;
+}
+
+/**
+ * Maps the snapshot cache of the previous run. The details of the most recent target are shown straight
+ * from the mapped columns, so the first paint already has data; only distinct process names are copied,
+ * into the completion model. The mapping is closed once fresh data arrives.
+ */
+void MainWindow::loadSnapshotCache()
+{
+    QString path = SnapshotCache::defaultPath();
+    if (!QFile::exists(path)) {
+        return; // First start
+    }
+    if (!snapshotCache.open(path)) {
+        Log(QString("Snapshot cache ignored: %1").arg(snapshotCache.errorString()));
+        return;
+    }
+    StartupTimeline::mark(StartupTimeline::CacheLoaded);
+
+    for (int i = 0; i < snapshotCache.recentTargetCount(); ++i) {
+        recentTargets.append(snapshotCache.recentTarget(i).toString());
+    }
+
+    QSet<QStringView> distinctNames;
+    QStringList processNames;
+    for (int row = 0; row < snapshotCache.size(); ++row) {
+        QStringView name = snapshotCache.processName(row);
+        if (!distinctNames.contains(name)) {
+            distinctNames.insert(name);
+            processNames.append(name.toString());
+        }
+    }
+    setCompletions(processNames);
+
+    if (!recentTargets.isEmpty()) {
+        ui->txtProcessName->setText(recentTargets.first());
+        showCachedDetails(recentTargets.first());
+    }
+
+    QString savedAt = QDateTime::fromMSecsSinceEpoch(snapshotCache.savedAt()).toString("yyyy-MM-dd hh:mm:ss");
+    Log(QString("Showing %1 processes cached at %2, refreshing...").arg(snapshotCache.size()).arg(savedAt));
+}
+
+/**
+ * Fills the detail controls with the cached window of a process, preferring a visible one. Only the
+ * controls are filled: info stays empty, so no window operation runs on a cached process ID that may
+ * have been reused; the next search replaces the values with live ones.
+ */
+void MainWindow::showCachedDetails(const QString &processName)
+{
+    int found = -1;
+    for (int row = 0; row < snapshotCache.size(); ++row) {
+        if (snapshotCache.processName(row).compare(processName, Qt::CaseInsensitive) == 0) {
+            found = row;
+            if (snapshotCache.value(ProcessSnapshot::Visible, row) != 0) {
+                break;
+            }
+        }
+    }
+    if (found < 0) {
+        return;
+    }
+
+    updatingDetails = true;     // The controls below fire their change slots
+    ui->txtProcessTitle->setText(snapshotCache.windowTitle(found).toString());
+    ui->cbProcessTopMost->setChecked(snapshotCache.value(ProcessSnapshot::TopMost, found) != 0);
+    ui->sbProcessWindowHeight->setValue(static_cast<int>(snapshotCache.value(ProcessSnapshot::Height, found)));
+    ui->sbProcessWindowWidth->setValue(static_cast<int>(snapshotCache.value(ProcessSnapshot::Width, found)));
+    ui->sbProcessWindowTransparency->setValue(static_cast<int>(snapshotCache.value(ProcessSnapshot::Opacity, found)));
+    updatingDetails = false;
+}
+
+/**
+ * Enumerates all processes on a background thread. The thread uses its own ProcessManager
+ * (a ProcessManager belongs to one thread) and writes only freshSnapshot.
+ */
+void MainWindow::startBackgroundRefresh()
+{
+    refreshThread = QThread::create([this] {
+        ProcessManager manager;
+        manager.captureSnapshot(freshSnapshot);
+    });
+    refreshThread->setParent(this);
+    connect(refreshThread, &QThread::finished, this, &MainWindow::onRefreshThread_Finished);
+    refreshThread->start();
+}
+
+/**
+ * Writes a snapshot and the recent targets to the snapshot cache. The cache must not be mapped.
+ */
+void MainWindow::saveSnapshotCache(const ProcessSnapshot &snapshot)
+{
+    QString error;
+    if (!SnapshotCache::save(SnapshotCache::defaultPath(), snapshot, recentTargets, &error)) {
+        Log(QString("Failed to write the snapshot cache: %1").arg(error));
+    }
+}
+
+/**
+ * Moves a search target to the front of the recent targets and of the completions.
+ */
+void MainWindow::addRecentTarget(const QString &target)
+{
+    recentTargets.removeAll(target);
+    recentTargets.prepend(target);
+    while (recentTargets.size() > maxRecentTargets) {
+        recentTargets.removeLast();
+    }
+
+    QStringList completions = completionModel->stringList();
+    completions.removeAll(target);
+    completions.prepend(target);
+    completionModel->setStringList(completions);
+}
+
+/**
+ * Offers the recent targets first, followed by the process names.
+ */
+void MainWindow::setCompletions(const QStringList &processNames)
+{
+    QStringList completions = recentTargets;
+    completions.append(processNames);
+    completions.removeDuplicates();
+    completionModel->setStringList(completions);
+}
+
+/**
+ * Executes the action of a watchdog rule that fired and logs it.
+ */
+void MainWindow::applyWatchdogTrigger(const ProcessWatchdog::Trigger &trigger)
+{
+    const ProcessWatchdog::Rule &rule = watchdog.rule(trigger.rule);
+    QString msg = QString("Watchdog -> \"%1\", Target -> %2(PID: %3)").arg(rule.text, trigger.processName).arg(trigger.processId);
+    Log(msg);
+
+    switch (rule.action) {
+    case ProcessWatchdog::LogOnly:
+        break;
+    case ProcessWatchdog::Minimize:
+        processManager.ExecuteWindowCommand(ProcessManager::Minimize, trigger.processId);
+        break;
+    case ProcessWatchdog::LowerOpacity:
+        processManager.AnimateProcessWindowTransparency(rule.opacity, fadeDurationMs, trigger.processId);
+        break;
+    case ProcessWatchdog::Kill:
+        processManager.ExecuteWindowCommand(ProcessManager::Kill, trigger.processId);
+        break;
+    }
+}
+
+/**
+ * Applies a property change as one transaction, to the windows of every process matching the filter in
+ * filter mode and to the window of the selected process otherwise. Matches without a window are skipped.
+ * Values filled in by updateProcessDetails() are applied directly.
+ */
+void MainWindow::applyToTargets(const QString &label, const std::function<void(HWND)> &change)
+{
+    if (updatingDetails) {
+        change(processManager.windowForProcess(info.getProcessId()));
+        return;
+    }
+
+    QVector<HWND> windows;
+    if (isFilterSearch() && processFilter.isValid()) {
+        // The filter's snapshot already holds the windows; no lookup per match
+        for (const ProcessManager::FilterMatch &match : resolveFilterTargets()) {
+            if (match.hWnd != NULL) {
+                windows.append(match.hWnd);
+            }
+        }
+    } else {
+        windows.append(processManager.windowForProcess(info.getProcessId()));
+    }
+
+    processManager.beginTransaction(label);
+    for (HWND hWnd : windows) {
+        change(hWnd);
+    }
+    processManager.commitTransaction();
+    updateUndoActions();
+}
+
+/**
+ * Captures a snapshot for the filter only when the previous matches were not used within the merge window,
+ * so typing a title or dragging a spin box in filter mode enumerates the processes once, not on every change.
+ */
+const QVector<ProcessManager::FilterMatch> &MainWindow::resolveFilterTargets()
+{
+    if (!filterTargetsAge.isValid() || filterTargetsAge.elapsed() > ChangeJournal::mergeWindowMs) {
+        filterTargets = processManager.findProcessesByFilter(processFilter);
+    }
+    filterTargetsAge.start();
+    return filterTargets;
+}
+
+/**
+ * Enables the undo and redo actions and names the change they apply.
+ */
+void MainWindow::updateUndoActions()
+{
+    const ChangeJournal &journal = processManager.getJournal();
+    ui->aUndo->setEnabled(journal.canUndo());
+    ui->aUndo->setText(journal.canUndo() ? QString("Undo %1").arg(journal.undoLabel()) : QString("Undo"));
+    ui->aRedo->setEnabled(journal.canRedo());
+    ui->aRedo->setText(journal.canRedo() ? QString("Redo %1").arg(journal.redoLabel()) : QString("Redo"));
+}
+
+/**
+ * Reads the selected window again after undo or redo, so the controls show the restored values.
+ */
+void MainWindow::showRestoredValues()
+{
+    if (info.getProcessId() != 0) {
+        processManager.refreshWindowInfo();
+        updateProcessDetails();
+    }
+}
+
+/**
+ * Logs a window whose new title contains watched patterns.
+ */
+void MainWindow::logTitleMatch(const TitleWatch::Match &match)
+{
+    QStringList patterns;
+    for (int index : match.patterns) {
+        patterns.append(QString("\"%1\"").arg(titleWatch.pattern(index)));
+    }
+    Log(QString("Title watch -> %1 in \"%2\", Target -> %3(PID: %4)")
+            .arg(patterns.join(", "), match.title, match.processName).arg(match.processId));
+}
+
+/**
+ * Appends a step to the recorded macro while recording, unless the change came from updateProcessDetails().
+ */
+void MainWindow::recordStep(const Macro::Step &step)
+{
+    if (!ui->aRecordMacro->isChecked() || updatingDetails) {
+        return;
+    }
+
+    // Property steps replay on one selected process; a change made to every filter match has no such step
+    bool isPropertyStep = step.operation == Macro::SetTitle || step.operation == Macro::SetTopMost
+                          || step.operation == Macro::Resize || step.operation == Macro::SetOpacity;
+    if (isPropertyStep && isFilterSearch()) {
+        if (!filterChangeSkipped) {
+            Log("Changes made in filter mode are not recorded; select a single process to record them");
+            filterChangeSkipped = true;
+        }
+        return;
+    }
+    recordedMacro.append(step);
+}
+
+/**
+ * Returns true if the "Search by Filter Query" search type is selected.
+ */
+bool MainWindow::isFilterSearch() const
+{
+    return ui->cbProcessSearchType->currentIndex() == 2;
 }
 
 /**
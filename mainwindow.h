@@ -3,9 +3,22 @@
 
 #include <QMainWindow>
 #include "processmanager.h"
+#include "processranking.h"
+#include "processwatchdog.h"
+#include "titlewatch.h"
+#include "snapshotexporter.h"
+#include "snapshotcache.h"
+#include "topprocessesdialog.h"
+#include "windowtreedialog.h"
+#include "windowanimator.h"
+#include "macro.h"
+#include "macroplayer.h"
 #include <QString>
 #include <QWidget>
 #include <QTimer>
+#include <QThread>
+#include <QElapsedTimer>
+#include <QStringListModel>
 
 QT_BEGIN_NAMESPACE
 namespace Ui {
@@ -34,6 +47,12 @@ public:
      */
     ~MainWindow();
 
+protected:
+    /**
+     * Paints the window and records the first paint in the startup timeline.
+     */
+    void paintEvent(QPaintEvent *event) override;
+
 private slots:
     /**
      * Slot function: Handles the change event for the TopMost checkbox.
@@ -77,6 +96,114 @@ private slots:
      */
     void onBtnExecuteProcessCommand_Clicked();
 
+    /**
+     * Slot function: Handles the "Top Processes" menu action.
+     * Opens the top processes view and starts sampling.
+     */
+    void onATopProcesses_Triggered();
+
+    /**
+     * Slot function: Handles the "Window Tree" menu action.
+     * Opens the window hierarchy of the current process for picking a child window as target.
+     */
+    void onAWindowTree_Triggered();
+
+    /**
+     * Slot function: Called when a window is picked in the window tree.
+     * Makes the window the target of the window operations and refreshes the process details.
+     * @param hWnd The picked window, or NULL for the main window.
+     */
+    void onWindowTreeDialog_TargetSelected(HWND hWnd);
+
+    /**
+     * Slot function: Handles the "Undo" menu action.
+     * Restores the windows changed by the most recent change.
+     */
+    void onAUndo_Triggered();
+
+    /**
+     * Slot function: Handles the "Redo" menu action.
+     * Applies the most recently undone change again.
+     */
+    void onARedo_Triggered();
+
+    /**
+     * Slot function: Handles the "Record Macro" menu action.
+     * Starts recording the window operations, or stops and saves the recorded macro.
+     */
+    void onARecordMacro_Toggled();
+
+    /**
+     * Slot function: Handles the "Run Macro..." menu action.
+     * Loads a macro file and replays it on a worker thread.
+     */
+    void onARunMacro_Triggered();
+
+    /**
+     * Slot function: Handles the "Stop Macro" menu action.
+     * Cancels the running macro, including a wait in progress.
+     */
+    void onAStopMacro_Triggered();
+
+    /**
+     * Slot function: Called when the macro worker thread has finished.
+     */
+    void onMacroThread_Finished();
+
+    /**
+     * Slot function: Handles the "Watchdog" menu action.
+     * Loads the watchdog rules and starts or stops evaluating them.
+     */
+    void onAWatchdog_Toggled();
+
+    /**
+     * Slot function: Handles the "Title Watch" menu action.
+     * Loads the title patterns and starts or stops matching them against the window titles.
+     */
+    void onATitleWatch_Toggled();
+
+    /**
+     * Slot function: Handles the "Export Snapshot..." menu action.
+     * Writes a full snapshot of all processes to a CSV, JSON Lines or columnar file.
+     */
+    void onAExportSnapshot_Triggered();
+
+    /**
+     * Slot function: Handles the "Telemetry Export" menu action.
+     * Starts or stops streaming diff snapshots to rotating files.
+     */
+    void onATelemetryExport_Toggled();
+
+    /**
+     * Slot function: Handles the "Record Trace" menu action.
+     * Starts a new trace session or stops recording.
+     */
+    void onATracing_Toggled();
+
+    /**
+     * Slot function: Handles the "Export Trace..." menu action.
+     * Writes the recorded spans as Chrome trace-event JSON.
+     */
+    void onAExportTrace_Triggered();
+
+    /**
+     * Slot function: Called when the enumeration started at launch has finished.
+     * Replaces the cached data with the fresh snapshot and rewrites the cache.
+     */
+    void onRefreshThread_Finished();
+
+    /**
+     * Slot function: Called by the sampling timer.
+     * Captures a snapshot and feeds it to the consumers that need periodic samples.
+     */
+    void onSamplingTimer_Timeout();
+
+    /**
+     * Slot function: Called when the last window animation has finished.
+     * Logs the frame timing of the animations.
+     */
+    void onAnimator_Idle();
+
 private:
     /**
      * Logs a message to the UI's log field with a timestamp.
@@ -104,11 +231,128 @@ private:
      */
     void keepWindowOnTop();
 
+    /**
+     * Returns true if the search field holds a filter query instead of a process name or ID.
+     */
+    bool isFilterSearch() const;
+
+    /**
+     * Starts the sampling timer while any consumer needs samples and stops it otherwise.
+     */
+    void updateSamplingTimer();
+
+    /**
+     * Maps the snapshot cache of the previous run and shows its recent targets and process names.
+     */
+    void loadSnapshotCache();
+
+    /**
+     * Shows the cached window details of a process in the detail controls.
+     */
+    void showCachedDetails(const QString &processName);
+
+    /**
+     * Starts enumerating all processes on a background thread.
+     */
+    void startBackgroundRefresh();
+
+    /**
+     * Writes a snapshot and the recent targets to the snapshot cache.
+     * @param snapshot The snapshot to store.
+     */
+    void saveSnapshotCache(const ProcessSnapshot &snapshot);
+
+    /**
+     * Moves a search target to the front of the recent targets.
+     * @param target The process name or ID that was found.
+     */
+    void addRecentTarget(const QString &target);
+
+    /**
+     * Logs a window whose new title contains watched patterns.
+     * @param match The window and the patterns found in its title.
+     */
+    void logTitleMatch(const TitleWatch::Match &match);
+
+    /**
+     * Appends a step to the recorded macro while recording is enabled.
+     * Changes made by updateProcessDetails() itself and property changes in filter mode are not recorded.
+     * @param step The operation that was just applied.
+     */
+    void recordStep(const Macro::Step &step);
+
+    /**
+     * Applies a property change to the window of the selected process, or to the windows of every process
+     * matching the filter in filter mode, as one undoable transaction.
+     * @param label Describes the change in logs and the undo menu.
+     * @param change Applies the change to one window.
+     */
+    void applyToTargets(const QString &label, const std::function<void(HWND)> &change);
+
+    /**
+     * Returns the processes matching the filter of the last filter search. The matches are resolved once
+     * and reused while edits keep following each other within the journal's merge window.
+     */
+    const QVector<ProcessManager::FilterMatch> &resolveFilterTargets();
+
+    /**
+     * Updates the enabled state and text of the undo and redo actions.
+     */
+    void updateUndoActions();
+
+    /**
+     * Re-reads the selected window after undo or redo and shows its values in the controls.
+     */
+    void showRestoredValues();
+
+    /**
+     * Offers the recent targets followed by the given process names as completions of the search field.
+     * @param processNames Executable names of the running (or cached) processes.
+     */
+    void setCompletions(const QStringList &processNames);
+
+    /**
+     * Executes the action of a watchdog rule that fired and logs it.
+     * @param trigger The rule that fired and its target process.
+     */
+    void applyWatchdogTrigger(const ProcessWatchdog::Trigger &trigger);
+
     Ui::MainWindow *ui;             // Pointer to the UI object generated by Qt Designer.
     ProcessInfo info;               // Holds the process information (name, ID, window title, etc.)
     ProcessManager processManager;  // Manages processes and their properties.
+    ProcessFilter processFilter;    // Compiled filter query of the last filter search.
 
     bool isTopMost;                 // Flag to track whether the MainWindow should stay on top of other windows.
+
+    QTimer *samplingTimer;                      // Periodically samples all processes.
+    ProcessSnapshot sampledSnapshot;            // Last sampled process table.
+    ProcessRanking ranking;                     // CPU and memory rankings fed by the samples.
+    TopProcessesDialog *topProcessesDialog;     // Top processes view, created on first use.
+    WindowTreeDialog *windowTreeDialog;         // Window hierarchy view, created on first use.
+    ProcessWatchdog watchdog;                   // Threshold rules evaluated against the samples.
+    TitleWatch titleWatch;                      // Keywords matched against the changed window titles of the samples.
+    SnapshotExporter telemetryExporter;         // Streams the samples to rotating telemetry files.
+    WindowAnimator *animator;                   // Runs the opacity and geometry transitions at the display refresh rate.
+
+    SnapshotCache snapshotCache;                // Previous run's snapshot, mapped until fresh data arrives.
+    QStringList recentTargets;                  // Recently found search targets, most recent first.
+    QStringListModel *completionModel;          // Completions of the search field.
+    QThread *refreshThread;                     // Enumeration started at launch (nullptr when done).
+    ProcessSnapshot freshSnapshot;              // Filled by refreshThread, read once it has finished.
+
+    Macro recordedMacro;                        // Steps recorded since "Record Macro" was enabled.
+    Macro runningMacro;                         // Macro replayed by macroThread.
+    MacroPlayer macroPlayer;                    // Replays runningMacro.
+    QThread *macroThread;                       // Runs the macro (nullptr when idle).
+    bool macroSucceeded;                        // Result of the last replay, written by macroThread.
+    bool updatingDetails;                       // updateProcessDetails() is filling in the controls.
+    bool filterChangeSkipped;                   // A filter-mode change was left out of the recording (logged once).
+    QVector<ProcessManager::FilterMatch> filterTargets; // Matches of processFilter, reused by consecutive edits.
+    QElapsedTimer filterTargetsAge;             // Time since filterTargets was last used (invalid when not resolved).
+
+    static const int maxRecentTargets = 10;     // Number of recent search targets kept
+    static const int fadeDurationMs = 500;      // Duration of the watchdog opacity fade
+    static const int macroWaitMs = 30000;       // Recorded wait for a target window to appear
 };
 
 #endif // MAINWINDOW_H
@@ -0,0 +1,43 @@
+#ifndef PLATFORM_H
+#define PLATFORM_H
+
+/**
+ * @file platform.h
+ * @brief Win32 types used by the process and window model.
+ *
+ * On Windows they come from windows.h. Other platforms (the soak harness on Linux) get layout
+ * compatible definitions so the model and ProcessManager compile unchanged against a simulated backend.
+ */
+
+#ifdef _WIN32
+
+#include <windows.h>
+
+#else
+
+#include <cstddef>
+#include <cstdint>
+
+typedef std::uint32_t DWORD;
+typedef std::int32_t LONG;
+typedef int BOOL;
+typedef unsigned char BYTE;
+typedef struct HWND__ *HWND;
+
+typedef struct tagRECT {
+    LONG left;
+    LONG top;
+    LONG right;
+    LONG bottom;
+} RECT;
+
+#ifndef TRUE
+#define TRUE 1
+#endif
+#ifndef FALSE
+#define FALSE 0
+#endif
+
+#endif // _WIN32
+
+#endif // PLATFORM_H
@@ -0,0 +1,566 @@
+#include "processfilter.h"
+#include <utility>
+#include <vector>
+
+namespace {
+
+#pragma region Fields
+
+enum class FieldType { String, Number, Boolean };
+
+struct FieldInfo {
+    const char *name;
+    FieldType type;
+    ProcessSnapshot::Column column;     // Unused for string fields
+};
+
+// Field names available in queries
+const FieldInfo fields[] = {
+    { "name",    FieldType::String,  ProcessSnapshot::ProcessId },
+    { "title",   FieldType::String,  ProcessSnapshot::ProcessId },
+    { "class",   FieldType::String,  ProcessSnapshot::ProcessId },
+    { "pid",     FieldType::Number,  ProcessSnapshot::ProcessId },
+    { "ppid",    FieldType::Number,  ProcessSnapshot::ParentProcessId },
+    { "threads", FieldType::Number,  ProcessSnapshot::ThreadCount },
+    { "rss",     FieldType::Number,  ProcessSnapshot::WorkingSet },
+    { "cputime", FieldType::Number,  ProcessSnapshot::CpuTime },
+    { "x",       FieldType::Number,  ProcessSnapshot::Left },
+    { "y",       FieldType::Number,  ProcessSnapshot::Top },
+    { "width",   FieldType::Number,  ProcessSnapshot::Width },
+    { "height",  FieldType::Number,  ProcessSnapshot::Height },
+    { "opacity", FieldType::Number,  ProcessSnapshot::Opacity },
+    { "topmost", FieldType::Boolean, ProcessSnapshot::TopMost },
+    { "visible", FieldType::Boolean, ProcessSnapshot::Visible },
+};
+
+const FieldInfo *findField(const QString &name) {
+    for (const FieldInfo &field : fields) {
+        if (name.compare(QLatin1String(field.name), Qt::CaseInsensitive) == 0) {
+            return &field;
+        }
+    }
+    return nullptr;
+}
+
+#pragma endregion
+
+#pragma region Lexer
+
+enum class TokenType { Identifier, String, Number, Operator, And, Or, Not, LeftParen, RightParen, End, Invalid };
+
+struct Token {
+    TokenType type = TokenType::End;
+    QString text;
+    int position = 0;
+};
+
+// Splits a query into tokens one at a time
+class Lexer {
+public:
+    explicit Lexer(const QString &input) : input(input), pos(0) {}
+
+    Token next() {
+        while (pos < input.size() && input[pos].isSpace()) {
+            ++pos;
+        }
+
+        Token token;
+        token.position = pos;
+        if (pos >= input.size()) {
+            token.type = TokenType::End;
+            return token;
+        }
+
+        QChar c = input[pos];
+        QChar n = pos + 1 < input.size() ? input[pos + 1] : QChar();
+
+        if (c == '"') {
+            return readString();
+        }
+        if (c.isDigit() || (c == '-' && n.isDigit())) {
+            return readWord(TokenType::Number);     // Window positions left of or above the primary monitor are negative
+        }
+        if (c.isLetter() || c == '_') {
+            return readWord(TokenType::Identifier);
+        }
+
+        // Two-character operators first
+        if ((c == '&' && n == '&') || (c == '|' && n == '|')) {
+            token.type = c == '&' ? TokenType::And : TokenType::Or;
+            token.text = input.mid(pos, 2);
+            pos += 2;
+            return token;
+        }
+        if ((c == '=' || c == '!' || c == '<' || c == '>') && n == '=') {
+            token.type = TokenType::Operator;
+            token.text = input.mid(pos, 2);
+            pos += 2;
+            return token;
+        }
+        if (c == '!' && n == '~') {
+            token.type = TokenType::Operator;
+            token.text = "!~";
+            pos += 2;
+            return token;
+        }
+
+        token.text = QString(c);
+        ++pos;
+        switch (c.unicode()) {
+        case '<': case '>': case '~':
+            token.type = TokenType::Operator;
+            break;
+        case '!':
+            token.type = TokenType::Not;
+            break;
+        case '(':
+            token.type = TokenType::LeftParen;
+            break;
+        case ')':
+            token.type = TokenType::RightParen;
+            break;
+        default:
+            token.type = TokenType::Invalid;
+            break;
+        }
+        return token;
+    }
+
+private:
+    Token readString() {
+        Token token;
+        token.position = pos;
+        token.type = TokenType::String;
+        ++pos;  // Skip opening quote
+
+        while (pos < input.size() && input[pos] != '"') {
+            if (input[pos] == '\\' && pos + 1 < input.size()) {
+                ++pos;  // Keep the escaped character as-is
+            }
+            token.text.append(input[pos]);
+            ++pos;
+        }
+
+        if (pos >= input.size()) {
+            token.type = TokenType::Invalid;    // Unterminated string
+            return token;
+        }
+        ++pos;  // Skip closing quote
+        return token;
+    }
+
+    Token readWord(TokenType type) {
+        Token token;
+        token.position = pos;
+        token.type = type;
+        int start = pos;
+        if (type == TokenType::Number && input[pos] == '-') {
+            ++pos;
+        }
+        while (pos < input.size() && (input[pos].isLetterOrNumber() || input[pos] == '_' || input[pos] == '.')) {
+            ++pos;
+        }
+        token.text = input.mid(start, pos - start);
+        return token;
+    }
+
+    const QString &input;
+    int pos;
+};
+
+#pragma endregion
+
+#pragma region Predicate Builders
+
+using Predicate = ProcessFilter::Predicate;
+
+// Strips ".exe" and compares case-insensitively without allocating
+bool processNameEquals(QStringView name, const QString &normalized) {
+    if (!name.startsWith(normalized, Qt::CaseInsensitive)) {
+        return false;
+    }
+    qsizetype rest = name.size() - normalized.size();
+    return rest == 0 || (rest == 4 && name.endsWith(QLatin1String(".exe"), Qt::CaseInsensitive));
+}
+
+template <typename Compare>
+Predicate numericPredicate(ProcessSnapshot::Column column, qint64 value) {
+    return [column, value](const ProcessSnapshot &snapshot, int row, ProcessFilter::StringResults &) {
+        return Compare()(snapshot.value(column, row), value);
+    };
+}
+
+Predicate numericComparison(const QString &op, ProcessSnapshot::Column column, qint64 value) {
+    if (op == "==") return numericPredicate<std::equal_to<qint64>>(column, value);
+    if (op == "!=") return numericPredicate<std::not_equal_to<qint64>>(column, value);
+    if (op == "<")  return numericPredicate<std::less<qint64>>(column, value);
+    if (op == "<=") return numericPredicate<std::less_equal<qint64>>(column, value);
+    if (op == ">")  return numericPredicate<std::greater<qint64>>(column, value);
+    if (op == ">=") return numericPredicate<std::greater_equal<qint64>>(column, value);
+    return nullptr;
+}
+
+using StringIdColumn = quint32 (ProcessSnapshot::*)(int) const;
+
+// Evaluates a string test once per distinct interned string of the evaluated snapshot; the results live in
+// the slot of this comparison in the caller's StringResults, so the closure itself is never modified
+Predicate memoizedStringPredicate(int slot, StringIdColumn column, std::function<bool(QStringView)> test) {
+    return [slot, column, test](const ProcessSnapshot &snapshot, int row, ProcessFilter::StringResults &cache) {
+        const StringPool &strings = snapshot.stringPool();
+        std::vector<qint8> &results = cache.comparisons[static_cast<size_t>(slot)];
+
+        quint32 id = (snapshot.*column)(row);
+        if (id >= results.size()) {
+            results.resize(static_cast<size_t>(strings.size()), -1);
+        }
+
+        qint8 &result = results[id];
+        if (result < 0) {
+            result = test(strings.view(id)) ? 1 : 0;
+        }
+        return result != 0;
+    };
+}
+
+Predicate stringComparison(int slot, const QString &field, const QString &op, const QString &value) {
+    bool isName = field.compare(QLatin1String("name"), Qt::CaseInsensitive) == 0;
+    bool isClass = field.compare(QLatin1String("class"), Qt::CaseInsensitive) == 0;
+    StringIdColumn column = isName ? &ProcessSnapshot::processNameId
+                          : isClass ? &ProcessSnapshot::windowClassId
+                                    : &ProcessSnapshot::windowTitleId;
+    bool negate = op == "!=" || op == "!~";
+
+    std::function<bool(QStringView)> test;
+    if (op == "~" || op == "!~") {
+        test = [value](QStringView text) { return text.contains(value, Qt::CaseInsensitive); };
+    } else if (op == "==" || op == "!=") {
+        if (isName) {
+            QString normalized = value;
+            if (normalized.endsWith(QLatin1String(".exe"), Qt::CaseInsensitive)) {
+                normalized.chop(4);
+            }
+            test = [normalized](QStringView text) { return processNameEquals(text, normalized); };
+        } else {
+            test = [value](QStringView text) { return text.compare(value, Qt::CaseInsensitive) == 0; };
+        }
+    } else {
+        return nullptr;
+    }
+
+    if (negate) {
+        return memoizedStringPredicate(slot, column, [test](QStringView text) { return !test(text); });
+    }
+    return memoizedStringPredicate(slot, column, test);
+}
+
+#pragma endregion
+
+#pragma region Parser
+
+// Recursive descent parser producing a closure tree:
+//   or      := and ('||' and)*
+//   and     := unary ('&&' unary)*
+//   unary   := '!' unary | primary
+//   primary := '(' or ')' | field [op literal]
+class Parser {
+public:
+    explicit Parser(const QString &input) : lexer(input), stringComparisons(0) { advance(); }
+
+    Predicate parse(QString &error) {
+        Predicate predicate = parseOr();
+        if (predicate && current.type != TokenType::End) {
+            fail(QString("Unexpected '%1'").arg(current.text));
+        }
+        error = errorMessage;
+        return errorMessage.isEmpty() ? predicate : nullptr;
+    }
+
+    // Number of StringResults slots the parsed predicate uses
+    int stringComparisonCount() const { return stringComparisons; }
+
+private:
+    void advance() { current = lexer.next(); }
+
+    Predicate fail(const QString &message) {
+        if (errorMessage.isEmpty()) {
+            errorMessage = QString("%1 at position %2").arg(message).arg(current.position + 1);
+        }
+        return nullptr;
+    }
+
+    Predicate parseOr() {
+        Predicate left = parseAnd();
+        while (left && current.type == TokenType::Or) {
+            advance();
+            Predicate right = parseAnd();
+            if (!right) return nullptr;
+            left = [left, right](const ProcessSnapshot &snapshot, int row, ProcessFilter::StringResults &cache) {
+                return left(snapshot, row, cache) || right(snapshot, row, cache);
+            };
+        }
+        return left;
+    }
+
+    Predicate parseAnd() {
+        Predicate left = parseUnary();
+        while (left && current.type == TokenType::And) {
+            advance();
+            Predicate right = parseUnary();
+            if (!right) return nullptr;
+            left = [left, right](const ProcessSnapshot &snapshot, int row, ProcessFilter::StringResults &cache) {
+                return left(snapshot, row, cache) && right(snapshot, row, cache);
+            };
+        }
+        return left;
+    }
+
+    Predicate parseUnary() {
+        if (current.type == TokenType::Not) {
+            advance();
+            Predicate operand = parseUnary();
+            if (!operand) return nullptr;
+            return [operand](const ProcessSnapshot &snapshot, int row, ProcessFilter::StringResults &cache) {
+                return !operand(snapshot, row, cache);
+            };
+        }
+        return parsePrimary();
+    }
+
+    Predicate parsePrimary() {
+        if (current.type == TokenType::LeftParen) {
+            advance();
+            Predicate inner = parseOr();
+            if (!inner) return nullptr;
+            if (current.type != TokenType::RightParen) {
+                return fail("Expected ')'");
+            }
+            advance();
+            return inner;
+        }
+
+        if (current.type != TokenType::Identifier) {
+            return current.type == TokenType::End ? fail("Unexpected end of query")
+                                                  : fail(QString("Unexpected '%1'").arg(current.text));
+        }
+
+        const FieldInfo *field = findField(current.text);
+        if (!field) {
+            return fail(QString("Unknown field '%1'").arg(current.text));
+        }
+        QString fieldName = current.text;
+        advance();
+
+        // A bare boolean field is shorthand for "field == true"
+        if (current.type != TokenType::Operator) {
+            if (field->type != FieldType::Boolean) {
+                return fail(QString("Expected an operator after '%1'").arg(fieldName));
+            }
+            return numericComparison("!=", field->column, 0);
+        }
+
+        QString op = current.text;
+        advance();
+
+        switch (field->type) {
+        case FieldType::String:
+            return parseStringComparison(fieldName, op);
+        case FieldType::Number:
+            return parseNumberComparison(field->column, op);
+        case FieldType::Boolean:
+            return parseBooleanComparison(field->column, op);
+        }
+        return nullptr;
+    }
+
+    Predicate parseStringComparison(const QString &fieldName, const QString &op) {
+        if (current.type != TokenType::String && current.type != TokenType::Identifier && current.type != TokenType::Number) {
+            return fail("Expected a string");
+        }
+        Predicate predicate = stringComparison(stringComparisons, fieldName, op, current.text);
+        if (!predicate) {
+            return fail(QString("Operator '%1' is not valid for text fields").arg(op));
+        }
+        ++stringComparisons;
+        advance();
+        return predicate;
+    }
+
+    Predicate parseNumberComparison(ProcessSnapshot::Column column, const QString &op) {
+        if (current.type != TokenType::Number) {
+            return fail("Expected a number");
+        }
+
+        qint64 value = 0;
+        if (!parseNumber(current.text, value)) {
+            return fail(QString("Invalid number '%1'").arg(current.text));
+        }
+        Predicate predicate = numericComparison(op, column, value);
+        if (!predicate) {
+            return fail(QString("Operator '%1' is not valid for numeric fields").arg(op));
+        }
+        advance();
+        return predicate;
+    }
+
+    Predicate parseBooleanComparison(ProcessSnapshot::Column column, const QString &op) {
+        if (op != "==" && op != "!=") {
+            return fail(QString("Operator '%1' is not valid for flags").arg(op));
+        }
+
+        bool value;
+        if (current.text.compare(QLatin1String("true"), Qt::CaseInsensitive) == 0 || current.text == "1") {
+            value = true;
+        } else if (current.text.compare(QLatin1String("false"), Qt::CaseInsensitive) == 0 || current.text == "0") {
+            value = false;
+        } else {
+            return fail("Expected true or false");
+        }
+        advance();
+
+        bool wantSet = (op == "==") == value;
+        return numericComparison(wantSet ? "!=" : "==", column, 0);
+    }
+
+    // Parses "500", "-100", "1.5GB", "200kb" into an integer
+    static bool parseNumber(const QString &text, qint64 &value) {
+        int digits = text.startsWith('-') ? 1 : 0;
+        while (digits < text.size() && (text[digits].isDigit() || text[digits] == '.')) {
+            ++digits;
+        }
+
+        bool ok;
+        double number = text.left(digits).toDouble(&ok);
+        if (!ok) {
+            return false;
+        }
+
+        QString suffix = text.mid(digits).toUpper();
+        double multiplier = 1;
+        if (suffix == "KB" || suffix == "K") {
+            multiplier = 1024.0;
+        } else if (suffix == "MB" || suffix == "M") {
+            multiplier = 1024.0 * 1024.0;
+        } else if (suffix == "GB" || suffix == "G") {
+            multiplier = 1024.0 * 1024.0 * 1024.0;
+        } else if (!suffix.isEmpty() && suffix != "B") {
+            return false;
+        }
+
+        value = static_cast<qint64>(number * multiplier);
+        return true;
+    }
+
+    Lexer lexer;
+    Token current;
+    QString errorMessage;
+    int stringComparisons;  // String comparisons parsed so far; the next one gets this slot
+};
+
+#pragma endregion
+
+} // namespace
+
+#pragma region Constructors and Destructor
+
+/**
+ * @brief Creates an empty filter that matches nothing.
+ */
+ProcessFilter::ProcessFilter() : stringComparisons(0) {}
+
+/**
+ * @brief Creates a filter and compiles the given query.
+ */
+ProcessFilter::ProcessFilter(const QString &query) : stringComparisons(0) {
+    compile(query);
+}
+
+/**
+ * @brief Destructor for ProcessFilter.
+ */
+ProcessFilter::~ProcessFilter() {}
+
+#pragma endregion
+
+#pragma region Compilation
+
+/**
+ * @brief Parses the query once and keeps the resulting closure tree.
+ * @return True on success.
+ */
+bool ProcessFilter::compile(const QString &query) {
+    source = query;
+    error.clear();
+
+    stringComparisons = 0;
+    if (query.trimmed().isEmpty()) {
+        predicate = nullptr;
+        error = "Empty query";
+        return false;
+    }
+
+    Parser parser(query);
+    predicate = parser.parse(error);
+    stringComparisons = parser.stringComparisonCount();
+    return static_cast<bool>(predicate);
+}
+
+/**
+ * @brief Returns true if the filter has a compiled predicate.
+ */
+bool ProcessFilter::isValid() const {
+    return static_cast<bool>(predicate);
+}
+
+/**
+ * @brief Returns the last compile error.
+ */
+QString ProcessFilter::errorString() const {
+    return error;
+}
+
+/**
+ * @brief Returns the query text.
+ */
+QString ProcessFilter::query() const {
+    return source;
+}
+
+#pragma endregion
+
+#pragma region Evaluation
+
+/**
+ * @brief Evaluates the compiled predicate against one row with a cache of its own.
+ */
+bool ProcessFilter::matches(const ProcessSnapshot &snapshot, int row) const {
+    if (!predicate) {
+        return false;
+    }
+    StringResults cache;
+    cache.comparisons.resize(static_cast<size_t>(stringComparisons));
+    return predicate(snapshot, row, cache);
+}
+
+/**
+ * @brief Evaluates the compiled predicate against all rows.
+ * @return The matching row indices.
+ */
+QVector<int> ProcessFilter::select(const ProcessSnapshot &snapshot) const {
+    QVector<int> rows;
+    if (!predicate) {
+        return rows;
+    }
+
+    // One cache for all rows: each distinct string is tested at most once per comparison
+    StringResults cache;
+    cache.comparisons.resize(static_cast<size_t>(stringComparisons));
+    const int count = snapshot.size();
+    for (int row = 0; row < count; ++row) {
+        if (predicate(snapshot, row, cache)) {
+            rows.append(row);
+        }
+    }
+    return rows;
+}
+
+#pragma endregion
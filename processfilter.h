@@ -0,0 +1,120 @@
+#ifndef PROCESSFILTER_H
+#define PROCESSFILTER_H
+
+#include <QString>
+#include <QVector>
+#include <functional>
+#include <vector>
+#include "processsnapshot.h"
+
+/**
+ * @class ProcessFilter
+ * @brief A filter query compiled once into a closure tree and evaluated against ProcessSnapshot rows.
+ *
+ * Query syntax:
+ *   - Comparisons:  field op value, e.g. `rss > 500MB`, `name ~ "chrome"`, `pid == 1234`
+ *   - Operators:    == != < <= > >= for numbers, == != ~ (contains) !~ (does not contain) for strings
+ *   - Boolean:      `topmost`, `visible`, `!topmost`, `topmost == false`
+ *   - Combinators:  && || ! and parentheses
+ *
+ * Fields: name, title, class, pid, ppid, threads, rss, cputime (ms), x, y, width, height, opacity, topmost,
+ * visible. Numbers may be negative (`x < -100`) and accept the size suffixes KB, MB and GB (1024-based). String
+ * matching is case-insensitive and `name == "chrome"` matches "chrome.exe", the same way process names are
+ * normalized by ProcessManager.
+ *
+ * String comparisons are evaluated once per interned string of a snapshot. The results are kept in a
+ * StringResults cache owned by each matches() or select() call, so a compiled filter holds no mutable
+ * state: the same filter and its copies may be evaluated from several threads at once. compile() replaces
+ * the closure tree and must not run while that filter is being evaluated.
+ */
+class ProcessFilter {
+public:
+    /**
+     * @brief Results of the string comparisons of one evaluation against one snapshot.
+     */
+    struct StringResults {
+        std::vector<std::vector<qint8>> comparisons;    // Per string comparison: string ID -> -1 unknown, 0 no match, 1 match
+    };
+
+    /**
+     * @brief A compiled predicate deciding whether a snapshot row matches.
+     */
+    using Predicate = std::function<bool(const ProcessSnapshot &, int, StringResults &)>;
+
+    #pragma region Constructors and Destructor
+
+    /**
+     * @brief Creates an invalid (empty) filter.
+     */
+    ProcessFilter();
+
+    /**
+     * @brief Creates a filter and compiles the given query.
+     * @param query The filter query.
+     */
+    explicit ProcessFilter(const QString &query);
+
+    /**
+     * @brief Destructor for cleaning up the compiled closure tree.
+     */
+    ~ProcessFilter();
+
+    #pragma endregion
+
+    #pragma region Compilation
+
+    /**
+     * @brief Parses and compiles a query, replacing the current one.
+     * @param query The filter query.
+     * @return True on success; on failure errorString() describes the problem.
+     */
+    bool compile(const QString &query);
+
+    /**
+     * @brief Returns true if a query has been compiled successfully.
+     */
+    bool isValid() const;
+
+    /**
+     * @brief Returns the last compile error, or an empty string.
+     */
+    QString errorString() const;
+
+    /**
+     * @brief Returns the source text of the compiled query.
+     */
+    QString query() const;
+
+    #pragma endregion
+
+    #pragma region Evaluation
+
+    /**
+     * @brief Evaluates the filter against a single row.
+     * @param snapshot The snapshot to read from.
+     * @param row The row index.
+     * @return True if the row matches. An invalid filter matches nothing.
+     */
+    bool matches(const ProcessSnapshot &snapshot, int row) const;
+
+    /**
+     * @brief Evaluates the filter against every row of a snapshot.
+     * @param snapshot The snapshot to read from.
+     * @return The indices of all matching rows, in snapshot order.
+     */
+    QVector<int> select(const ProcessSnapshot &snapshot) const;
+
+    #pragma endregion
+
+private:
+    #pragma region Member Variables
+
+    Predicate predicate;    // Root of the compiled closure tree
+    int stringComparisons;  // String comparisons in the tree, one StringResults slot each
+    QString source;         // Query text
+    QString error;          // Last compile error
+
+    #pragma endregion
+};
+
+#endif // PROCESSFILTER_H
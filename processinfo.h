@@ -2,7 +2,7 @@
 #define PROCESSINFO_H
 
 #include <QString>
-#include <windows.h> // For the DWORD type
+#include "platform.h" // For the DWORD type
 
 /**
  * @class ProcessInfo
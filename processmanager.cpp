@@ -1,10 +1,14 @@
 #include "processmanager.h"
-#include <tlhelp32.h>
-#include <algorithm>
+#include "tracer.h"
 
 // Constructor and Destructor
-ProcessManager::ProcessManager() : logCallback(nullptr) {}
-ProcessManager::~ProcessManager() {}
+ProcessManager::ProcessManager(WindowBackend *backend)
+    : backend(backend ? backend : WindowBackend::systemBackend()), targetWindow(NULL), windowTree(this->backend),
+      animator(nullptr), journal(this->backend), layoutTracked(false), layoutWatched(false), layoutStale(true),
+      logCallback(nullptr) {}
+ProcessManager::~ProcessManager() {
+    trackWindowLayout(false);   // The watch callback refers to this object
+}
 
 // Utility: Normalize the process name for case-insensitive comparison
 QString ProcessManager::normalizeProcessName(const QString& processName) const {
@@ -17,56 +21,52 @@ QString ProcessManager::normalizeProcessName(const QString& processName) const {
 
 // Find process ID by process name
 DWORD ProcessManager::findProcessIdByName(const QString &processName) {
+    TRACE_SCOPE("ProcessManager::findProcessIdByName");
     QString normalizedName = normalizeProcessName(processName);
+    DWORD processId = 0;
 
-    PROCESSENTRY32 processEntry;
-    processEntry.dwSize = sizeof(PROCESSENTRY32);
-
-    HANDLE snapshot = CreateToolhelp32Snapshot(TH32CS_SNAPPROCESS, 0);
-    if (snapshot == INVALID_HANDLE_VALUE) {
-        return 0;
-    }
-
-    if (Process32First(snapshot, &processEntry)) {
-        do {
-            QString currentProcessName = QString::fromWCharArray(processEntry.szExeFile);
-            QString normalizedCurrentName = normalizeProcessName(currentProcessName);
+    backend->enumerateProcesses([&](const WindowBackend::ProcessEntry &entry) {
+        QString currentProcessName = entry.name.toString();
+        QString normalizedCurrentName = normalizeProcessName(currentProcessName);
 
-            if (normalizedCurrentName == normalizedName) {
-                CloseHandle(snapshot);
-                processInfo.setProcessName(currentProcessName); // Save process name
-                return processEntry.th32ProcessID;
-            }
-        } while (Process32Next(snapshot, &processEntry));
-    }
+        if (normalizedCurrentName == normalizedName) {
+            processInfo.setProcessName(currentProcessName); // Save process name
+            processId = entry.processId;
+            return false;
+        }
+        return true;
+    });
 
-    CloseHandle(snapshot);
-    return 0;
+    return processId;
 }
 
 // Find window handle by process ID
 HWND ProcessManager::findWindowByProcessId(DWORD processId) {
-    struct EnumWindowsData {
-        DWORD processId;
-        HWND hWnd;
-    } data = { processId, NULL };
+    TRACE_SCOPE("ProcessManager::findWindowByProcessId");
+    HWND found = NULL;
 
-    EnumWindows([](HWND hWnd, LPARAM lParam) -> BOOL {
-        EnumWindowsData* data = reinterpret_cast<EnumWindowsData*>(lParam);
-        DWORD windowProcessId;
-        GetWindowThreadProcessId(hWnd, &windowProcessId);
-        if (windowProcessId == data->processId && IsWindowVisible(hWnd)) {
-            data->hWnd = hWnd;
-            return FALSE;   // Stop enumerating if window is found
+    backend->enumerateWindows([&](HWND hWnd) {
+        if (backend->windowProcessId(hWnd) == processId && backend->isWindowVisible(hWnd)) {
+            found = hWnd;
+            return false;   // Stop enumerating if window is found
         }
-        return TRUE;        // Continue enumerating
-    }, reinterpret_cast<LPARAM>(&data));
+        return true;        // Continue enumerating
+    });
 
-    return data.hWnd;       // Return window handle (NULL if none found)
+    return found;           // Return window handle (NULL if none found)
+}
+
+// Use the target window override if it still belongs to the process
+HWND ProcessManager::windowForProcess(DWORD processId) {
+    if (targetWindow != NULL && processId != 0 && backend->windowProcessId(targetWindow) == processId) {
+        return targetWindow;
+    }
+    return findWindowByProcessId(processId);
 }
 
 // Retrieve process details and log information
 void ProcessManager::getProcessDetails(const QString &processNameOrId, std::function<void(const QString &)> logCallback) {
+    TRACE_SCOPE("ProcessManager::getProcessDetails");
     this->logCallback = logCallback;
 
     bool isId;
@@ -83,7 +83,7 @@ void ProcessManager::getProcessDetails(const QString &processNameOrId, std::func
     logCallback(QString("Found process ID: %1").arg(processId));
 
     if (processId != 0) {
-        HWND hWnd = findWindowByProcessId(processId);
+        HWND hWnd = windowForProcess(processId);
         retrieveWindowInfo(hWnd);                           // Get window title and TopMost status
     } else {
         logCallback("Process not found");
@@ -92,24 +92,24 @@ void ProcessManager::getProcessDetails(const QString &processNameOrId, std::func
 
 // Retrieve window information (title, TopMost, size, opacity)
 void ProcessManager::retrieveWindowInfo(HWND hWnd) {
+    TRACE_SCOPE("ProcessManager::retrieveWindowInfo");
     if (hWnd == NULL) {
         logCallback("Window handle not found");
         return;
     }
 
     // Get window title
-    TCHAR windowTitle[256];
-    GetWindowText(hWnd, windowTitle, sizeof(windowTitle) / sizeof(TCHAR));
-    processInfo.setProcessTitle(QString::fromWCharArray(windowTitle));
+    char16_t windowTitle[256];
+    int titleLength = backend->windowTitle(hWnd, windowTitle, 256);
+    processInfo.setProcessTitle(QStringView(windowTitle, titleLength).toString());
 
     // Check if window is "TopMost"
-    LONG_PTR style = GetWindowLongPtr(hWnd, GWL_EXSTYLE);
-    bool isTopMost = (style & WS_EX_TOPMOST) != 0;
+    bool isTopMost = backend->isTopMost(hWnd);
     processInfo.setTopMost(isTopMost ? "Yes" : "No");
 
     // Get window size
     RECT rect;
-    if (GetWindowRect(hWnd, &rect)) {
+    if (backend->windowRect(hWnd, rect)) {
         processInfo.setWidth(rect.right - rect.left);
         processInfo.setHeight(rect.bottom - rect.top);
     } else {
@@ -117,119 +117,672 @@ void ProcessManager::retrieveWindowInfo(HWND hWnd) {
     }
 
     // Get current window opacity
-    BYTE alpha = 255;
-    if (GetLayeredWindowAttributes(hWnd, NULL, &alpha, NULL)) {
-        processInfo.setOpacity(static_cast<int>(alpha));
+    int opacity = 255;
+    if (backend->windowOpacity(hWnd, opacity)) {
+        processInfo.setOpacity(opacity);
     }
 
     logCallback("Window information retrieved");
 }
 
 // Set the process window title
-void ProcessManager::SetProcessWindowTitle(const QString& title, DWORD processID) {
-    HWND hWnd = findWindowByProcessId(processID);
+bool ProcessManager::SetProcessWindowTitle(const QString& title, DWORD processID) {
+    return SetWindowTitle(windowForProcess(processID), title);
+}
 
-    if (hWnd != NULL) {
-        SetWindowText(hWnd, title.toStdWString().c_str());
-        logCallback(QString("Window title changed to: %1").arg(title));
-    } else {
+// Set or remove TopMost status for a process window
+bool ProcessManager::SetProcessWindowTopMost(bool topMost, DWORD processID) {
+    return SetWindowTopMost(windowForProcess(processID), topMost);
+}
+
+// Set the process window size
+bool ProcessManager::SetProcessWindowSize(int width, int height) {
+    return SetProcessWindowSize(width, height, processInfo.getProcessId());
+}
+
+// Set the window size of the given process
+bool ProcessManager::SetProcessWindowSize(int width, int height, DWORD processID) {
+    return SetWindowSize(windowForProcess(processID), width, height);
+}
+
+// Set the process window transparency (opacity)
+bool ProcessManager::SetProcessWindowTransparency(int value) {
+    return SetProcessWindowTransparency(value, processInfo.getProcessId());
+}
+
+// Set the window transparency (opacity) of the given process
+bool ProcessManager::SetProcessWindowTransparency(int value, DWORD processID) {
+    return SetWindowTransparency(windowForProcess(processID), value);
+}
+
+// Set the title of a window, or stage it inside a transaction
+bool ProcessManager::SetWindowTitle(HWND hWnd, const QString &title) {
+    TRACE_SCOPE("ProcessManager::SetWindowTitle");
+    if (hWnd != NULL && journal.isOpen()) {
+        journal.setTitle(hWnd, title);  // Applied and logged by commitTransaction()
+    } else if (hWnd == NULL) {
         logCallback("Window handle not found, cannot change window title.");
+        return false;
+    } else if (!backend->setWindowTitle(hWnd, title)) {
+        logCallback("Failed to change the window title");
+        return false;
+    } else {
+        logCallback(QString("Window title changed to: %1").arg(title));
     }
+    return true;
 }
 
-// Set or remove TopMost status for a process window
-void ProcessManager::SetProcessWindowTopMost(bool topMost, DWORD processID) {
-    HWND hWnd = findWindowByProcessId(processID);
+// Set or remove the TopMost status of a window, or stage it inside a transaction
+bool ProcessManager::SetWindowTopMost(HWND hWnd, bool topMost) {
+    TRACE_SCOPE("ProcessManager::SetWindowTopMost");
+    if (hWnd != NULL && journal.isOpen()) {
+        journal.setTopMost(hWnd, topMost);
+    } else if (hWnd == NULL) {
+        logCallback("Window handle not found, cannot change topmost status.");
+        return false;
+    } else if (!backend->setTopMost(hWnd, topMost)) {
+        logCallback("Failed to change the topmost status");
+        return false;
+    } else {
+        logCallback(topMost ? "Window set to topmost." : "Window removed from topmost.");
+    }
+    return true;
+}
 
-    if (hWnd != NULL) {
-        if (topMost) {
-            SetWindowPos(hWnd, HWND_TOPMOST, 0, 0, 0, 0, SWP_NOMOVE | SWP_NOSIZE);
-            logCallback("Window set to topmost.");
-        } else {
-            SetWindowPos(hWnd, HWND_NOTOPMOST, 0, 0, 0, 0, SWP_NOMOVE | SWP_NOSIZE);
-            logCallback("Window removed from topmost.");
+// Resize a window, or stage the new rectangle inside a transaction
+bool ProcessManager::SetWindowSize(HWND hWnd, int width, int height) {
+    TRACE_SCOPE("ProcessManager::SetWindowSize");
+    RECT rect;
+    if (hWnd != NULL && journal.isOpen()) {
+        if (!backend->windowRect(hWnd, rect)) {
+            logCallback("Failed to read the window rectangle");
+            return false;
         }
+        rect.right = rect.left + width;     // Resizing keeps the position
+        rect.bottom = rect.top + height;
+        journal.setGeometry(hWnd, rect);
+    } else if (hWnd == NULL) {
+        logCallback("Window handle not found");
+        return false;
+    } else if (!backend->resizeWindow(hWnd, width, height)) {
+        logCallback("Failed to resize the window");
+        return false;
     } else {
-        logCallback("Window handle not found, cannot change topmost status.");
+        logCallback(QString("Window size set to %1x%2").arg(width).arg(height));
     }
+    return true;
 }
 
-// Set the process window size
-void ProcessManager::SetProcessWindowSize(int width, int height) {
-    HWND hWnd = findWindowByProcessId(processInfo.getProcessId());
-    if (hWnd != NULL) {
-        SetWindowPos(hWnd, HWND_TOP, 0, 0, width, height, SWP_NOMOVE | SWP_NOACTIVATE);
-        logCallback(QString("Window size set to %1x%2").arg(width).arg(height));
-    } else {
+// Set the opacity of a window, or stage it inside a transaction
+bool ProcessManager::SetWindowTransparency(HWND hWnd, int value) {
+    TRACE_SCOPE("ProcessManager::SetWindowTransparency");
+    if (hWnd != NULL && journal.isOpen()) {
+        journal.setOpacity(hWnd, value);
+    } else if (hWnd == NULL) {
         logCallback("Window handle not found");
+        return false;
+    } else if (!backend->setWindowOpacity(hWnd, value)) {
+        logCallback("Failed to change the window opacity");
+        return false;
+    } else {
+        logCallback(QString("Window opacity set to: %1").arg(value));
     }
+    return true;
 }
 
-// Set the process window transparency (opacity)
-void ProcessManager::SetProcessWindowTransparency(int value) {
-    HWND hWnd = findWindowByProcessId(processInfo.getProcessId());
-    if (hWnd != NULL) {
-        BYTE alpha = static_cast<BYTE>(std::clamp(value, 0, 255));
-        SetWindowLongPtr(hWnd, GWL_EXSTYLE, GetWindowLongPtr(hWnd, GWL_EXSTYLE) | WS_EX_LAYERED);
-        SetLayeredWindowAttributes(hWnd, 0, alpha, LWA_ALPHA);
-        logCallback(QString("Window opacity set to: %1").arg(value));
+// Start staging the Set operations
+bool ProcessManager::beginTransaction(const QString &label) {
+    return journal.begin(label);
+}
+
+// Apply the staged changes as one batch and journal them
+int ProcessManager::commitTransaction() {
+    TRACE_SCOPE("ProcessManager::commitTransaction");
+    int changed = journal.commit();
+    if (changed > 0) {
+        logCallback(QString("%1: changed %2 windows").arg(journal.undoLabel()).arg(changed));
     } else {
-        logCallback("Window handle not found");
+        logCallback("No window was changed");
     }
+    return changed;
 }
 
-// Kill the process
-void ProcessManager::KillProcessWindow() {
-    DWORD processID = processInfo.getProcessId();
-    if (processID != 0) {
-        HANDLE hProcess = OpenProcess(PROCESS_TERMINATE, FALSE, processID);
-        if (hProcess) {
-            TerminateProcess(hProcess, 0);
-            CloseHandle(hProcess);
-            logCallback("Process killed");
-        } else {
-            logCallback("Failed to open process for termination");
-        }
+// Discard the staged changes
+void ProcessManager::rollbackTransaction() {
+    journal.rollback();
+}
+
+// Revert the last committed transaction
+int ProcessManager::undo() {
+    QString label = journal.undoLabel();
+    int restored = journal.undo();
+    if (restored < 0) {
+        logCallback("Nothing to undo");
     } else {
-        logCallback("Process ID not set");
+        logCallback(QString("Undo %1: restored %2 windows").arg(label).arg(restored));
     }
+    logUnverifiedWindows();
+    return restored;
 }
 
-// Maximize the process window
-void ProcessManager::MaximizeProcessWindow() {
-    HWND hWnd = findWindowByProcessId(processInfo.getProcessId());
-    if (hWnd != NULL) {
-        ShowWindow(hWnd, SW_MAXIMIZE);
-        logCallback("Window maximized");
+// Apply the last undone transaction again
+int ProcessManager::redo() {
+    QString label = journal.redoLabel();
+    int changed = journal.redo();
+    if (changed < 0) {
+        logCallback("Nothing to redo");
     } else {
-        logCallback("Window handle not found");
+        logCallback(QString("Redo %1: changed %2 windows").arg(label).arg(changed));
     }
+    logUnverifiedWindows();
+    return changed;
 }
 
-// Minimize the process window
-void ProcessManager::MinimizeProcessWindow() {
-    HWND hWnd = findWindowByProcessId(processInfo.getProcessId());
-    if (hWnd != NULL) {
-        ShowWindow(hWnd, SW_MINIMIZE);
-        logCallback("Window minimized");
+// Report windows the journal left alone because their process could not be identified
+void ProcessManager::logUnverifiedWindows() {
+    int skipped = journal.unverifiedCount();
+    if (skipped > 0) {
+        logCallback(QString("Skipped %1 windows: their process could not be opened, so a reused process ID cannot be ruled out").arg(skipped));
+    }
+}
+
+// Return the undo history
+const ChangeJournal &ProcessManager::getJournal() const {
+    return journal;
+}
+
+// Set the animator of the Animate operations
+void ProcessManager::setAnimator(WindowAnimator *animator) {
+    this->animator = animator;
+}
+
+// Watch window changes into the layout; the first Animate operation reads it in full
+void ProcessManager::trackWindowLayout(bool enabled) {
+    if (layoutWatched) {
+        backend->watchWindowLayout(nullptr);
+        layoutWatched = false;
+    }
+    layoutTracked = enabled;
+    layoutStale = true;
+    windowLayout.clear();
+    if (!enabled) {
+        return;
+    }
+
+    layoutWatched = backend->watchWindowLayout([this](HWND hWnd) {
+        // A stale layout is read in full anyway; z-order changes and unknown windows make it stale
+        if (!layoutStale && (hWnd == NULL || !updateWindowLayout(windowLayout, hWnd))) {
+            layoutStale = true;
+        }
+    });
+}
+
+// Return the tracked window layout
+const WindowSpatialIndex &ProcessManager::getWindowLayout() const {
+    return windowLayout;
+}
+
+// Read the layout in full if it is stale; without window change events it stays stale
+bool ProcessManager::isWindowOccluded(HWND hWnd) {
+    if (!layoutTracked) {
+        return false;
+    }
+    if (layoutStale) {
+        captureWindowLayout(windowLayout);
+        layoutStale = !layoutWatched;
+    }
+    return windowLayout.isOccluded(hWnd);
+}
+
+// Fade the window of the given process; without an animator, or if the window is covered, the value is applied at once
+void ProcessManager::AnimateProcessWindowTransparency(int value, int durationMs, DWORD processID) {
+    TRACE_SCOPE("ProcessManager::AnimateProcessWindowTransparency");
+    HWND hWnd = windowForProcess(processID);
+    if (hWnd == NULL) {
+        logCallback("Window handle not found");
+        return;
+    }
+
+    if (isWindowOccluded(hWnd)) {
+        if (animator) {
+            animator->stop(hWnd);   // A running fade would overwrite the value on its next frame
+        }
+        backend->setWindowOpacity(hWnd, value);
+        logCallback(QString("Window opacity set to: %1 (window is covered, fade skipped)").arg(value));
+    } else if (animator && animator->animateOpacity(hWnd, value, durationMs)) {
+        logCallback(QString("Window opacity fading to %1 over %2 ms").arg(value).arg(durationMs));
     } else {
+        backend->setWindowOpacity(hWnd, value);
+        logCallback(QString("Window opacity set to: %1").arg(value));
+    }
+}
+
+// Move and resize the window of the given process; without an animator the rectangle is applied at once
+void ProcessManager::AnimateProcessWindowGeometry(const RECT &rect, int durationMs, DWORD processID) {
+    TRACE_SCOPE("ProcessManager::AnimateProcessWindowGeometry");
+    HWND hWnd = windowForProcess(processID);
+    if (hWnd == NULL) {
         logCallback("Window handle not found");
+        return;
+    }
+
+    if (!animator || !animator->animateGeometry(hWnd, rect, durationMs)) {
+        backend->setWindowGeometries({ { hWnd, rect } });
     }
+    logCallback(QString("Window moving to %1,%2 (%3x%4)")
+                    .arg(rect.left).arg(rect.top).arg(rect.right - rect.left).arg(rect.bottom - rect.top));
+}
+
+// Kill the process
+void ProcessManager::KillProcessWindow() {
+    ExecuteWindowCommand(Kill, processInfo.getProcessId());
+}
+
+// Maximize the process window
+void ProcessManager::MaximizeProcessWindow() {
+    ExecuteWindowCommand(Maximize, processInfo.getProcessId());
+}
+
+// Minimize the process window
+void ProcessManager::MinimizeProcessWindow() {
+    ExecuteWindowCommand(Minimize, processInfo.getProcessId());
 }
 
 // Focus the process window
 void ProcessManager::FocusProcessWindow() {
-    HWND hWnd = findWindowByProcessId(processInfo.getProcessId());
-    if (hWnd != NULL) {
-        if (IsIconic(hWnd)) {
-            ShowWindow(hWnd, SW_RESTORE); // Restore if minimized
-        }
-        SetForegroundWindow(hWnd);
-        SetFocus(hWnd);
-        logCallback("Window focused");
-    } else {
+    ExecuteWindowCommand(Focus, processInfo.getProcessId());
+}
+
+// Execute a window command on the given process
+bool ProcessManager::ExecuteWindowCommand(WindowCommand command, DWORD processID) {
+    TRACE_SCOPE("ProcessManager::ExecuteWindowCommand");
+    if (command == Kill) {
+        if (processID == 0) {
+            logCallback("Process ID not set");
+            return false;
+        }
+        if (!backend->terminateProcess(processID)) {
+            logCallback("Failed to open process for termination");
+            return false;
+        }
+        logCallback("Process killed");
+        return true;
+    }
+
+    HWND hWnd = windowForProcess(processID);
+    if (hWnd == NULL) {
+        logCallback("Window handle not found");
+        return false;
+    }
+    return ExecuteWindowCommand(hWnd, command);
+}
+
+// Execute a window command on the given window
+bool ProcessManager::ExecuteWindowCommand(HWND hWnd, WindowCommand command) {
+    if (hWnd == NULL) {
         logCallback("Window handle not found");
+        return false;
+    }
+    if (command == Kill) {
+        return ExecuteWindowCommand(Kill, backend->windowProcessId(hWnd));
+    }
+
+    bool done = false;
+    switch (command) {
+    case Maximize:
+        done = backend->showWindow(hWnd, WindowBackend::ShowMaximized);
+        logCallback(done ? "Window maximized" : "Failed to maximize the window");
+        break;
+    case Minimize:
+        done = backend->showWindow(hWnd, WindowBackend::ShowMinimized);
+        logCallback(done ? "Window minimized" : "Failed to minimize the window");
+        break;
+    case Focus:
+        if (backend->isMinimized(hWnd)) {
+            backend->showWindow(hWnd, WindowBackend::ShowRestored); // Restore if minimized
+        }
+        done = backend->focusWindow(hWnd);
+        logCallback(done ? "Window focused" : "Failed to focus the window");
+        break;
+    default:
+        break;
+    }
+    return done;
+}
+
+// Capture all processes and their main windows into a columnar snapshot
+void ProcessManager::captureSnapshot(ProcessSnapshot &snapshot) {
+    TRACE_SCOPE("ProcessManager::captureSnapshot");
+    snapshot.clear();
+    snapshot.setCaptureTime(backend->tickCount());
+
+    {
+        TRACE_SCOPE("captureSnapshot: processes");
+        backend->enumerateProcesses([&](const WindowBackend::ProcessEntry &entry) {
+            int row = snapshot.appendProcess(entry.processId, entry.parentProcessId, entry.name, entry.threadCount);
+
+            // Memory, CPU usage and creation time (fails for protected processes, which keep zeros)
+            qint64 workingSet = 0;
+            qint64 cpuTime = 0;
+            qint64 creationTime = 0;
+            if (backend->queryResourceUsage(entry.processId, workingSet, cpuTime, creationTime)) {
+                snapshot.setResourceUsage(row, workingSet, cpuTime);
+                snapshot.setCreationTime(row, creationTime);
+            }
+            return true;
+        });
+    }
+
+    // Attach the first visible top-level window of each process (same rule as findWindowByProcessId)
+    TRACE_SCOPE("captureSnapshot: windows");
+    backend->enumerateWindows([&](HWND hWnd) {
+        if (!backend->isWindowVisible(hWnd)) {
+            return true;
+        }
+
+        int row = snapshot.findRow(backend->windowProcessId(hWnd));
+        if (row < 0 || snapshot.windowHandle(row) != NULL) {
+            return true;
+        }
+
+        // Titles and class names are interned straight from the stack buffers
+        char16_t windowTitle[256];
+        int titleLength = backend->windowTitle(hWnd, windowTitle, 256);
+        char16_t windowClass[256];
+        int classLength = backend->windowClass(hWnd, windowClass, 256);
+
+        RECT rect = {};
+        backend->windowRect(hWnd, rect);
+
+        int opacity = 255;
+        backend->windowOpacity(hWnd, opacity);
+
+        snapshot.setWindowInfo(row, hWnd, QStringView(windowTitle, titleLength), QStringView(windowClass, classLength),
+                               rect, backend->isTopMost(hWnd), opacity);
+        return true;
+    });
+}
+
+// Update a spatial index from the top-level windows, topmost first
+int ProcessManager::captureWindowLayout(WindowSpatialIndex &index) {
+    TRACE_SCOPE("ProcessManager::captureWindowLayout");
+    int changed = 0;
+    int zOrder = 0;
+
+    index.beginUpdate();
+    backend->enumerateWindows([&](HWND hWnd) {
+        if (!backend->isWindowVisible(hWnd) || backend->isMinimized(hWnd) || backend->isCloaked(hWnd)) {
+            return true;
+        }
+
+        RECT rect = {};
+        if (!backend->windowFrameRect(hWnd, rect)) {
+            return true;
+        }
+
+        int opacity = 255;
+        backend->windowOpacity(hWnd, opacity);
+
+        if (index.setWindow(hWnd, backend->windowProcessId(hWnd), rect, zOrder++, opacity == 255)) {
+            ++changed;
+        }
+        return true;
+    });
+    index.endUpdate();
+    return changed;
+}
+
+// Update one window in place; only windows already in the index have a known z-order
+bool ProcessManager::updateWindowLayout(WindowSpatialIndex &index, HWND hWnd) {
+    TRACE_SCOPE("ProcessManager::updateWindowLayout");
+    DWORD processId = backend->windowProcessId(hWnd);
+    RECT rect = {};
+    if (processId == 0 || !backend->isWindowVisible(hWnd) || backend->isMinimized(hWnd) || backend->isCloaked(hWnd)
+        || !backend->windowFrameRect(hWnd, rect)) {
+        index.removeWindow(hWnd);
+        return true;
+    }
+
+    int zOrder = index.windowZOrder(hWnd);
+    if (zOrder < 0) {
+        return false;
+    }
+
+    int opacity = 255;
+    backend->windowOpacity(hWnd, opacity);
+    index.setWindow(hWnd, processId, rect, zOrder, opacity == 255);
+    return true;
+}
+
+// Pass every visible top-level window to a title watch, straight from a stack buffer
+QVector<TitleWatch::Match> ProcessManager::scanWindowTitles(const ProcessSnapshot &snapshot, TitleWatch &watch) {
+    TRACE_SCOPE("ProcessManager::scanWindowTitles");
+    watch.beginScan();
+    backend->enumerateWindows([&](HWND hWnd) {
+        if (!backend->isWindowVisible(hWnd)) {
+            return true;
+        }
+
+        char16_t title[256];
+        int length = backend->windowTitle(hWnd, title, 256);
+        DWORD processId = backend->windowProcessId(hWnd);
+        int row = snapshot.findRow(processId);
+        watch.scanWindow(hWnd, processId, row >= 0 ? snapshot.processName(row) : QStringView(),
+                         QStringView(title, length));
+        return true;
+    });
+    return watch.endScan();
+}
+
+// Retrieve process details for the first process matching a filter
+void ProcessManager::getProcessDetailsByFilter(const ProcessFilter &filter, std::function<void(const QString &)> logCallback) {
+    TRACE_SCOPE("ProcessManager::getProcessDetailsByFilter");
+    this->logCallback = logCallback;
+    processInfo = ProcessInfo();
+
+    if (!filter.isValid()) {
+        logCallback(QString("Invalid filter: %1").arg(filter.errorString()));
+        return;
+    }
+
+    captureSnapshot(snapshot);
+    QVector<int> rows;
+    {
+        TRACE_SCOPE("ProcessFilter::select");
+        rows = filter.select(snapshot);
+    }
+    logCallback(QString("Filter matched %1 of %2 processes").arg(rows.size()).arg(snapshot.size()));
+
+    const int maxLoggedMatches = 50;    // Keep the log readable for broad queries
+    for (int i = 0; i < rows.size() && i < maxLoggedMatches; ++i) {
+        int row = rows[i];
+        logCallback(QString("  %1 (PID: %2)").arg(snapshot.processName(row)).arg(snapshot.processId(row)));
+    }
+    if (rows.size() > maxLoggedMatches) {
+        logCallback(QString("  ... and %1 more").arg(rows.size() - maxLoggedMatches));
     }
+
+    if (rows.isEmpty()) {
+        logCallback("Process not found");
+        return;
+    }
+
+    int row = rows.first();
+    processInfo.setProcessId(snapshot.processId(row));
+    processInfo.setProcessName(snapshot.processName(row).toString());
+    retrieveWindowInfo(snapshot.windowHandle(row));
+}
+
+// Execute a window command on every process matching a filter
+bool ProcessManager::ExecuteWindowCommandOnFilter(const ProcessFilter &filter, WindowCommand command) {
+    TRACE_SCOPE("ProcessManager::ExecuteWindowCommandOnFilter");
+    if (!filter.isValid()) {
+        logCallback(QString("Invalid filter: %1").arg(filter.errorString()));
+        return false;
+    }
+
+    // The snapshot holds the window of every match; no window enumeration per match
+    int executed = 0;
+    int failed = 0;
+    for (const FilterMatch &match : findProcessesByFilter(filter)) {
+        bool done;
+        if (command == Kill) {
+            done = ExecuteWindowCommand(Kill, match.processId);
+        } else if (match.hWnd != NULL) {
+            done = ExecuteWindowCommand(match.hWnd, command);
+        } else {
+            continue;   // Background processes have no window to act on
+        }
+        if (done) {
+            ++executed;
+        } else {
+            ++failed;
+        }
+    }
+
+    if (failed > 0) {
+        logCallback(QString("Command executed on %1 processes, failed on %2").arg(executed).arg(failed));
+    } else {
+        logCallback(QString("Command executed on %1 processes").arg(executed));
+    }
+    return failed == 0;
+}
+
+// Return all processes matching a filter with the window of each from the same snapshot
+QVector<ProcessManager::FilterMatch> ProcessManager::findProcessesByFilter(const ProcessFilter &filter) {
+    TRACE_SCOPE("ProcessManager::findProcessesByFilter");
+    QVector<FilterMatch> matches;
+    if (!filter.isValid()) {
+        logCallback(QString("Invalid filter: %1").arg(filter.errorString()));
+        return matches;
+    }
+
+    captureSnapshot(snapshot);
+    QVector<int> rows;
+    {
+        TRACE_SCOPE("ProcessFilter::select");
+        rows = filter.select(snapshot);
+    }
+    DWORD targetOwner = targetWindow != NULL ? backend->windowProcessId(targetWindow) : 0;
+    matches.reserve(rows.size());
+    for (int row : rows) {
+        DWORD processId = snapshot.processId(row);
+        HWND hWnd = targetOwner != 0 && processId == targetOwner ? targetWindow : snapshot.windowHandle(row);
+        matches.append({ processId, hWnd });
+    }
+    return matches;
+}
+
+// Wait for a visible window of a process by name; the names of the running processes are read once up front,
+// so only processes started during the wait need another lookup
+bool ProcessManager::waitForProcessWindow(const QString &processName, int timeoutMs, const std::atomic<bool> *cancelled) {
+    TRACE_SCOPE("ProcessManager::waitForProcessWindow");
+    QString normalizedName = normalizeProcessName(processName);
+    QHash<DWORD, QString> names;    // Name of every process seen, "" = different process
+    auto recordProcess = [&](const WindowBackend::ProcessEntry &entry) {
+        QString name = entry.name.toString();
+        names.insert(entry.processId, normalizeProcessName(name) == normalizedName ? name : QString());
+    };
+    backend->enumerateProcesses([&](const WindowBackend::ProcessEntry &entry) {
+        recordProcess(entry);
+        return true;
+    });
+
+    HWND hWnd = backend->waitForWindow([&](HWND candidate) {
+        DWORD processId = backend->windowProcessId(candidate);
+        if (processId == 0 || !backend->isWindowVisible(candidate)) {
+            return false;
+        }
+        if (!names.contains(processId)) {
+            backend->enumerateProcesses([&](const WindowBackend::ProcessEntry &entry) {
+                if (entry.processId != processId) {
+                    return true;
+                }
+                recordProcess(entry);
+                return false;
+            });
+        }
+        return !names.value(processId).isEmpty();
+    }, timeoutMs, cancelled);
+
+    if (hWnd == NULL) {
+        logCallback(QString("No window of %1 appeared within %2 ms").arg(processName).arg(timeoutMs));
+        return false;
+    }
+
+    DWORD processId = backend->windowProcessId(hWnd);
+    targetWindow = NULL;
+    processInfo = ProcessInfo();
+    processInfo.setProcessId(processId);
+    processInfo.setProcessName(names.value(processId));
+    logCallback(QString("Found process ID: %1").arg(processId));
+    retrieveWindowInfo(windowForProcess(processId));
+    return true;
+}
+
+// Wait for a visible top-level window by title text and target exactly that window
+bool ProcessManager::waitForWindowTitle(const QString &text, int timeoutMs, const std::atomic<bool> *cancelled) {
+    TRACE_SCOPE("ProcessManager::waitForWindowTitle");
+    const int titleCapacity = 512;
+    char16_t title[titleCapacity];
+
+    HWND hWnd = backend->waitForWindow([&](HWND candidate) {
+        if (!backend->isWindowVisible(candidate)) {
+            return false;
+        }
+        int length = backend->windowTitle(candidate, title, titleCapacity);
+        return length > 0 && QStringView(title, length).contains(text, Qt::CaseInsensitive);
+    }, timeoutMs, cancelled);
+
+    DWORD processId = hWnd != NULL ? backend->windowProcessId(hWnd) : 0;
+    if (processId == 0) {
+        logCallback(QString("No window titled \"%1\" appeared within %2 ms").arg(text).arg(timeoutMs));
+        return false;
+    }
+
+    processInfo = ProcessInfo();
+    processInfo.setProcessId(processId);
+    backend->enumerateProcesses([&](const WindowBackend::ProcessEntry &entry) {
+        if (entry.processId != processId) {
+            return true;
+        }
+        processInfo.setProcessName(entry.name.toString());
+        return false;
+    });
+    targetWindow = hWnd;
+    logCallback(QString("Found process ID: %1").arg(processId));
+    retrieveWindowInfo(hWnd);
+    return true;
+}
+
+// Set or clear the target window override
+void ProcessManager::setTargetWindow(HWND hWnd) {
+    targetWindow = hWnd;
+}
+
+// Return the target window override
+HWND ProcessManager::getTargetWindow() const {
+    return targetWindow;
+}
+
+// Return the explored window hierarchy
+WindowTree &ProcessManager::getWindowTree() {
+    return windowTree;
+}
+
+// Re-read the window information of the current process
+void ProcessManager::refreshWindowInfo() {
+    TRACE_SCOPE("ProcessManager::refreshWindowInfo");
+    if (processInfo.getProcessId() == 0) {
+        logCallback("Process ID not set");
+        return;
+    }
+    retrieveWindowInfo(windowForProcess(processInfo.getProcessId()));
+}
+
+// Set the logging callback
+void ProcessManager::setLogCallback(std::function<void(const QString &)> logCallback) {
+    this->logCallback = logCallback;
 }
 
 // Return the current process information
@@ -2,17 +2,51 @@
 #define PROCESSMANAGER_H
 
 #include <QString>
-#include <windows.h>
 #include <functional>
+#include "platform.h"
+#include "windowbackend.h"
 #include "processinfo.h"
+#include "processsnapshot.h"
+#include "processfilter.h"
+#include "windowspatialindex.h"
+#include "titlewatch.h"
+#include "windowtree.h"
+#include "windowanimator.h"
+#include "changejournal.h"
 
 /**
  * @brief The ProcessManager class manages operations on system processes, such as fetching details,
  *        modifying window attributes, and executing window commands.
+ *
+ * All operating system access goes through a WindowBackend. A ProcessManager is used by one thread
+ * at a time; concurrent callers each own one and may share the backend.
  */
 class ProcessManager {
 public:
-    ProcessManager();   // Constructor
+    /**
+     * @brief Commands that can be executed on a process window.
+     */
+    enum WindowCommand {
+        Kill,       // Terminate the process
+        Maximize,   // Maximize the window
+        Minimize,   // Minimize the window
+        Focus       // Restore and focus the window
+    };
+
+    /**
+     * @brief A process matched by a filter and the window the operations act on.
+     */
+    struct FilterMatch {
+        DWORD processId;    // Matching process
+        HWND hWnd;          // Target window override or main window (NULL for processes without a window)
+    };
+
+    /**
+     * @brief Constructor.
+     * @param backend The backend used for all system calls; nullptr selects WindowBackend::systemBackend().
+     *        The backend is not owned and must outlive the manager.
+     */
+    explicit ProcessManager(WindowBackend *backend = nullptr);
     ~ProcessManager();  // Destructor
 
     #pragma region Process Details
@@ -30,6 +64,136 @@ public:
      */
     ProcessInfo getProcessInfo();
 
+    /**
+     * @brief Sets the callback used for logging by operations that are not started from getProcessDetails.
+     * @param logCallback Callback function to handle logging messages.
+     */
+    void setLogCallback(std::function<void(const QString &)> logCallback);
+
+    #pragma endregion
+
+    #pragma region Waits
+
+    /**
+     * @brief Waits until a process with the given name has a visible window and makes it the current process.
+     *        Returns at once if the window already exists; otherwise woken by window events, not by polling.
+     * @param processName The executable name, with or without ".exe".
+     * @param timeoutMs Maximum time to wait.
+     * @param cancelled Ends the wait early when it becomes true (optional).
+     * @return False on timeout or cancellation.
+     */
+    bool waitForProcessWindow(const QString &processName, int timeoutMs, const std::atomic<bool> *cancelled = nullptr);
+
+    /**
+     * @brief Waits until a visible top-level window whose title contains the text exists, then makes its process
+     *        the current process and the window the target window.
+     * @param text The title text (case-insensitive).
+     * @param timeoutMs Maximum time to wait.
+     * @param cancelled Ends the wait early when it becomes true (optional).
+     * @return False on timeout or cancellation.
+     */
+    bool waitForWindowTitle(const QString &text, int timeoutMs, const std::atomic<bool> *cancelled = nullptr);
+
+    #pragma endregion
+
+    #pragma region Snapshots and Filters
+
+    /**
+     * @brief Enumerates all processes and their main windows into a columnar snapshot.
+     * @param snapshot The snapshot to fill; existing rows are replaced.
+     */
+    void captureSnapshot(ProcessSnapshot &snapshot);
+
+    /**
+     * @brief Updates a spatial index with the visible frame and z-order of all visible, non-minimized top-level
+     *        windows. Unchanged windows keep their grid cells; closed, hidden, minimized and cloaked windows are
+     *        removed, and translucent layered windows are kept but do not occlude.
+     * @param index The index to update.
+     * @return The number of windows whose rectangle changed or that were added.
+     */
+    int captureWindowLayout(WindowSpatialIndex &index);
+
+    /**
+     * @brief Updates one window of a spatial index after it moved, was resized, shown, hidden, minimized,
+     *        restored, cloaked or closed, keeping its z-order. Hidden, minimized, cloaked and closed windows
+     *        are removed.
+     * @param index The index to update.
+     * @param hWnd The changed top-level window.
+     * @return False if the window is visible but not in the index, so its z-order is unknown and the index
+     *         has to be updated with captureWindowLayout().
+     */
+    bool updateWindowLayout(WindowSpatialIndex &index, HWND hWnd);
+
+    /**
+     * @brief Runs a title watch scan over the titles of all visible top-level windows, not only the main
+     *        window of every process. Process names are looked up in a snapshot.
+     * @param snapshot A recent snapshot; windows of processes not in it are scanned without a name.
+     * @param watch The title watch to scan with.
+     * @return The windows whose new title contains a pattern, in z-order.
+     */
+    QVector<TitleWatch::Match> scanWindowTitles(const ProcessSnapshot &snapshot, TitleWatch &watch);
+
+    /**
+     * @brief Fetches process details for the first process matching a compiled filter.
+     *        All matches are logged.
+     * @param filter The compiled filter query.
+     * @param logCallback Callback function to handle logging messages.
+     */
+    void getProcessDetailsByFilter(const ProcessFilter &filter, std::function<void(const QString &)> logCallback);
+
+    /**
+     * @brief Executes a window command on every process matching a compiled filter.
+     *        The filter is evaluated against a fresh snapshot and the window commands act on the windows
+     *        of that snapshot (see findProcessesByFilter()), skipping matching processes that have no window.
+     * @param filter The compiled filter query.
+     * @param command The command to execute.
+     * @return False if the filter is invalid or the command failed on a matching process.
+     */
+    bool ExecuteWindowCommandOnFilter(const ProcessFilter &filter, WindowCommand command);
+
+    /**
+     * @brief Returns all processes matching a compiled filter with their windows, both taken from one fresh
+     *        snapshot, so no window has to be looked up per process.
+     * @param filter The compiled filter query.
+     * @return The matching processes; empty if the filter is invalid.
+     */
+    QVector<FilterMatch> findProcessesByFilter(const ProcessFilter &filter);
+
+    #pragma endregion
+
+    #pragma region Target Window
+
+    /**
+     * @brief Makes the window operations act on a specific window (e.g. a child window) instead of the
+     *        process's main window. The override applies only while the window exists and belongs to the
+     *        targeted process; otherwise the main window is used.
+     * @param hWnd The window to target, or NULL for the main window.
+     */
+    void setTargetWindow(HWND hWnd);
+
+    /**
+     * @brief Returns the target window override (NULL if the main window is used).
+     */
+    HWND getTargetWindow() const;
+
+    /**
+     * @brief Returns the lazily explored window hierarchy used to pick child windows.
+     */
+    WindowTree &getWindowTree();
+
+    /**
+     * @brief Returns the window the operations act on: the target window override if it belongs to the
+     *        process, otherwise the main window.
+     * @param processId The process ID.
+     * @return The window handle, or NULL if the process has no window.
+     */
+    HWND windowForProcess(DWORD processId);
+
+    /**
+     * @brief Re-reads the window information of the current process from its target window.
+     */
+    void refreshWindowInfo();
+
     #pragma endregion
 
     #pragma region Window Modifications
@@ -38,28 +202,154 @@ public:
      * @brief Sets the window title for the given process.
      * @param title The new window title.
      * @param processID The ID of the process whose window title should be set.
+     * @return False if the process has no window or the title could not be changed.
      */
-    void SetProcessWindowTitle(const QString& title, DWORD processID);
+    bool SetProcessWindowTitle(const QString& title, DWORD processID);
 
     /**
      * @brief Sets the TopMost flag for the process window, determining whether it stays above other windows.
      * @param topMost True to make the window TopMost, false otherwise.
      * @param processID The ID of the process to modify.
+     * @return False if the process has no window or the flag could not be changed.
      */
-    void SetProcessWindowTopMost(bool topMost, DWORD processID);
+    bool SetProcessWindowTopMost(bool topMost, DWORD processID);
 
     /**
      * @brief Sets the size of the process window.
      * @param width The desired window width.
      * @param height The desired window height.
+     * @return False if the process has no window or the window could not be resized.
+     */
+    bool SetProcessWindowSize(int width, int height);
+
+    /**
+     * @brief Sets the size of the window of the given process.
+     * @param width The desired window width.
+     * @param height The desired window height.
+     * @param processID The ID of the process to modify.
+     * @return False if the process has no window or the window could not be resized.
      */
-    void SetProcessWindowSize(int width, int height);
+    bool SetProcessWindowSize(int width, int height, DWORD processID);
 
     /**
      * @brief Sets the transparency (opacity) of the process window.
      * @param value The transparency level (0 = fully transparent, 255 = fully opaque).
+     * @return False if the process has no window or the opacity could not be changed.
      */
-    void SetProcessWindowTransparency(int value);
+    bool SetProcessWindowTransparency(int value);
+
+    /**
+     * @brief Sets the transparency (opacity) of the window of the given process.
+     * @param value The transparency level (0 = fully transparent, 255 = fully opaque).
+     * @param processID The ID of the process to modify.
+     * @return False if the process has no window or the opacity could not be changed.
+     */
+    bool SetProcessWindowTransparency(int value, DWORD processID);
+
+    /**
+     * @brief Sets the title of a window; inside a transaction the change is staged.
+     * @return False if the window is NULL or the title could not be changed.
+     */
+    bool SetWindowTitle(HWND hWnd, const QString &title);
+
+    /**
+     * @brief Sets or clears the TopMost flag of a window; inside a transaction the change is staged.
+     * @return False if the window is NULL or the flag could not be changed.
+     */
+    bool SetWindowTopMost(HWND hWnd, bool topMost);
+
+    /**
+     * @brief Resizes a window, keeping its position; inside a transaction the change is staged.
+     * @return False if the window is NULL or could not be resized.
+     */
+    bool SetWindowSize(HWND hWnd, int width, int height);
+
+    /**
+     * @brief Sets the opacity of a window; inside a transaction the change is staged.
+     * @return False if the window is NULL or the opacity could not be changed.
+     */
+    bool SetWindowTransparency(HWND hWnd, int value);
+
+    #pragma endregion
+
+    #pragma region Transactions
+
+    /**
+     * @brief Starts a transaction: until commitTransaction() or rollbackTransaction(), the Set operations
+     *        are staged in the journal instead of being applied.
+     * @param label Describes the change in logs and undo menus.
+     * @return False if a transaction is already open.
+     */
+    bool beginTransaction(const QString &label);
+
+    /**
+     * @brief Applies the staged changes as one batch and adds them to the undo history.
+     * @return The number of windows changed.
+     */
+    int commitTransaction();
+
+    /**
+     * @brief Discards the staged changes.
+     */
+    void rollbackTransaction();
+
+    /**
+     * @brief Reverts the most recent transaction.
+     * @return The number of windows restored, or -1 if there is nothing to undo.
+     */
+    int undo();
+
+    /**
+     * @brief Applies the most recently undone transaction again.
+     * @return The number of windows changed, or -1 if there is nothing to redo.
+     */
+    int redo();
+
+    /**
+     * @brief Returns the undo history.
+     */
+    const ChangeJournal &getJournal() const;
+
+    #pragma endregion
+
+    #pragma region Animated Window Modifications
+
+    /**
+     * @brief Sets the animator used by the Animate operations.
+     * @param animator The animator (not owned); nullptr applies the values immediately.
+     */
+    void setAnimator(WindowAnimator *animator);
+
+    /**
+     * @brief Starts or stops tracking the layout of the top-level windows. While tracking, AnimateProcessWindowTransparency()
+     *        sets the opacity of a window covered by opaque windows at once instead of animating a fade nobody sees.
+     *        The layout is kept up to date from the backend's window change events (see WindowBackend::watchWindowLayout());
+     *        z-order changes and new windows only mark it stale, and it is read again on the next Animate operation.
+     *        Backends without change events read it on every Animate operation.
+     * @param enabled True to track; must be called on a thread that runs a message loop.
+     */
+    void trackWindowLayout(bool enabled);
+
+    /**
+     * @brief Returns the tracked window layout (empty until the first Animate operation after trackWindowLayout()).
+     */
+    const WindowSpatialIndex &getWindowLayout() const;
+
+    /**
+     * @brief Fades the window of the given process to an opacity.
+     * @param value The target transparency level (0 = fully transparent, 255 = fully opaque).
+     * @param durationMs The duration of the transition.
+     * @param processID The ID of the process to modify.
+     */
+    void AnimateProcessWindowTransparency(int value, int durationMs, DWORD processID);
+
+    /**
+     * @brief Moves and resizes the window of the given process to a rectangle.
+     * @param rect The target rectangle in screen coordinates.
+     * @param durationMs The duration of the transition.
+     * @param processID The ID of the process to modify.
+     */
+    void AnimateProcessWindowGeometry(const RECT &rect, int durationMs, DWORD processID);
 
     #pragma endregion
 
@@ -85,10 +375,36 @@ public:
      */
     void FocusProcessWindow();
 
+    /**
+     * @brief Executes a window command on the given process.
+     * @param command The command to execute.
+     * @param processID The ID of the target process.
+     * @return False if the process or its window was not found or the command failed.
+     */
+    bool ExecuteWindowCommand(WindowCommand command, DWORD processID);
+
+    /**
+     * @brief Executes a window command on a window; Kill terminates the owning process.
+     * @param hWnd The target window.
+     * @param command The command to execute.
+     * @return False if the window is NULL or the command failed.
+     */
+    bool ExecuteWindowCommand(HWND hWnd, WindowCommand command);
+
     #pragma endregion
 
 private:
-    ProcessInfo processInfo;  // Stores current process information
+    WindowBackend *backend;          // System calls (not owned)
+    ProcessInfo processInfo;         // Stores current process information
+    ProcessSnapshot snapshot;        // Last captured process table, reused between captures
+    HWND targetWindow;               // Window override of the operations (NULL = main window)
+    WindowTree windowTree;           // Explored window hierarchy
+    WindowAnimator *animator;        // Runs the Animate operations (not owned, nullptr = apply immediately)
+    ChangeJournal journal;           // Transactions and undo history of the Set operations
+    WindowSpatialIndex windowLayout; // Tracked top-level window layout, for occlusion checks
+    bool layoutTracked;              // trackWindowLayout() is enabled
+    bool layoutWatched;              // The backend reports window changes into windowLayout
+    bool layoutStale;                // windowLayout must be read again before it is used
 
     #pragma region Process and Window Helpers
 
@@ -106,6 +422,18 @@ private:
      */
     HWND findWindowByProcessId(DWORD processId);
 
+    /**
+     * @brief Logs the windows the last undo or redo skipped because their process could not be identified.
+     */
+    void logUnverifiedWindows();
+
+    /**
+     * @brief Returns true if the tracked layout shows the window covered by opaque windows, reading the layout
+     *        again first if it is stale. False while the layout is not tracked.
+     * @param hWnd The window to check.
+     */
+    bool isWindowOccluded(HWND hWnd);
+
     /**
      * @brief Retrieves window information and updates the processInfo object.
      * @param hWnd Handle to the process window.
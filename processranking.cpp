@@ -0,0 +1,178 @@
+#include "processranking.h"
+#include <QThread>
+#include <algorithm>
+
+namespace {
+
+// Changes below these thresholds keep the current rank to avoid flicker
+const qint64 cpuUsageThreshold = 25;            // 0.25 %
+const qint64 memoryUsageThreshold = 256 * 1024; // 256 KB
+
+bool isSignificantChange(ProcessRanking::Metric metric, qint64 oldValue, qint64 newValue) {
+    qint64 delta = newValue > oldValue ? newValue - oldValue : oldValue - newValue;
+    if (metric == ProcessRanking::CpuUsage) {
+        // Always settle back to exactly zero so idle processes sort by ID
+        return delta >= cpuUsageThreshold || (newValue == 0 && oldValue != 0);
+    }
+    return delta >= std::max(memoryUsageThreshold, oldValue / 100);
+}
+
+} // namespace
+
+#pragma region Constructor and Destructor
+
+/**
+ * @brief Constructs an empty ranking.
+ */
+ProcessRanking::ProcessRanking()
+    : lastCaptureTime(0), generation(0), churn(0), processorCount(std::max(1, QThread::idealThreadCount())) {}
+
+/**
+ * @brief Destructor for ProcessRanking.
+ */
+ProcessRanking::~ProcessRanking() {}
+
+#pragma endregion
+
+#pragma region Updates
+
+/**
+ * @brief Updates the rankings from a new snapshot.
+ *        New processes are inserted, changed ones are re-ranked and exited ones removed.
+ */
+void ProcessRanking::update(const ProcessSnapshot &snapshot) {
+    ++generation;
+    churn = 0;
+
+    qint64 elapsed = lastCaptureTime != 0 ? snapshot.captureTime() - lastCaptureTime : 0;
+    lastCaptureTime = snapshot.captureTime();
+
+    const qint64 *cpuTimes = snapshot.columnData(ProcessSnapshot::CpuTime);
+    const qint64 *workingSets = snapshot.columnData(ProcessSnapshot::WorkingSet);
+
+    const int count = snapshot.size();
+    for (int row = 0; row < count; ++row) {
+        DWORD processId = snapshot.processId(row);
+        qint64 creationTime = snapshot.creationTime(row);
+        auto it = states.find(processId);
+
+        // A reused process ID shows up with another creation time or a CPU time that went backwards;
+        // the name is only compared when the creation time could not be read
+        if (it != states.end()
+            && (it.value().cpuTime > cpuTimes[row] || it.value().creationTime != creationTime
+                || (creationTime == 0 && it.value().processName != snapshot.processName(row)))) {
+            for (int metric = 0; metric < MetricCount; ++metric) {
+                rankings[metric].erase(RankKey(-it.value().ranked[metric], processId));
+            }
+            states.erase(it);
+            it = states.end();
+        }
+
+        if (it == states.end()) {
+            ProcessState state;
+            state.processName = snapshot.processName(row).toString();
+            state.creationTime = creationTime;
+            state.cpuTime = cpuTimes[row];
+            state.ranked[CpuUsage] = 0;
+            state.ranked[MemoryUsage] = workingSets[row];
+            state.generation = generation;
+            states.insert(processId, state);
+
+            rankings[CpuUsage].insert(RankKey(0, processId));
+            rankings[MemoryUsage].insert(RankKey(-workingSets[row], processId));
+            ++churn;
+            continue;
+        }
+
+        ProcessState &state = it.value();
+        state.generation = generation;
+
+        qint64 cpuUsage = 0;
+        qint64 cpuDelta = cpuTimes[row] - state.cpuTime;
+        if (elapsed > 0 && cpuDelta > 0) {
+            cpuUsage = cpuDelta * 10000 / (elapsed * processorCount);
+        }
+        state.cpuTime = cpuTimes[row];
+
+        if (isSignificantChange(CpuUsage, state.ranked[CpuUsage], cpuUsage)) {
+            rerank(CpuUsage, processId, state.ranked[CpuUsage], cpuUsage);
+            state.ranked[CpuUsage] = cpuUsage;
+        }
+        if (isSignificantChange(MemoryUsage, state.ranked[MemoryUsage], workingSets[row])) {
+            rerank(MemoryUsage, processId, state.ranked[MemoryUsage], workingSets[row]);
+            state.ranked[MemoryUsage] = workingSets[row];
+        }
+    }
+
+    // Drop processes that exited since the previous snapshot
+    for (auto it = states.begin(); it != states.end();) {
+        if (it.value().generation != generation) {
+            for (int metric = 0; metric < MetricCount; ++metric) {
+                rankings[metric].erase(RankKey(-it.value().ranked[metric], it.key()));
+            }
+            it = states.erase(it);
+            ++churn;
+        } else {
+            ++it;
+        }
+    }
+}
+
+/**
+ * @brief Removes all processes from the rankings.
+ */
+void ProcessRanking::clear() {
+    states.clear();
+    for (std::set<RankKey> &ranking : rankings) {
+        ranking.clear();
+    }
+    lastCaptureTime = 0;
+    churn = 0;
+}
+
+/**
+ * @brief Moves a process to its new position in one ranking.
+ */
+void ProcessRanking::rerank(Metric metric, DWORD processId, qint64 oldValue, qint64 newValue) {
+    rankings[metric].erase(RankKey(-oldValue, processId));
+    rankings[metric].insert(RankKey(-newValue, processId));
+    ++churn;
+}
+
+#pragma endregion
+
+#pragma region Queries
+
+/**
+ * @brief Returns the first entries of a ranking without sorting anything.
+ */
+QVector<ProcessRanking::Entry> ProcessRanking::top(Metric metric, int count) const {
+    QVector<Entry> entries;
+    entries.reserve(std::min<qsizetype>(count, states.size()));
+
+    for (const RankKey &key : rankings[metric]) {
+        if (entries.size() >= count) {
+            break;
+        }
+        const ProcessState &state = *states.constFind(key.second);
+        entries.append({ key.second, state.processName, state.ranked[CpuUsage], state.ranked[MemoryUsage] });
+    }
+    return entries;
+}
+
+/**
+ * @brief Returns the ranked CPU usage of a process.
+ */
+qint64 ProcessRanking::cpuUsage(DWORD processId) const {
+    auto it = states.constFind(processId);
+    return it != states.constEnd() ? it.value().ranked[CpuUsage] : 0;
+}
+
+/**
+ * @brief Returns the number of entries moved during the last update.
+ */
+int ProcessRanking::lastChurn() const {
+    return churn;
+}
+
+#pragma endregion
@@ -0,0 +1,124 @@
+#ifndef PROCESSRANKING_H
+#define PROCESSRANKING_H
+
+#include <QString>
+#include <QVector>
+#include <QHash>
+#include <set>
+#include <utility>
+#include "platform.h" // For the DWORD type
+#include "processsnapshot.h"
+
+/**
+ * @class ProcessRanking
+ * @brief Keeps processes ranked by CPU usage and by memory usage across successive snapshots.
+ *
+ * Each update walks every row of the new snapshot once (one hash lookup and a few integer comparisons
+ * per process, the same order of work as capturing the snapshot) and only re-ranks entries whose value
+ * changed noticeably; the ordered-set work, the expensive part, follows process churn rather than the
+ * total process count. Ties are ordered by process ID and small fluctuations do not move an entry,
+ * which keeps the displayed order stable between refreshes.
+ */
+class ProcessRanking {
+public:
+    /**
+     * @brief The resource a ranking is ordered by.
+     */
+    enum Metric {
+        CpuUsage,       // CPU usage in hundredths of a percent of all cores
+        MemoryUsage,    // Working set in bytes
+        MetricCount
+    };
+
+    /**
+     * @brief One ranked process.
+     */
+    struct Entry {
+        DWORD processId;        // ID of the process
+        QString processName;    // Name of the process
+        qint64 cpuUsage;        // CPU usage in hundredths of a percent
+        qint64 memoryUsage;     // Working set in bytes
+    };
+
+    #pragma region Constructors and Destructor
+
+    /**
+     * @brief Creates an empty ranking.
+     */
+    ProcessRanking();
+
+    /**
+     * @brief Destructor for cleaning up the ranking.
+     */
+    ~ProcessRanking();
+
+    #pragma endregion
+
+    #pragma region Updates
+
+    /**
+     * @brief Feeds a new snapshot. CPU usage is derived from the CPU time delta since the previous snapshot.
+     * @param snapshot The freshly captured snapshot.
+     */
+    void update(const ProcessSnapshot &snapshot);
+
+    /**
+     * @brief Forgets all processes.
+     */
+    void clear();
+
+    #pragma endregion
+
+    #pragma region Queries
+
+    /**
+     * @brief Returns the highest ranked processes.
+     * @param metric The metric to rank by.
+     * @param count The maximum number of entries to return.
+     * @return Up to count entries, highest first.
+     */
+    QVector<Entry> top(Metric metric, int count) const;
+
+    /**
+     * @brief Returns the last known CPU usage of a process.
+     * @param processId The process ID.
+     * @return CPU usage in hundredths of a percent, or 0 if unknown.
+     */
+    qint64 cpuUsage(DWORD processId) const;
+
+    /**
+     * @brief Returns how many ranking entries moved during the last update.
+     */
+    int lastChurn() const;
+
+    #pragma endregion
+
+private:
+    /**
+     * @brief Last known state of one process.
+     */
+    struct ProcessState {
+        QString processName;
+        qint64 creationTime;            // Creation time of the process, 0 if unknown
+        qint64 cpuTime;                 // Last CPU time in milliseconds
+        qint64 ranked[MetricCount];     // Values the process is currently ranked with
+        quint32 generation;             // Update in which the process was last seen
+    };
+
+    using RankKey = std::pair<qint64, DWORD>;   // (-value, processId): highest value first, ties by ID
+
+    void rerank(Metric metric, DWORD processId, qint64 oldValue, qint64 newValue);
+
+    #pragma region Member Variables
+
+    QHash<DWORD, ProcessState> states;      // Process ID -> last known state
+    std::set<RankKey> rankings[MetricCount];// Ordered rankings, one per metric
+    qint64 lastCaptureTime;                 // Capture time of the previous snapshot
+    quint32 generation;                     // Incremented on every update
+    int churn;                              // Entries moved during the last update
+    int processorCount;                     // Number of logical processors
+
+    #pragma endregion
+};
+
+#endif // PROCESSRANKING_H
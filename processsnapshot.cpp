@@ -0,0 +1,148 @@
+#include "processsnapshot.h"
+
+#pragma region Constructor and Destructor
+
+/**
+ * @brief Constructs an empty snapshot.
+ */
+ProcessSnapshot::ProcessSnapshot() : capturedAt(0) {}
+
+/**
+ * @brief Destructor for ProcessSnapshot.
+ */
+ProcessSnapshot::~ProcessSnapshot() {}
+
+#pragma endregion
+
+#pragma region Rows
+
+/**
+ * @brief Returns the number of process rows.
+ */
+int ProcessSnapshot::size() const {
+    return processNameIds.size();
+}
+
+/**
+ * @brief Returns true if the snapshot has no rows.
+ */
+bool ProcessSnapshot::isEmpty() const {
+    return processNameIds.isEmpty();
+}
+
+/**
+ * @brief Clears all rows. QVector::clear() keeps the capacity in Qt 6, so refreshing
+ *        the same snapshot object does not reallocate the columns every time.
+ */
+void ProcessSnapshot::clear() {
+    for (QVector<qint64> &column : columns) {
+        column.clear();
+    }
+    processNameIds.clear();
+    windowTitleIds.clear();
+    windowClassIds.clear();
+    windowHandles.clear();
+    creationTimes.clear();
+    rowsByProcessId.clear();
+    strings.reset();
+    capturedAt = 0;
+}
+
+/**
+ * @brief Reserves capacity in every column.
+ * @param rows The expected number of rows.
+ */
+void ProcessSnapshot::reserve(int rows) {
+    for (QVector<qint64> &column : columns) {
+        column.reserve(rows);
+    }
+    processNameIds.reserve(rows);
+    windowTitleIds.reserve(rows);
+    windowClassIds.reserve(rows);
+    windowHandles.reserve(rows);
+    creationTimes.reserve(rows);
+    rowsByProcessId.reserve(rows);
+}
+
+/**
+ * @brief Appends a process row with empty window columns.
+ * @return The index of the new row.
+ */
+int ProcessSnapshot::appendProcess(DWORD processId, DWORD parentProcessId, QStringView processName, int threadCount) {
+    int row = processNameIds.size();
+
+    for (int column = 0; column < ColumnCount; ++column) {
+        columns[column].append(0);
+    }
+    columns[ProcessId][row] = processId;
+    columns[ParentProcessId][row] = parentProcessId;
+    columns[ThreadCount][row] = threadCount;
+    columns[Opacity][row] = 255;    // Windows without WS_EX_LAYERED are fully opaque
+
+    processNameIds.append(strings.intern(processName));
+    windowTitleIds.append(0);
+    windowClassIds.append(0);
+    windowHandles.append(NULL);
+    creationTimes.append(0);
+    rowsByProcessId.insert(processId, row);
+    return row;
+}
+
+/**
+ * @brief Finds the row of a process.
+ * @return The row index, or -1 if not found.
+ */
+int ProcessSnapshot::findRow(DWORD processId) const {
+    return rowsByProcessId.value(processId, -1);
+}
+
+/**
+ * @brief Returns the capture time in milliseconds.
+ */
+qint64 ProcessSnapshot::captureTime() const {
+    return capturedAt;
+}
+
+/**
+ * @brief Sets the capture time in milliseconds.
+ */
+void ProcessSnapshot::setCaptureTime(qint64 milliseconds) {
+    capturedAt = milliseconds;
+}
+
+#pragma endregion
+
+#pragma region Row Updates
+
+/**
+ * @brief Stores the memory and CPU usage of a row.
+ */
+void ProcessSnapshot::setResourceUsage(int row, qint64 workingSetBytes, qint64 cpuTimeMs) {
+    columns[WorkingSet][row] = workingSetBytes;
+    columns[CpuTime][row] = cpuTimeMs;
+}
+
+/**
+ * @brief Stores the creation time of a row.
+ */
+void ProcessSnapshot::setCreationTime(int row, qint64 creationTime) {
+    creationTimes[row] = creationTime;
+}
+
+/**
+ * @brief Stores the main window attributes of a row.
+ */
+void ProcessSnapshot::setWindowInfo(int row, HWND hWnd, QStringView title, QStringView className, const RECT &rect, bool topMost, int opacity) {
+    windowHandles[row] = hWnd;
+    windowTitleIds[row] = strings.intern(title);
+    windowClassIds[row] = strings.intern(className);
+    columns[Left][row] = rect.left;
+    columns[Top][row] = rect.top;
+    columns[Width][row] = rect.right - rect.left;
+    columns[Height][row] = rect.bottom - rect.top;
+    columns[Opacity][row] = opacity;
+    columns[TopMost][row] = topMost ? 1 : 0;
+    columns[Visible][row] = 1;
+}
+
+#pragma endregion
@@ -0,0 +1,224 @@
+#ifndef PROCESSSNAPSHOT_H
+#define PROCESSSNAPSHOT_H
+
+#include <QString>
+#include <QStringView>
+#include <QVector>
+#include <QHash>
+#include "platform.h" // For the DWORD and HWND types
+#include "stringpool.h"
+
+/**
+ * @class ProcessSnapshot
+ * @brief Columnar table holding one row per running process together with its main window.
+ *
+ * Every attribute lives in its own contiguous column so that filters and rankings can walk a
+ * single column in a tight loop instead of going through one ProcessInfo object per process.
+ * Names, titles and window classes are interned in a StringPool owned by the snapshot; the string
+ * columns hold pool IDs and the pool is reset whenever the snapshot is cleared for a new capture.
+ */
+class ProcessSnapshot {
+public:
+    /**
+     * @brief Numeric columns of the snapshot. Flags (TopMost, Visible) are stored as 0/1.
+     */
+    enum Column {
+        ProcessId,          // ID of the process
+        ParentProcessId,    // ID of the parent process
+        ThreadCount,        // Number of threads
+        WorkingSet,         // Resident memory in bytes
+        CpuTime,            // Kernel + user time in milliseconds
+        Left,               // Window position (x) in pixels
+        Top,                // Window position (y) in pixels
+        Width,              // Window width in pixels
+        Height,             // Window height in pixels
+        Opacity,            // Window opacity (0-255)
+        TopMost,            // 1 if the window is TopMost
+        Visible,            // 1 if the process owns a visible top-level window
+        ColumnCount
+    };
+
+    #pragma region Constructors and Destructor
+
+    /**
+     * @brief Creates an empty snapshot.
+     */
+    ProcessSnapshot();
+
+    /**
+     * @brief Destructor for cleaning up the snapshot.
+     */
+    ~ProcessSnapshot();
+
+    #pragma endregion
+
+    #pragma region Rows
+
+    /**
+     * @brief Returns the number of process rows.
+     */
+    int size() const;
+
+    /**
+     * @brief Returns true if the snapshot contains no rows.
+     */
+    bool isEmpty() const;
+
+    /**
+     * @brief Removes all rows while keeping the allocated column capacity.
+     *        Starts a new string pool generation, invalidating previously returned string views.
+     */
+    void clear();
+
+    /**
+     * @brief Reserves capacity in every column.
+     * @param rows The expected number of rows.
+     */
+    void reserve(int rows);
+
+    /**
+     * @brief Appends a process row. Window columns are initialized to "no window".
+     * @param processId The process ID.
+     * @param parentProcessId The parent process ID.
+     * @param processName The executable name.
+     * @param threadCount The number of threads of the process.
+     * @return The index of the new row.
+     */
+    int appendProcess(DWORD processId, DWORD parentProcessId, QStringView processName, int threadCount);
+
+    /**
+     * @brief Finds the row of a process.
+     * @param processId The process ID.
+     * @return The row index, or -1 if the process is not part of the snapshot.
+     */
+    int findRow(DWORD processId) const;
+
+    /**
+     * @brief Returns when the snapshot was captured.
+     * @return Milliseconds on a monotonic clock (GetTickCount64), or 0 if never captured.
+     */
+    qint64 captureTime() const;
+
+    /**
+     * @brief Sets when the snapshot was captured.
+     * @param milliseconds Milliseconds on a monotonic clock.
+     */
+    void setCaptureTime(qint64 milliseconds);
+
+    #pragma endregion
+
+    #pragma region Row Updates
+
+    /**
+     * @brief Stores the memory and CPU usage of a process row.
+     * @param row The row index.
+     * @param workingSetBytes Resident memory in bytes.
+     * @param cpuTimeMs Kernel + user time in milliseconds.
+     */
+    void setResourceUsage(int row, qint64 workingSetBytes, qint64 cpuTimeMs);
+
+    /**
+     * @brief Stores the creation time of a process row, which tells processes that reused an ID apart.
+     * @param row The row index.
+     * @param creationTime WindowBackend::processCreationTime() of the process, or 0 if unknown.
+     */
+    void setCreationTime(int row, qint64 creationTime);
+
+    /**
+     * @brief Stores the main window attributes of a process row.
+     * @param row The row index.
+     * @param hWnd Handle to the main window.
+     * @param title The window title.
+     * @param className The window class name.
+     * @param rect The window rectangle in screen coordinates.
+     * @param topMost True if the window is TopMost.
+     * @param opacity The window opacity (0-255).
+     */
+    void setWindowInfo(int row, HWND hWnd, QStringView title, QStringView className, const RECT &rect, bool topMost, int opacity);
+
+    #pragma endregion
+
+    #pragma region Column Access
+
+    /**
+     * @brief Returns a numeric value.
+     * @param column The column to read.
+     * @param row The row index.
+     */
+    qint64 value(Column column, int row) const { return columns[column][row]; }
+
+    /**
+     * @brief Returns the raw data of a numeric column for tight loops.
+     * @param column The column to read.
+     */
+    const qint64 *columnData(Column column) const { return columns[column].constData(); }
+
+    /**
+     * @brief Returns the process ID of a row.
+     */
+    DWORD processId(int row) const { return static_cast<DWORD>(columns[ProcessId][row]); }
+
+    /**
+     * @brief Returns the executable name of a row.
+     */
+    QStringView processName(int row) const { return strings.view(processNameIds[row]); }
+
+    /**
+     * @brief Returns the main window title of a row (empty if there is no window).
+     */
+    QStringView windowTitle(int row) const { return strings.view(windowTitleIds[row]); }
+
+    /**
+     * @brief Returns the main window class name of a row (empty if there is no window).
+     */
+    QStringView windowClass(int row) const { return strings.view(windowClassIds[row]); }
+
+    /**
+     * @brief Returns the interned ID of the executable name of a row.
+     */
+    quint32 processNameId(int row) const { return processNameIds[row]; }
+
+    /**
+     * @brief Returns the interned ID of the main window title of a row.
+     */
+    quint32 windowTitleId(int row) const { return windowTitleIds[row]; }
+
+    /**
+     * @brief Returns the interned ID of the main window class name of a row.
+     */
+    quint32 windowClassId(int row) const { return windowClassIds[row]; }
+
+    /**
+     * @brief Returns the pool holding the strings of this snapshot.
+     */
+    const StringPool &stringPool() const { return strings; }
+
+    /**
+     * @brief Returns the main window handle of a row (NULL if there is no window).
+     */
+    HWND windowHandle(int row) const { return windowHandles[row]; }
+
+    /**
+     * @brief Returns the creation time of the process of a row (0 if unknown).
+     */
+    qint64 creationTime(int row) const { return creationTimes[row]; }
+
+    #pragma endregion
+
+private:
+    #pragma region Member Variables
+
+    QVector<qint64> columns[ColumnCount];   // Numeric columns, indexed by Column
+    StringPool strings;                     // Interned names, titles and classes
+    QVector<quint32> processNameIds;        // Executable names (pool IDs)
+    QVector<quint32> windowTitleIds;        // Main window titles (pool IDs)
+    QVector<quint32> windowClassIds;        // Main window class names (pool IDs)
+    QVector<HWND> windowHandles;            // Main window handles
+    QVector<qint64> creationTimes;          // Process creation times, 0 if unknown
+    QHash<DWORD, int> rowsByProcessId;      // Process ID -> row index
+    qint64 capturedAt;                      // Capture time in milliseconds
+
+    #pragma endregion
+};
+
+#endif // PROCESSSNAPSHOT_H
@@ -0,0 +1,388 @@
+#include "processwatchdog.h"
+#include <QFile>
+#include <QTextStream>
+#include <QRegularExpression>
+#include <algorithm>
+
+namespace {
+
+// Parses "90", "90%" (CPU) or "500MB", "2GB" (memory)
+bool parseThreshold(ProcessWatchdog::Metric metric, const QString &text, qint64 &value) {
+    QString number = text.toUpper();
+    double multiplier = 1;
+
+    if (metric == ProcessWatchdog::CpuUsage) {
+        if (number.endsWith('%')) {
+            number.chop(1);
+        }
+        multiplier = 100;   // Percent -> hundredths of a percent
+    } else if (number.endsWith("KB")) {
+        number.chop(2);
+        multiplier = 1024.0;
+    } else if (number.endsWith("MB")) {
+        number.chop(2);
+        multiplier = 1024.0 * 1024.0;
+    } else if (number.endsWith("GB")) {
+        number.chop(2);
+        multiplier = 1024.0 * 1024.0 * 1024.0;
+    } else if (number.endsWith('B')) {
+        number.chop(1);
+    }
+
+    bool ok;
+    double parsed = number.toDouble(&ok);
+    value = static_cast<qint64>(parsed * multiplier);
+    return ok && parsed >= 0;
+}
+
+// Parses "500ms", "30s", "5m", "1h" or a plain number of seconds
+bool parseDuration(const QString &text, qint64 &milliseconds) {
+    QString number = text.toLower();
+    qint64 multiplier = 1000;
+
+    if (number.endsWith("ms")) {
+        number.chop(2);
+        multiplier = 1;
+    } else if (number.endsWith('s')) {
+        number.chop(1);
+    } else if (number.endsWith('m')) {
+        number.chop(1);
+        multiplier = 60 * 1000;
+    } else if (number.endsWith('h')) {
+        number.chop(1);
+        multiplier = 60 * 60 * 1000;
+    }
+
+    bool ok;
+    double parsed = number.toDouble(&ok);
+    milliseconds = static_cast<qint64>(parsed * multiplier);
+    return ok && parsed >= 0;
+}
+
+} // namespace
+
+#pragma region Constructor and Destructor
+
+/**
+ * @brief Constructs a watchdog without rules.
+ */
+ProcessWatchdog::ProcessWatchdog() {}
+
+/**
+ * @brief Destructor for ProcessWatchdog.
+ */
+ProcessWatchdog::~ProcessWatchdog() {}
+
+#pragma endregion
+
+#pragma region Rules
+
+/**
+ * @brief Adds a rule and keeps the per-metric threshold order.
+ */
+void ProcessWatchdog::addRule(const Rule &rule) {
+    int index = rules.size();
+    rules.append(rule);
+
+    QVector<int> &order = rulesByThreshold[rule.metric];
+    auto position = std::upper_bound(order.begin(), order.end(), rule.triggerAbove, [this](qint64 threshold, int other) {
+        return threshold < rules[other].triggerAbove;
+    });
+    order.insert(position - order.begin(), index);
+}
+
+/**
+ * @brief Parses one rule line, see the class documentation for the format.
+ * @return True on success.
+ */
+bool ProcessWatchdog::parseRule(const QString &text, Rule &rule, QString &error) {
+    static const QRegularExpression whereKeyword("\\bwhere\\b", QRegularExpression::CaseInsensitiveOption);
+
+    rule = Rule();
+    rule.text = text.trimmed();
+    rule.sustainMs = 0;
+    rule.cooldownMs = 60 * 1000;
+    rule.action = LogOnly;
+    rule.opacity = 255;
+
+    // Everything after "where" is a filter query
+    QString condition = rule.text;
+    QRegularExpressionMatch where = whereKeyword.match(condition);
+    if (where.hasMatch()) {
+        if (!rule.scope.compile(condition.mid(where.capturedEnd()))) {
+            error = QString("Invalid where clause: %1").arg(rule.scope.errorString());
+            return false;
+        }
+        condition = condition.left(where.capturedStart());
+    }
+
+    QStringList tokens = condition.split(' ', Qt::SkipEmptyParts);
+    if (tokens.size() < 5 || tokens[1] != ">") {
+        error = "Expected '<metric> > <value> ... -> <action>'";
+        return false;
+    }
+
+    if (tokens[0].compare("cpu", Qt::CaseInsensitive) == 0) {
+        rule.metric = CpuUsage;
+    } else if (tokens[0].compare("rss", Qt::CaseInsensitive) == 0) {
+        rule.metric = MemoryUsage;
+    } else {
+        error = QString("Unknown metric '%1'").arg(tokens[0]);
+        return false;
+    }
+
+    if (!parseThreshold(rule.metric, tokens[2], rule.triggerAbove)) {
+        error = QString("Invalid threshold '%1'").arg(tokens[2]);
+        return false;
+    }
+    rule.clearBelow = rule.triggerAbove / 10 * 9;   // Default hysteresis of 10 %
+
+    int i = 3;
+    for (; i + 1 < tokens.size() && tokens[i] != "->"; i += 2) {
+        const QString &keyword = tokens[i];
+        const QString &argument = tokens[i + 1];
+        bool ok;
+
+        if (keyword.compare("for", Qt::CaseInsensitive) == 0) {
+            ok = parseDuration(argument, rule.sustainMs);
+        } else if (keyword.compare("cooldown", Qt::CaseInsensitive) == 0) {
+            ok = parseDuration(argument, rule.cooldownMs);
+        } else if (keyword.compare("clear", Qt::CaseInsensitive) == 0) {
+            ok = parseThreshold(rule.metric, argument, rule.clearBelow) && rule.clearBelow <= rule.triggerAbove;
+        } else {
+            error = QString("Unknown keyword '%1'").arg(keyword);
+            return false;
+        }
+
+        if (!ok) {
+            error = QString("Invalid value '%1' for '%2'").arg(argument, keyword);
+            return false;
+        }
+    }
+
+    if (i + 1 >= tokens.size() || tokens[i] != "->") {
+        error = "Expected '-> <action>'";
+        return false;
+    }
+
+    QString action = tokens[i + 1].toLower();
+    if (action == "log") {
+        rule.action = LogOnly;
+    } else if (action == "minimize") {
+        rule.action = Minimize;
+    } else if (action == "kill") {
+        rule.action = Kill;
+    } else if (action == "opacity" && i + 2 < tokens.size()) {
+        bool ok;
+        rule.action = LowerOpacity;
+        rule.opacity = tokens[i + 2].toInt(&ok);
+        if (!ok || rule.opacity < 0 || rule.opacity > 255) {
+            error = QString("Invalid opacity '%1'").arg(tokens[i + 2]);
+            return false;
+        }
+    } else {
+        error = QString("Unknown action '%1'").arg(tokens[i + 1]);
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * @brief Loads a rule file, skipping (and logging) invalid lines.
+ * @return The number of rules loaded, or -1 if the file cannot be opened.
+ */
+int ProcessWatchdog::loadRules(const QString &path, std::function<void(const QString &)> logCallback) {
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        logCallback(QString("Cannot open watchdog rules: %1").arg(path));
+        return -1;
+    }
+
+    clearRules();
+
+    QTextStream stream(&file);
+    int lineNumber = 0;
+    while (!stream.atEnd()) {
+        QString line = stream.readLine();
+        ++lineNumber;
+
+        int comment = line.indexOf('#');
+        if (comment >= 0) {
+            line = line.left(comment);
+        }
+        if (line.trimmed().isEmpty()) {
+            continue;
+        }
+
+        Rule rule;
+        QString error;
+        if (parseRule(line, rule, error)) {
+            addRule(rule);
+        } else {
+            logCallback(QString("Watchdog rule %1 ignored: %2").arg(lineNumber).arg(error));
+        }
+    }
+
+    return rules.size();
+}
+
+/**
+ * @brief Removes all rules and their state.
+ */
+void ProcessWatchdog::clearRules() {
+    rules.clear();
+    for (QVector<int> &order : rulesByThreshold) {
+        order.clear();
+    }
+    states.clear();
+    lastFired.clear();
+    activeRules.clear();
+    creationTimes.clear();
+}
+
+/**
+ * @brief Returns a rule by index.
+ */
+const ProcessWatchdog::Rule &ProcessWatchdog::rule(int index) const {
+    return rules[index];
+}
+
+/**
+ * @brief Returns the number of rules.
+ */
+int ProcessWatchdog::ruleCount() const {
+    return rules.size();
+}
+
+#pragma endregion
+
+#pragma region Evaluation
+
+/**
+ * @brief Evaluates all rules.
+ *        For every process, only the rules whose trigger threshold lies below the current value and
+ *        the rules already timing that process are visited.
+ */
+QVector<ProcessWatchdog::Trigger> ProcessWatchdog::evaluate(const ProcessSnapshot &snapshot, const ProcessRanking &ranking) {
+    QVector<Trigger> triggers;
+    if (rules.isEmpty()) {
+        return triggers;
+    }
+
+    const qint64 now = snapshot.captureTime();
+    const bool watchesCpu = !rulesByThreshold[CpuUsage].isEmpty();
+    const qint64 *workingSets = snapshot.columnData(ProcessSnapshot::WorkingSet);
+
+    const int count = snapshot.size();
+
+    // Forget processes that exited or whose ID now belongs to another process
+    for (auto it = creationTimes.begin(); it != creationTimes.end();) {
+        int row = snapshot.findRow(it.key());
+        if (row < 0 || snapshot.creationTime(row) != it.value()) {
+            forgetProcess(it.key());
+            it = creationTimes.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    // Rows in scope of each rule, selected in one pass the first time the rule is exceeded in this snapshot
+    QVector<QVector<bool>> scopeRows(rules.size());
+    auto inScope = [&](int index, int row) {
+        const ProcessFilter &scope = rules[index].scope;
+        if (!scope.isValid()) {
+            return true;
+        }
+        QVector<bool> &rows = scopeRows[index];
+        if (rows.isEmpty()) {
+            rows.fill(false, count);
+            for (int selected : scope.select(snapshot)) {
+                rows[selected] = true;
+            }
+        }
+        return rows[row];
+    };
+
+    for (int row = 0; row < count; ++row) {
+        DWORD processId = snapshot.processId(row);
+        qint64 values[MetricCount];
+        values[CpuUsage] = watchesCpu ? ranking.cpuUsage(processId) : 0;
+        values[MemoryUsage] = workingSets[row];
+
+        // Start timing rules that were just exceeded
+        for (int metric = 0; metric < MetricCount; ++metric) {
+            for (int index : rulesByThreshold[metric]) {
+                const Rule &rule = rules[index];
+                if (rule.triggerAbove >= values[metric]) {
+                    break;  // Sorted by threshold, no further rule is exceeded
+                }
+
+                quint64 key = stateKey(index, processId);
+                if (states.contains(key) || !inScope(index, row)) {
+                    continue;
+                }
+                states.insert(key, { now });
+                activeRules[processId].append(index);
+                creationTimes.insert(processId, snapshot.creationTime(row));
+            }
+        }
+
+        auto active = activeRules.find(processId);
+        if (active == activeRules.end()) {
+            continue;
+        }
+
+        // Advance the rules timing this process
+        QVector<int> &indices = active.value();
+        for (int i = indices.size() - 1; i >= 0; --i) {
+            int index = indices[i];
+            const Rule &rule = rules[index];
+            qint64 value = values[rule.metric];
+            quint64 key = stateKey(index, processId);
+
+            if (value < rule.clearBelow) {
+                states.remove(key);     // Re-armed; the cooldown stays
+                indices.removeAt(i);
+                continue;
+            }
+
+            RuleState &state = states[key];
+            if (value <= rule.triggerAbove) {
+                state.aboveSince = -1;  // Inside the hysteresis band: the sustain timing restarts
+                continue;
+            }
+            if (state.aboveSince < 0) {
+                state.aboveSince = now;
+            }
+
+            auto fired = lastFired.constFind(key);
+            bool sustained = now - state.aboveSince >= rule.sustainMs;
+            bool cooledDown = fired == lastFired.constEnd() || now - fired.value() >= rule.cooldownMs;
+            if (sustained && cooledDown) {
+                lastFired.insert(key, now);
+                triggers.append({ index, processId, snapshot.processName(row).toString(), value });
+            }
+        }
+
+        if (indices.isEmpty()) {
+            activeRules.erase(active);
+        }
+    }
+
+    return triggers;
+}
+
+/**
+ * @brief Drops the timing state and the cooldowns of a process that exited or lost its ID.
+ */
+void ProcessWatchdog::forgetProcess(DWORD processId) {
+    for (int index : activeRules.take(processId)) {
+        states.remove(stateKey(index, processId));
+    }
+    for (int index = 0; index < rules.size(); ++index) {
+        lastFired.remove(stateKey(index, processId));
+    }
+}
+
+#pragma endregion
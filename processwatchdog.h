@@ -0,0 +1,173 @@
+#ifndef PROCESSWATCHDOG_H
+#define PROCESSWATCHDOG_H
+
+#include <QString>
+#include <QVector>
+#include <QHash>
+#include <functional>
+#include "platform.h" // For the DWORD type
+#include "processsnapshot.h"
+#include "processranking.h"
+#include "processfilter.h"
+
+/**
+ * @class ProcessWatchdog
+ * @brief Evaluates resource threshold rules against sampled process metrics.
+ *
+ * A rule starts timing a process once its metric rises above the trigger threshold and fires after the
+ * value stayed above the trigger threshold for the sustain duration; any sample at or below it restarts
+ * the timing. Dropping below the clear threshold re-arms the rule for that process (hysteresis), and a
+ * cooldown limits how often a rule fires. The cooldown is kept until the process exits, so a value
+ * hovering around the thresholds does not fire on every crossing. State belongs to one process lifetime
+ * (process ID and creation time), so a process that reuses an ID starts fresh.
+ *
+ * Rules are kept sorted by threshold per metric, so a process below every threshold costs a single
+ * comparison; only processes with running rule state are looked at in more detail.
+ *
+ * Rule file format, one rule per line (`#` starts a comment):
+ * @code
+ *   cpu > 90% for 30s clear 80% cooldown 120s -> minimize where name ~ "chrome"
+ *   rss > 2GB for 10s -> opacity 128
+ *   cpu > 95% for 5m -> kill where !visible
+ * @endcode
+ * Actions: log, minimize, opacity <0-255>, kill. The optional `where` clause is a ProcessFilter query.
+ */
+class ProcessWatchdog {
+public:
+    /**
+     * @brief The metric a rule watches.
+     */
+    enum Metric {
+        CpuUsage,       // CPU usage in hundredths of a percent
+        MemoryUsage,    // Working set in bytes
+        MetricCount
+    };
+
+    /**
+     * @brief What happens when a rule fires.
+     */
+    enum Action {
+        LogOnly,        // Only write a log entry
+        Minimize,       // Minimize the process window
+        LowerOpacity,   // Set the window opacity to Rule::opacity
+        Kill            // Terminate the process
+    };
+
+    /**
+     * @brief A threshold rule.
+     */
+    struct Rule {
+        QString text;           // Source line, used in log messages
+        Metric metric;          // Watched metric
+        qint64 triggerAbove;    // Value above which the rule starts timing
+        qint64 clearBelow;      // Value below which the rule resets
+        qint64 sustainMs;       // Time continuously above the trigger threshold before firing
+        qint64 cooldownMs;      // Minimum time between two firings for the same process
+        Action action;          // Action to take
+        int opacity;            // Target opacity for LowerOpacity
+        ProcessFilter scope;    // Processes the rule applies to; invalid means all processes
+    };
+
+    /**
+     * @brief A rule that fired for a process.
+     */
+    struct Trigger {
+        int rule;               // Index of the rule
+        DWORD processId;        // ID of the process
+        QString processName;    // Name of the process
+        qint64 value;           // Metric value at the time of firing
+    };
+
+    #pragma region Constructors and Destructor
+
+    /**
+     * @brief Creates a watchdog without rules.
+     */
+    ProcessWatchdog();
+
+    /**
+     * @brief Destructor for cleaning up the watchdog.
+     */
+    ~ProcessWatchdog();
+
+    #pragma endregion
+
+    #pragma region Rules
+
+    /**
+     * @brief Adds a rule.
+     * @param rule The rule to add.
+     */
+    void addRule(const Rule &rule);
+
+    /**
+     * @brief Parses a single rule line.
+     * @param text The rule text.
+     * @param rule Receives the parsed rule.
+     * @param error Receives a description of the problem on failure.
+     * @return True on success.
+     */
+    static bool parseRule(const QString &text, Rule &rule, QString &error);
+
+    /**
+     * @brief Replaces all rules with the rules of a rule file.
+     * @param path Path to the rule file.
+     * @param logCallback Callback function to handle logging messages (parse errors).
+     * @return The number of rules loaded, or -1 if the file could not be opened.
+     */
+    int loadRules(const QString &path, std::function<void(const QString &)> logCallback);
+
+    /**
+     * @brief Removes all rules and their state.
+     */
+    void clearRules();
+
+    /**
+     * @brief Returns a rule.
+     * @param index The rule index.
+     */
+    const Rule &rule(int index) const;
+
+    /**
+     * @brief Returns the number of rules.
+     */
+    int ruleCount() const;
+
+    #pragma endregion
+
+    #pragma region Evaluation
+
+    /**
+     * @brief Evaluates all rules against a sampled snapshot.
+     * @param snapshot The sampled snapshot (memory usage).
+     * @param ranking A ranking already updated with the snapshot (CPU usage).
+     * @return The rules that fired, in snapshot order.
+     */
+    QVector<Trigger> evaluate(const ProcessSnapshot &snapshot, const ProcessRanking &ranking);
+
+    #pragma endregion
+
+private:
+    /**
+     * @brief Per rule and process timing state.
+     */
+    struct RuleState {
+        qint64 aboveSince;  // When the value rose above the trigger threshold, or -1 while at or below it
+    };
+
+    static quint64 stateKey(int rule, DWORD processId) { return (static_cast<quint64>(rule) << 32) | processId; }
+    void forgetProcess(DWORD processId);
+
+    #pragma region Member Variables
+
+    QVector<Rule> rules;                            // All rules
+    QVector<int> rulesByThreshold[MetricCount];     // Rule indices per metric, ascending trigger threshold
+    QHash<quint64, RuleState> states;               // (rule, process) -> timing state, dropped when re-armed
+    QHash<quint64, qint64> lastFired;               // (rule, process) -> when the rule last fired, kept until the process exits
+    QHash<DWORD, QVector<int>> activeRules;         // Process ID -> rules with timing state
+    QHash<DWORD, qint64> creationTimes;             // Process ID -> creation time of the process the state belongs to
+
+    #pragma endregion
+};
+
+#endif // PROCESSWATCHDOG_H
@@ -0,0 +1,314 @@
+#include "snapshotcache.h"
+#include <QDateTime>
+#include <QDir>
+#include <QFileInfo>
+#include <QHash>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <cstring>
+
+/**
+ * @brief Fixed-size file header; the sections follow in the order documented in the class.
+ */
+struct SnapshotCache::Header {
+    char magic[4];              // "CWSC"
+    quint16 version;            // Layout version
+    quint16 headerSize;         // sizeof(Header)
+    quint32 byteOrderMark;      // byteOrderMark as written, rejects files from the other byte order
+    quint32 rows;               // Process rows
+    quint32 recentTargets;      // Recent search targets
+    quint32 columnCount;        // ProcessSnapshot::ColumnCount of the writer
+    qint64 savedAt;             // Milliseconds since the epoch
+    qint64 captureTime;         // ProcessSnapshot::captureTime() of the stored snapshot
+    quint64 stringUnits;        // UTF-16 code units in the string section
+    quint64 fileSize;           // Total size including padding
+    quint64 reserved;           // Zero
+};
+
+/**
+ * @brief A string in the string section.
+ */
+struct SnapshotCache::StringRef {
+    quint32 offset;             // First UTF-16 code unit
+    quint32 length;             // Number of code units
+};
+
+namespace {
+
+const char cacheMagic[4] = { 'C', 'W', 'S', 'C' };
+const quint16 cacheVersion = 1;
+const quint32 byteOrderMark = 0x01020304;
+
+} // namespace
+
+#pragma region Constructor and Destructor
+
+/**
+ * @brief Constructs a closed cache.
+ */
+SnapshotCache::SnapshotCache()
+    : mapping(nullptr), header(nullptr), columns(nullptr), nameRefs(nullptr), titleRefs(nullptr),
+      recentRefs(nullptr), stringData(nullptr) {}
+
+/**
+ * @brief Unmaps the file.
+ */
+SnapshotCache::~SnapshotCache() {
+    close();
+}
+
+#pragma endregion
+
+#pragma region Files
+
+/**
+ * @brief Returns "snapshot.cache" in the application data directory.
+ */
+QString SnapshotCache::defaultPath() {
+    return QStandardPaths::writableLocation(QStandardPaths::AppLocalDataLocation) + "/snapshot.cache";
+}
+
+/**
+ * @brief Lays the file out in memory and replaces the old file in one step, so a reader never maps a torn file.
+ */
+bool SnapshotCache::save(const QString &path, const ProcessSnapshot &snapshot, const QStringList &recentTargets,
+                         QString *errorString) {
+    static_assert(sizeof(Header) == 64, "The cache header must keep its on-disk size");
+    const quint32 rows = static_cast<quint32>(snapshot.size());
+    const quint32 recent = static_cast<quint32>(recentTargets.size());
+
+    // Strings first, since their total size is needed for the layout; interned strings are stored once
+    QString strings;
+    QHash<quint32, StringRef> stored;
+    auto addString = [&strings](QStringView text) {
+        StringRef ref = { static_cast<quint32>(strings.size()), static_cast<quint32>(text.size()) };
+        strings.append(text);
+        return ref;
+    };
+    auto addPoolString = [&](quint32 id) {
+        auto it = stored.constFind(id);
+        if (it != stored.constEnd()) {
+            return it.value();
+        }
+        StringRef ref = addString(snapshot.stringPool().view(id));
+        stored.insert(id, ref);
+        return ref;
+    };
+
+    QVector<StringRef> refs;
+    refs.reserve(static_cast<int>(2 * rows + recent));
+    for (quint32 row = 0; row < rows; ++row) {
+        refs.append(addPoolString(snapshot.processNameId(static_cast<int>(row))));
+    }
+    for (quint32 row = 0; row < rows; ++row) {
+        refs.append(addPoolString(snapshot.windowTitleId(static_cast<int>(row))));
+    }
+    for (const QString &target : recentTargets) {
+        refs.append(addString(target));
+    }
+
+    const quint64 columnsBytes = quint64(ProcessSnapshot::ColumnCount) * rows * sizeof(qint64);
+    const quint64 refsBytes = quint64(refs.size()) * sizeof(StringRef);
+    const quint64 stringsOffset = sizeof(Header) + columnsBytes + refsBytes;
+    const quint64 fileSize = (stringsOffset + quint64(strings.size()) * sizeof(char16_t) + 7) & ~quint64(7);
+
+    QByteArray data(static_cast<qsizetype>(fileSize), '\0');
+    char *out = data.data();
+
+    Header header = {};
+    std::memcpy(header.magic, cacheMagic, sizeof(cacheMagic));
+    header.version = cacheVersion;
+    header.headerSize = sizeof(Header);
+    header.byteOrderMark = byteOrderMark;
+    header.rows = rows;
+    header.recentTargets = recent;
+    header.columnCount = ProcessSnapshot::ColumnCount;
+    header.savedAt = QDateTime::currentMSecsSinceEpoch();
+    header.captureTime = snapshot.captureTime();
+    header.stringUnits = static_cast<quint64>(strings.size());
+    header.fileSize = fileSize;
+    std::memcpy(out, &header, sizeof(Header));
+
+    char *columnOut = out + sizeof(Header);
+    for (int column = 0; column < ProcessSnapshot::ColumnCount; ++column) {
+        if (rows > 0) {
+            std::memcpy(columnOut, snapshot.columnData(static_cast<ProcessSnapshot::Column>(column)), rows * sizeof(qint64));
+        }
+        columnOut += rows * sizeof(qint64);
+    }
+    if (!refs.isEmpty()) {
+        std::memcpy(columnOut, refs.constData(), refsBytes);
+    }
+    if (!strings.isEmpty()) {
+        std::memcpy(out + stringsOffset, strings.utf16(), quint64(strings.size()) * sizeof(char16_t));
+    }
+
+    QDir().mkpath(QFileInfo(path).absolutePath());
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly) || file.write(data) != data.size() || !file.commit()) {
+        if (errorString) {
+            *errorString = file.errorString();
+        }
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Maps the file and checks the header and every string reference; the data itself is not touched.
+ */
+bool SnapshotCache::open(const QString &path) {
+    close();
+    error.clear();
+
+    file.setFileName(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return fail(file.errorString());
+    }
+
+    const qint64 size = file.size();
+    if (size < static_cast<qint64>(sizeof(Header))) {
+        return fail("File is too small");
+    }
+    mapping = file.map(0, size);
+    if (mapping == nullptr) {
+        return fail(file.errorString());
+    }
+
+    header = reinterpret_cast<const Header *>(mapping);
+    if (std::memcmp(header->magic, cacheMagic, sizeof(cacheMagic)) != 0) {
+        return fail("Not a snapshot cache");
+    }
+    if (header->version != cacheVersion || header->headerSize != sizeof(Header)) {
+        return fail(QString("Unsupported version %1").arg(header->version));
+    }
+    if (header->byteOrderMark != byteOrderMark || header->columnCount != ProcessSnapshot::ColumnCount) {
+        return fail("Written by an incompatible build");
+    }
+
+    const quint64 rows = header->rows;
+    const quint64 columnsBytes = quint64(ProcessSnapshot::ColumnCount) * rows * sizeof(qint64);
+    const quint64 refCount = 2 * rows + header->recentTargets;
+    const quint64 stringsOffset = sizeof(Header) + columnsBytes + refCount * sizeof(StringRef);
+    if (header->fileSize != static_cast<quint64>(size) || header->stringUnits > static_cast<quint64>(size)
+        || stringsOffset + header->stringUnits * sizeof(char16_t) > static_cast<quint64>(size)) {
+        return fail("File is truncated");
+    }
+
+    columns = reinterpret_cast<const qint64 *>(mapping + sizeof(Header));
+    nameRefs = reinterpret_cast<const StringRef *>(mapping + sizeof(Header) + columnsBytes);
+    titleRefs = nameRefs + rows;
+    recentRefs = titleRefs + rows;
+    stringData = reinterpret_cast<const char16_t *>(mapping + stringsOffset);
+
+    for (quint64 i = 0; i < refCount; ++i) {
+        if (quint64(nameRefs[i].offset) + nameRefs[i].length > header->stringUnits) {
+            return fail("String reference out of range");
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Unmaps and closes the file.
+ */
+void SnapshotCache::close() {
+    if (mapping != nullptr) {
+        file.unmap(mapping);
+    }
+    file.close();
+
+    mapping = nullptr;
+    header = nullptr;
+    columns = nullptr;
+    nameRefs = titleRefs = recentRefs = nullptr;
+    stringData = nullptr;
+}
+
+/**
+ * @brief Returns true while a valid file is mapped.
+ */
+bool SnapshotCache::isOpen() const {
+    return mapping != nullptr;
+}
+
+/**
+ * @brief Returns the reason the last open() failed.
+ */
+QString SnapshotCache::errorString() const {
+    return error;
+}
+
+#pragma endregion
+
+#pragma region Data Access
+
+/**
+ * @brief Returns the number of cached rows.
+ */
+int SnapshotCache::size() const {
+    return header ? static_cast<int>(header->rows) : 0;
+}
+
+/**
+ * @brief Returns the time the cache was written.
+ */
+qint64 SnapshotCache::savedAt() const {
+    return header ? header->savedAt : 0;
+}
+
+/**
+ * @brief Reads a numeric column of the mapping.
+ */
+qint64 SnapshotCache::value(ProcessSnapshot::Column column, int row) const {
+    return columns[quint64(column) * header->rows + static_cast<quint64>(row)];
+}
+
+/**
+ * @brief Returns the process ID of a cached row.
+ */
+DWORD SnapshotCache::processId(int row) const {
+    return static_cast<DWORD>(value(ProcessSnapshot::ProcessId, row));
+}
+
+/**
+ * @brief Returns the executable name of a cached row.
+ */
+QStringView SnapshotCache::processName(int row) const {
+    return string(nameRefs[row]);
+}
+
+/**
+ * @brief Returns the main window title of a cached row.
+ */
+QStringView SnapshotCache::windowTitle(int row) const {
+    return string(titleRefs[row]);
+}
+
+/**
+ * @brief Returns the number of recent search targets.
+ */
+int SnapshotCache::recentTargetCount() const {
+    return header ? static_cast<int>(header->recentTargets) : 0;
+}
+
+/**
+ * @brief Returns a recent search target.
+ */
+QStringView SnapshotCache::recentTarget(int index) const {
+    return string(recentRefs[index]);
+}
+
+// View of a string in the mapping
+QStringView SnapshotCache::string(const StringRef &ref) const {
+    return QStringView(stringData + ref.offset, static_cast<qsizetype>(ref.length));
+}
+
+// Record why open() failed and leave the cache closed
+bool SnapshotCache::fail(const QString &reason) {
+    close();
+    error = reason;
+    return false;
+}
+
+#pragma endregion
@@ -0,0 +1,160 @@
+#ifndef SNAPSHOTCACHE_H
+#define SNAPSHOTCACHE_H
+
+#include <QFile>
+#include <QString>
+#include <QStringList>
+#include <QStringView>
+#include "platform.h" // For the DWORD type
+#include "processsnapshot.h"
+
+/**
+ * @class SnapshotCache
+ * @brief Memory-mapped copy of the last process snapshot and the recent search targets, used at startup
+ *        for the details of the most recent target and the completions before the first enumeration has finished.
+ *
+ * The file is laid out so it can be used in place: after open() maps it and checks the header and
+ * the string references, every accessor reads straight from the mapping and strings are returned as
+ * views of the mapped UTF-16 data. The cache decodes nothing up front; callers that keep strings past
+ * close() copy them.
+ *
+ * File layout (native byte order, every section 8-byte aligned):
+ * @code
+ *   Header (64 bytes): "CWSC" u16 version u16 headerSize u32 byteOrderMark u32 rows u32 recentTargets
+ *                      u32 columnCount i64 savedAt i64 captureTime u64 stringUnits u64 fileSize
+ *   columnCount x rows x i64                       numeric columns (ProcessSnapshot::Column order)
+ *   rows x {u32 offset, u32 length}                process names
+ *   rows x {u32 offset, u32 length}                window titles
+ *   recentTargets x {u32 offset, u32 length}       recent search targets, most recent first
+ *   stringUnits x u16                              UTF-16 string data (shared by equal strings)
+ * @endcode
+ * Files with another version, byte order or column count are rejected and rewritten on the next save.
+ */
+class SnapshotCache {
+public:
+    #pragma region Constructors and Destructor
+
+    /**
+     * @brief Creates a closed cache.
+     */
+    SnapshotCache();
+
+    /**
+     * @brief Unmaps the file.
+     */
+    ~SnapshotCache();
+
+    SnapshotCache(const SnapshotCache &) = delete;
+    SnapshotCache &operator=(const SnapshotCache &) = delete;
+
+    #pragma endregion
+
+    #pragma region Files
+
+    /**
+     * @brief Returns the cache file in the application data directory.
+     */
+    static QString defaultPath();
+
+    /**
+     * @brief Writes a snapshot and the recent targets to a cache file, replacing it atomically.
+     *        The file must not be mapped by an open cache while it is replaced.
+     * @param path The cache file.
+     * @param snapshot The snapshot to store.
+     * @param recentTargets The recent search targets, most recent first.
+     * @param errorString Receives the reason on failure (optional).
+     * @return False if the file could not be written.
+     */
+    static bool save(const QString &path, const ProcessSnapshot &snapshot, const QStringList &recentTargets,
+                     QString *errorString = nullptr);
+
+    /**
+     * @brief Maps a cache file and validates it.
+     * @return False if the file is missing, cannot be mapped or is not a valid cache; errorString() has the reason.
+     */
+    bool open(const QString &path);
+
+    /**
+     * @brief Unmaps the file. Views returned earlier become invalid.
+     */
+    void close();
+
+    /**
+     * @brief Returns true while a valid file is mapped.
+     */
+    bool isOpen() const;
+
+    /**
+     * @brief Returns the reason the last open() failed.
+     */
+    QString errorString() const;
+
+    #pragma endregion
+
+    #pragma region Data Access
+
+    /**
+     * @brief Returns the number of cached process rows.
+     */
+    int size() const;
+
+    /**
+     * @brief Returns the time the cache was written (milliseconds since the epoch).
+     */
+    qint64 savedAt() const;
+
+    /**
+     * @brief Returns a numeric value of a cached row.
+     */
+    qint64 value(ProcessSnapshot::Column column, int row) const;
+
+    /**
+     * @brief Returns the process ID of a cached row.
+     */
+    DWORD processId(int row) const;
+
+    /**
+     * @brief Returns the executable name of a cached row (a view of the mapping).
+     */
+    QStringView processName(int row) const;
+
+    /**
+     * @brief Returns the main window title of a cached row (a view of the mapping).
+     */
+    QStringView windowTitle(int row) const;
+
+    /**
+     * @brief Returns the number of recent search targets.
+     */
+    int recentTargetCount() const;
+
+    /**
+     * @brief Returns a recent search target (a view of the mapping); index 0 is the most recent.
+     */
+    QStringView recentTarget(int index) const;
+
+    #pragma endregion
+
+private:
+    struct Header;
+    struct StringRef;
+
+    QStringView string(const StringRef &ref) const;
+    bool fail(const QString &reason);
+
+    #pragma region Member Variables
+
+    QFile file;                         // Mapped cache file
+    uchar *mapping;                     // Start of the mapping (nullptr when closed)
+    const Header *header;               // File header
+    const qint64 *columns;              // Numeric columns, one after another
+    const StringRef *nameRefs;          // Process name references
+    const StringRef *titleRefs;         // Window title references
+    const StringRef *recentRefs;        // Recent target references
+    const char16_t *stringData;         // UTF-16 string data
+    QString error;                      // Reason of the last failed open()
+
+    #pragma endregion
+};
+
+#endif // SNAPSHOTCACHE_H
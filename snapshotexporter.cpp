@@ -0,0 +1,568 @@
+#include "snapshotexporter.h"
+#include <QDir>
+#include <QDateTime>
+#include <QtEndian>
+#include <QSysInfo>
+#include <charconv>
+#include <cstring>
+
+namespace {
+
+// Field names of the numeric columns, indexed by ProcessSnapshot::Column
+const char *const columnNames[ProcessSnapshot::ColumnCount] = {
+    "pid", "ppid", "threads", "rss", "cputime", "x", "y", "width", "height", "opacity", "topmost", "visible"
+};
+
+const char *const recordKindNames[] = { "row", "added", "changed", "removed" };
+
+const qsizetype flushThreshold = 256 * 1024;   // Buffered bytes before writing to the device
+const quint16 columnarVersion = 1;
+
+} // namespace
+
+#pragma region Constructor and Destructor
+
+/**
+ * @brief Constructs an exporter writing full CSV snapshots without an output.
+ */
+SnapshotExporter::SnapshotExporter()
+    : format(Csv), mode(Full), device(nullptr), maxFileBytes(0), maxFileAgeMs(0), maxFiles(0),
+      fileOpenedAt(0), fileBytes(0), needsFullSnapshot(true), generation(0), records(0), bytes(0) {}
+
+/**
+ * @brief Flushes and closes the output.
+ */
+SnapshotExporter::~SnapshotExporter() {
+    close();
+}
+
+#pragma endregion
+
+#pragma region Configuration
+
+/**
+ * @brief Sets the output format.
+ */
+void SnapshotExporter::setFormat(Format newFormat) {
+    format = newFormat;
+}
+
+/**
+ * @brief Sets full or diff mode.
+ */
+void SnapshotExporter::setMode(Mode newMode) {
+    mode = newMode;
+    needsFullSnapshot = true;
+}
+
+/**
+ * @brief Returns the file extension of the current format.
+ */
+QString SnapshotExporter::fileExtension() const {
+    switch (format) {
+    case JsonLines:
+        return "jsonl";
+    case Columnar:
+        return "cwsb";
+    default:
+        return "csv";
+    }
+}
+
+/**
+ * @brief Writes to a caller supplied device from now on.
+ */
+void SnapshotExporter::setDevice(QIODevice *newDevice) {
+    close();
+    rotationDirectory.clear();
+    device = newDevice;
+    fileBytes = 0;
+    if (device != nullptr) {
+        writeHeader();
+    }
+}
+
+/**
+ * @brief Writes to rotating files from now on. The first file is opened on the next write.
+ */
+void SnapshotExporter::setRotation(const QString &directory, const QString &baseName, qint64 fileBytesLimit, qint64 fileAgeLimitMs, int filesKept) {
+    close();
+    rotationDirectory = directory;
+    rotationBaseName = baseName;
+    maxFileBytes = fileBytesLimit;
+    maxFileAgeMs = fileAgeLimitMs;
+    maxFiles = filesKept;
+}
+
+#pragma endregion
+
+#pragma region Export
+
+/**
+ * @brief Writes a snapshot in the configured format and mode.
+ * @return False if there is no output or writing failed.
+ */
+bool SnapshotExporter::write(const ProcessSnapshot &snapshot) {
+    if (!prepareOutput(snapshot.captureTime())) {
+        return false;
+    }
+
+    ++generation;
+    const int count = snapshot.size();
+    const bool diff = mode == Diff && !needsFullSnapshot;
+
+    QVector<int> rows;
+    QVector<quint8> kinds;
+    QVector<DWORD> removed;
+    rows.reserve(diff ? 0 : count);
+    kinds.reserve(diff ? 0 : count);
+
+    if (mode == Diff) {
+        // Compare row digests with the previously written snapshot
+        QHash<DWORD, quint64> digests;
+        digests.reserve(count);
+
+        for (int row = 0; row < count; ++row) {
+            DWORD processId = snapshot.processId(row);
+            quint64 digest = rowDigest(snapshot, row);
+            digests.insert(processId, digest);
+
+            if (!diff) {
+                rows.append(row);
+                kinds.append(Row);
+                continue;
+            }
+
+            auto previous = lastDigests.constFind(processId);
+            if (previous == lastDigests.constEnd()) {
+                rows.append(row);
+                kinds.append(Added);
+            } else if (previous.value() != digest) {
+                rows.append(row);
+                kinds.append(Changed);
+            }
+        }
+
+        if (diff) {
+            for (auto it = lastDigests.constBegin(); it != lastDigests.constEnd(); ++it) {
+                if (!digests.contains(it.key())) {
+                    removed.append(it.key());
+                }
+            }
+        }
+        lastDigests.swap(digests);
+    } else {
+        for (int row = 0; row < count; ++row) {
+            rows.append(row);
+            kinds.append(Row);
+        }
+    }
+    needsFullSnapshot = false;
+
+    if (format == Columnar) {
+        writeColumnarBlock(snapshot, rows, kinds, removed, diff);
+    } else {
+        for (int i = 0; i < rows.size(); ++i) {
+            writeTextRecord(snapshot, rows[i], static_cast<RecordKind>(kinds[i]), generation);
+            if (buffer.size() >= flushThreshold && !flush()) {
+                return false;
+            }
+        }
+        for (DWORD processId : removed) {
+            writeRemovedTextRecord(processId, snapshot.captureTime(), generation);
+        }
+    }
+
+    records += rows.size() + removed.size();
+    return flush();
+}
+
+/**
+ * @brief Writes buffered output to the device.
+ */
+bool SnapshotExporter::flush() {
+    if (buffer.isEmpty() || device == nullptr) {
+        return true;
+    }
+
+    qint64 written = device->write(buffer.constData(), buffer.size());
+    bool ok = written == buffer.size();
+    if (!ok) {
+        error = device->errorString();
+    }
+
+    if (written > 0) {
+        bytes += written;
+        fileBytes += written;
+    }
+    buffer.clear();
+    return ok;
+}
+
+/**
+ * @brief Flushes and closes the output. The next snapshot is written in full.
+ */
+void SnapshotExporter::close() {
+    flush();
+    if (rotatingFile.isOpen()) {
+        rotatingFile.close();
+    }
+    device = nullptr;
+    needsFullSnapshot = true;
+    lastDigests.clear();
+}
+
+/**
+ * @brief Returns the number of records written.
+ */
+qint64 SnapshotExporter::recordsWritten() const {
+    return records;
+}
+
+/**
+ * @brief Returns the number of bytes written.
+ */
+qint64 SnapshotExporter::bytesWritten() const {
+    return bytes;
+}
+
+/**
+ * @brief Returns the last error.
+ */
+QString SnapshotExporter::errorString() const {
+    return error;
+}
+
+#pragma endregion
+
+#pragma region Output Files
+
+/**
+ * @brief Makes sure an output is available, rotating files when limits are reached.
+ */
+bool SnapshotExporter::prepareOutput(qint64 captureTime) {
+    if (rotationDirectory.isEmpty()) {
+        if (device == nullptr) {
+            error = "No output configured";
+            return false;
+        }
+        return true;
+    }
+
+    bool rotate = !rotatingFile.isOpen()
+                  || (maxFileBytes > 0 && fileBytes >= maxFileBytes)
+                  || (maxFileAgeMs > 0 && captureTime - fileOpenedAt >= maxFileAgeMs);
+    return !rotate || openRotatingFile(captureTime);
+}
+
+/**
+ * @brief Closes the current file and starts a new one.
+ */
+bool SnapshotExporter::openRotatingFile(qint64 captureTime) {
+    flush();
+    if (rotatingFile.isOpen()) {
+        rotatingFile.close();
+    }
+    device = nullptr;
+
+    QDir directory(rotationDirectory);
+    if (!directory.mkpath(".")) {
+        error = QString("Cannot create directory %1").arg(rotationDirectory);
+        return false;
+    }
+
+    // Timestamp plus a zero-padded counter for several files per second, so name order is creation order
+    QString stem = QString("%1-%2").arg(rotationBaseName, QDateTime::currentDateTime().toString("yyyyMMdd-HHmmss"));
+    QString path;
+    int counter = 0;
+    do {
+        path = directory.filePath(QString("%1-%2.%3").arg(stem).arg(counter++, 3, 10, QChar('0')).arg(fileExtension()));
+    } while (QFile::exists(path));
+
+    rotatingFile.setFileName(path);
+    if (!rotatingFile.open(QIODevice::WriteOnly)) {
+        error = rotatingFile.errorString();
+        return false;
+    }
+
+    device = &rotatingFile;
+    fileOpenedAt = captureTime;
+    fileBytes = 0;
+    needsFullSnapshot = true;   // Every file starts with a complete snapshot
+    writeHeader();
+    removeOldFiles();
+    return true;
+}
+
+/**
+ * @brief Deletes the oldest rotating files beyond the configured count; the names sort by creation.
+ */
+void SnapshotExporter::removeOldFiles() {
+    if (maxFiles <= 0) {
+        return;
+    }
+
+    QDir directory(rotationDirectory);
+    QStringList files = directory.entryList({ QString("%1-*.%2").arg(rotationBaseName, fileExtension()) }, QDir::Files, QDir::Name);
+    for (int i = 0; i + maxFiles < files.size(); ++i) {
+        directory.remove(files[i]);
+    }
+}
+
+/**
+ * @brief Writes the CSV header line; the other formats are self-describing.
+ */
+void SnapshotExporter::writeHeader() {
+    if (format != Csv) {
+        return;
+    }
+
+    appendLatin1("generation,time,kind");
+    for (const char *name : columnNames) {
+        appendRaw(",", 1);
+        appendLatin1(name);
+    }
+    appendLatin1(",name,title\n");
+}
+
+#pragma endregion
+
+#pragma region Encoding
+
+/**
+ * @brief Appends a little-endian binary value.
+ */
+template <typename T>
+void SnapshotExporter::appendBinary(T value) {
+    T littleEndian = qToLittleEndian(value);
+    appendRaw(reinterpret_cast<const char *>(&littleEndian), sizeof(T));
+}
+
+/**
+ * @brief Writes one CSV line or JSON object for a snapshot row.
+ */
+void SnapshotExporter::writeTextRecord(const ProcessSnapshot &snapshot, int row, RecordKind kind, qint64 gen) {
+    if (format == Csv) {
+        appendNumber(gen);
+        appendRaw(",", 1);
+        appendNumber(snapshot.captureTime());
+        appendRaw(",", 1);
+        appendLatin1(recordKindNames[kind]);
+        for (int column = 0; column < ProcessSnapshot::ColumnCount; ++column) {
+            appendRaw(",", 1);
+            appendNumber(snapshot.value(static_cast<ProcessSnapshot::Column>(column), row));
+        }
+        appendRaw(",", 1);
+        appendUtf8(snapshot.processName(row), Csv);
+        appendRaw(",", 1);
+        appendUtf8(snapshot.windowTitle(row), Csv);
+        appendRaw("\n", 1);
+        return;
+    }
+
+    appendLatin1("{\"gen\":");
+    appendNumber(gen);
+    appendLatin1(",\"time\":");
+    appendNumber(snapshot.captureTime());
+    appendLatin1(",\"kind\":\"");
+    appendLatin1(recordKindNames[kind]);
+    appendRaw("\"", 1);
+    for (int column = 0; column < ProcessSnapshot::ColumnCount; ++column) {
+        appendLatin1(",\"");
+        appendLatin1(columnNames[column]);
+        appendLatin1("\":");
+        appendNumber(snapshot.value(static_cast<ProcessSnapshot::Column>(column), row));
+    }
+    appendLatin1(",\"name\":");
+    appendUtf8(snapshot.processName(row), JsonLines);
+    appendLatin1(",\"title\":");
+    appendUtf8(snapshot.windowTitle(row), JsonLines);
+    appendLatin1("}\n");
+}
+
+/**
+ * @brief Writes one CSV line or JSON object for an exited process.
+ */
+void SnapshotExporter::writeRemovedTextRecord(DWORD processId, qint64 captureTime, qint64 gen) {
+    if (format == Csv) {
+        appendNumber(gen);
+        appendRaw(",", 1);
+        appendNumber(captureTime);
+        appendLatin1(",removed,");
+        appendNumber(processId);
+        for (int column = 1; column < ProcessSnapshot::ColumnCount; ++column) {
+            appendRaw(",", 1);
+        }
+        appendLatin1(",,\n");
+        return;
+    }
+
+    appendLatin1("{\"gen\":");
+    appendNumber(gen);
+    appendLatin1(",\"time\":");
+    appendNumber(captureTime);
+    appendLatin1(",\"kind\":\"removed\",\"pid\":");
+    appendNumber(processId);
+    appendLatin1("}\n");
+}
+
+/**
+ * @brief Writes one binary block. Full snapshots copy the numeric columns as-is.
+ */
+void SnapshotExporter::writeColumnarBlock(const ProcessSnapshot &snapshot, const QVector<int> &rows, const QVector<quint8> &kinds,
+                                          const QVector<DWORD> &removed, bool diff) {
+    const qsizetype count = rows.size();
+
+    appendRaw("CWSB", 4);
+    appendBinary<quint16>(columnarVersion);
+    appendBinary<quint16>(diff ? 1 : 0);
+    appendBinary<quint32>(static_cast<quint32>(count));
+    appendBinary<quint32>(static_cast<quint32>(removed.size()));
+    appendBinary<qint64>(snapshot.captureTime());
+
+    // Numeric columns: a straight copy when every row is exported in order
+    const bool identity = count == snapshot.size();
+    for (int column = 0; column < ProcessSnapshot::ColumnCount; ++column) {
+        const qint64 *data = snapshot.columnData(static_cast<ProcessSnapshot::Column>(column));
+        if (identity && QSysInfo::ByteOrder == QSysInfo::LittleEndian) {
+            appendRaw(reinterpret_cast<const char *>(data), count * qsizetype(sizeof(qint64)));
+        } else {
+            for (int row : rows) {
+                appendBinary<qint64>(data[row]);
+            }
+        }
+    }
+
+    appendRaw(reinterpret_cast<const char *>(kinds.constData()), count);
+
+    // String columns: offsets first, patched while the UTF-8 bytes are appended
+    for (int stringColumn = 0; stringColumn < 2; ++stringColumn) {
+        qsizetype offsetTable = buffer.size();
+        buffer.resize(offsetTable + (count + 1) * qsizetype(sizeof(quint32)));
+        qsizetype stringStart = buffer.size();
+
+        for (qsizetype i = 0; i <= count; ++i) {
+            quint32 offset = qToLittleEndian(static_cast<quint32>(buffer.size() - stringStart));
+            std::memcpy(buffer.data() + offsetTable + i * qsizetype(sizeof(quint32)), &offset, sizeof(offset));
+            if (i < count) {
+                appendUtf8(stringColumn == 0 ? snapshot.processName(rows[i]) : snapshot.windowTitle(rows[i]), Columnar);
+            }
+        }
+    }
+
+    for (DWORD processId : removed) {
+        appendBinary<quint32>(processId);
+    }
+}
+
+/**
+ * @brief Appends a decimal number without going through QString.
+ */
+void SnapshotExporter::appendNumber(qint64 value) {
+    char digits[24];
+    std::to_chars_result result = std::to_chars(digits, digits + sizeof(digits), value);
+    appendRaw(digits, result.ptr - digits);
+}
+
+/**
+ * @brief Appends raw bytes.
+ */
+void SnapshotExporter::appendRaw(const char *data, qsizetype size) {
+    buffer.append(data, size);
+}
+
+/**
+ * @brief Appends a null-terminated ASCII string.
+ */
+void SnapshotExporter::appendLatin1(const char *text) {
+    appendRaw(text, static_cast<qsizetype>(std::strlen(text)));
+}
+
+/**
+ * @brief Transcodes a string from UTF-16 to UTF-8 directly into the buffer.
+ *        CSV fields are quoted with doubled quotes, JSON strings are quoted and escaped.
+ */
+void SnapshotExporter::appendUtf8(QStringView text, Format escaping) {
+    // Worst case: 6 bytes per code unit for JSON escapes, plus two quotes
+    qsizetype start = buffer.size();
+    buffer.resize(start + text.size() * 6 + 2);
+    char *out = buffer.data() + start;
+
+    const char16_t *units = reinterpret_cast<const char16_t *>(text.utf16());
+    const qsizetype length = text.size();
+
+    if (escaping != Columnar) {
+        *out++ = '"';
+    }
+
+    for (qsizetype i = 0; i < length; ++i) {
+        char32_t c = units[i];
+
+        if (c < 0x80) {
+            if (c == '"' && escaping != Columnar) {
+                *out++ = escaping == Csv ? '"' : '\\';  // CSV doubles quotes, JSON escapes them, columnar keeps them
+            } else if (escaping == JsonLines && (c == '\\' || c < 0x20)) {
+                static const char hex[] = "0123456789abcdef";
+                *out++ = '\\';
+                if (c == '\\') {
+                    *out++ = '\\';
+                    continue;
+                }
+                *out++ = 'u';
+                *out++ = '0';
+                *out++ = '0';
+                *out++ = hex[c >> 4];
+                *out++ = hex[c & 0xF];
+                continue;
+            }
+            *out++ = static_cast<char>(c);
+            continue;
+        }
+
+        // Combine surrogate pairs; lone surrogates become U+FFFD
+        if (c >= 0xD800 && c <= 0xDBFF && i + 1 < length && units[i + 1] >= 0xDC00 && units[i + 1] <= 0xDFFF) {
+            c = 0x10000 + ((c - 0xD800) << 10) + (units[++i] - 0xDC00);
+        } else if (c >= 0xD800 && c <= 0xDFFF) {
+            c = 0xFFFD;
+        }
+
+        if (c < 0x800) {
+            *out++ = static_cast<char>(0xC0 | (c >> 6));
+            *out++ = static_cast<char>(0x80 | (c & 0x3F));
+        } else if (c < 0x10000) {
+            *out++ = static_cast<char>(0xE0 | (c >> 12));
+            *out++ = static_cast<char>(0x80 | ((c >> 6) & 0x3F));
+            *out++ = static_cast<char>(0x80 | (c & 0x3F));
+        } else {
+            *out++ = static_cast<char>(0xF0 | (c >> 18));
+            *out++ = static_cast<char>(0x80 | ((c >> 12) & 0x3F));
+            *out++ = static_cast<char>(0x80 | ((c >> 6) & 0x3F));
+            *out++ = static_cast<char>(0x80 | (c & 0x3F));
+        }
+    }
+
+    if (escaping != Columnar) {
+        *out++ = '"';
+    }
+    buffer.resize(out - buffer.constData());
+}
+
+/**
+ * @brief Computes a digest of all columns of a row to detect changes between snapshots.
+ */
+quint64 SnapshotExporter::rowDigest(const ProcessSnapshot &snapshot, int row) {
+    quint64 digest = 14695981039346656037ULL;  // FNV-1a offset basis
+    auto mix = [&digest](quint64 value) {
+        digest ^= value;
+        digest *= 1099511628211ULL;
+    };
+
+    for (int column = 0; column < ProcessSnapshot::ColumnCount; ++column) {
+        mix(static_cast<quint64>(snapshot.value(static_cast<ProcessSnapshot::Column>(column), row)));
+    }
+    mix(qHash(snapshot.processName(row)));
+    mix(qHash(snapshot.windowTitle(row)));
+    return digest;
+}
+
+#pragma endregion
@@ -0,0 +1,191 @@
+#ifndef SNAPSHOTEXPORTER_H
+#define SNAPSHOTEXPORTER_H
+
+#include <QString>
+#include <QByteArray>
+#include <QHash>
+#include <QFile>
+#include <QIODevice>
+#include "platform.h" // For the DWORD type
+#include "processsnapshot.h"
+
+/**
+ * @class SnapshotExporter
+ * @brief Streams process snapshots to CSV, JSON Lines or a columnar binary format.
+ *
+ * Values are encoded straight from the snapshot columns into an output buffer (numbers with
+ * std::to_chars, strings transcoded from UTF-16 to UTF-8 in place), so no temporary QString is
+ * built per field. In Diff mode only added, changed and removed processes are written; the first
+ * snapshot written to a new file is always complete so every file can be read on its own.
+ *
+ * Output goes either to a caller supplied device or to rotating files in a directory.
+ *
+ * Columnar block layout (little-endian), one block per written snapshot:
+ * @code
+ *   "CWSB" u16 version u16 flags(1 = diff) u32 rows u32 removed i64 captureTime
+ *   ProcessSnapshot::ColumnCount x rows x i64    numeric columns
+ *   rows x u8                                    record kind (0 = row, 1 = added, 2 = changed)
+ *   (rows + 1) x u32 offsets, UTF-8 bytes        process names
+ *   (rows + 1) x u32 offsets, UTF-8 bytes        window titles
+ *   removed x u32                                removed process IDs
+ * @endcode
+ */
+class SnapshotExporter {
+public:
+    /**
+     * @brief Output format.
+     */
+    enum Format {
+        Csv,        // Comma separated values with a header line
+        JsonLines,  // One JSON object per record
+        Columnar    // Binary column blocks
+    };
+
+    /**
+     * @brief Which records are written per snapshot.
+     */
+    enum Mode {
+        Full,       // Every process
+        Diff        // Added, changed and removed processes
+    };
+
+    #pragma region Constructors and Destructor
+
+    /**
+     * @brief Creates an exporter writing full CSV snapshots.
+     */
+    SnapshotExporter();
+
+    /**
+     * @brief Flushes pending output and closes rotating files.
+     */
+    ~SnapshotExporter();
+
+    #pragma endregion
+
+    #pragma region Configuration
+
+    /**
+     * @brief Sets the output format. Takes effect for the next file or device.
+     */
+    void setFormat(Format format);
+
+    /**
+     * @brief Sets whether full or diff snapshots are written.
+     */
+    void setMode(Mode mode);
+
+    /**
+     * @brief Returns the file extension used for the current format ("csv", "jsonl" or "cwsb").
+     */
+    QString fileExtension() const;
+
+    /**
+     * @brief Writes to an already opened device. The device is not owned by the exporter.
+     * @param device The output device.
+     */
+    void setDevice(QIODevice *device);
+
+    /**
+     * @brief Writes to rotating files named "<baseName>-<timestamp>-<counter>.<extension>" in a directory.
+     * @param directory The output directory; created if missing.
+     * @param baseName Prefix of the file names.
+     * @param maxFileBytes Size after which a new file is started (0 = no size limit).
+     * @param maxFileAgeMs Age after which a new file is started (0 = no age limit).
+     * @param maxFiles Number of files kept; older files are deleted (0 = keep all).
+     */
+    void setRotation(const QString &directory, const QString &baseName, qint64 maxFileBytes, qint64 maxFileAgeMs, int maxFiles);
+
+    #pragma endregion
+
+    #pragma region Export
+
+    /**
+     * @brief Writes a snapshot.
+     * @param snapshot The snapshot to write.
+     * @return False if no output is configured or writing failed; errorString() has the reason.
+     */
+    bool write(const ProcessSnapshot &snapshot);
+
+    /**
+     * @brief Writes buffered output to the device.
+     * @return False if writing failed.
+     */
+    bool flush();
+
+    /**
+     * @brief Flushes and closes the current output. The next snapshot is written in full.
+     */
+    void close();
+
+    /**
+     * @brief Returns the total number of records written.
+     */
+    qint64 recordsWritten() const;
+
+    /**
+     * @brief Returns the total number of bytes written.
+     */
+    qint64 bytesWritten() const;
+
+    /**
+     * @brief Returns the last error.
+     */
+    QString errorString() const;
+
+    #pragma endregion
+
+private:
+    /**
+     * @brief Kind of an exported record.
+     */
+    enum RecordKind : quint8 {
+        Row,        // Full snapshot row
+        Added,      // New process (diff)
+        Changed,    // Changed process (diff)
+        Removed     // Exited process (diff)
+    };
+
+    bool prepareOutput(qint64 captureTime);
+    bool openRotatingFile(qint64 captureTime);
+    void removeOldFiles();
+    void writeHeader();
+
+    void writeTextRecord(const ProcessSnapshot &snapshot, int row, RecordKind kind, qint64 generation);
+    void writeRemovedTextRecord(DWORD processId, qint64 captureTime, qint64 generation);
+    void writeColumnarBlock(const ProcessSnapshot &snapshot, const QVector<int> &rows, const QVector<quint8> &kinds,
+                            const QVector<DWORD> &removed, bool diff);
+
+    void appendNumber(qint64 value);
+    void appendRaw(const char *data, qsizetype size);
+    void appendLatin1(const char *text);
+    void appendUtf8(QStringView text, Format escaping);
+    template <typename T> void appendBinary(T value);
+
+    static quint64 rowDigest(const ProcessSnapshot &snapshot, int row);
+
+    #pragma region Member Variables
+
+    Format format;                      // Output format
+    Mode mode;                          // Full or diff snapshots
+    QIODevice *device;                  // Current output device
+    QFile rotatingFile;                 // Current file when rotating
+    QString rotationDirectory;          // Directory for rotating files (empty = no rotation)
+    QString rotationBaseName;           // File name prefix for rotating files
+    qint64 maxFileBytes;                // Rotation size limit
+    qint64 maxFileAgeMs;                // Rotation age limit
+    int maxFiles;                       // Number of rotating files kept
+    qint64 fileOpenedAt;                // Capture time of the first snapshot in the current file
+    qint64 fileBytes;                   // Bytes written to the current output
+    bool needsFullSnapshot;             // The next snapshot must be written in full
+    qint64 generation;                  // Number of snapshots written
+    QHash<DWORD, quint64> lastDigests;  // Process ID -> digest of the last written row (diff mode)
+    QByteArray buffer;                  // Pending output
+    qint64 records;                     // Records written
+    qint64 bytes;                       // Bytes written
+    QString error;                      // Last error
+
+    #pragma endregion
+};
+
+#endif // SNAPSHOTEXPORTER_H
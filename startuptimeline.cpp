@@ -0,0 +1,120 @@
+#include "startuptimeline.h"
+#include <QCoreApplication>
+#include <QFile>
+#include <QTimer>
+#include <chrono>
+#include "platform.h"
+
+namespace {
+
+std::chrono::steady_clock::time_point startClock;   // Steady time of start()
+qint64 processStartOffset = 0;                      // Microseconds from process creation to start()
+qint64 phaseTimes[StartupTimeline::PhaseCount];     // Microseconds from process creation, -1 = not reached
+QString reportPath;                                 // Report file ("" = no report)
+bool quitAfterReport = false;                       // Quit once the report is written
+bool reportWritten = false;                         // The report is written once
+
+// Time the process existed before main(); only Windows reports the creation time cheaply
+qint64 timeSinceProcessCreation() {
+#ifdef _WIN32
+    FILETIME creationTime, exitTime, kernelTime, userTime, now;
+    if (!GetProcessTimes(GetCurrentProcess(), &creationTime, &exitTime, &kernelTime, &userTime)) {
+        return 0;
+    }
+    GetSystemTimePreciseAsFileTime(&now);
+    ULARGE_INTEGER created = { { creationTime.dwLowDateTime, creationTime.dwHighDateTime } };
+    ULARGE_INTEGER current = { { now.dwLowDateTime, now.dwHighDateTime } };
+    return current.QuadPart > created.QuadPart ? static_cast<qint64>((current.QuadPart - created.QuadPart) / 10) : 0;  // 100 ns -> us
+#else
+    return 0;
+#endif
+}
+
+} // namespace
+
+#pragma region Timeline
+
+/**
+ * @brief Anchors the timeline at process creation and marks MainEntered.
+ */
+void StartupTimeline::start() {
+    startClock = std::chrono::steady_clock::now();
+    processStartOffset = timeSinceProcessCreation();
+    for (qint64 &time : phaseTimes) {
+        time = -1;
+    }
+    mark(MainEntered);
+}
+
+/**
+ * @brief Stores the first time a phase is reached and writes the report once the startup is complete.
+ */
+void StartupTimeline::mark(Phase phase) {
+    if (phaseTimes[phase] >= 0) {
+        return;
+    }
+    phaseTimes[phase] = processStartOffset
+        + std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - startClock).count();
+
+    bool complete = phaseTimes[UiConstructed] >= 0 && phaseTimes[FirstPaint] >= 0 && phaseTimes[FreshData] >= 0;
+    if (!complete || reportPath.isEmpty() || reportWritten) {
+        return;
+    }
+
+    reportWritten = true;
+    QFile file(reportPath);
+    if (file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        writeReport(&file);
+    }
+    if (quitAfterReport) {
+        QTimer::singleShot(0, QCoreApplication::instance(), &QCoreApplication::quit);
+    }
+}
+
+/**
+ * @brief Returns the time of a phase since process creation.
+ */
+qint64 StartupTimeline::elapsed(Phase phase) {
+    return phaseTimes[phase];
+}
+
+/**
+ * @brief Sets the report file written when the startup is complete.
+ */
+void StartupTimeline::setReport(const QString &path, bool quitWhenComplete) {
+    reportPath = path;
+    quitAfterReport = quitWhenComplete;
+}
+
+#pragma endregion
+
+#pragma region Report
+
+/**
+ * @brief Writes {"unit":"ms","phases":{"processStart":0,"mainEntered":..,...}}; unreached phases are null.
+ */
+bool StartupTimeline::writeReport(QIODevice *device) {
+    QByteArray json = "{\"unit\":\"ms\",\"phases\":{\"processStart\":0";
+    for (int phase = 0; phase < PhaseCount; ++phase) {
+        json += ",\"";
+        json += phaseName(static_cast<Phase>(phase));
+        json += "\":";
+        json += phaseTimes[phase] >= 0 ? QByteArray::number(phaseTimes[phase] / 1000.0, 'f', 3) : QByteArray("null");
+    }
+    json += "}}\n";
+    return device->write(json) == json.size();
+}
+
+// JSON keys of the phases
+const char *StartupTimeline::phaseName(Phase phase) {
+    switch (phase) {
+    case MainEntered:   return "mainEntered";
+    case CacheLoaded:   return "cacheLoaded";
+    case UiConstructed: return "uiConstructed";
+    case FirstPaint:    return "firstPaint";
+    case FreshData:     return "freshData";
+    default:            return "unknown";
+    }
+}
+
+#pragma endregion
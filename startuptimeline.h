@@ -0,0 +1,62 @@
+#ifndef STARTUPTIMELINE_H
+#define STARTUPTIMELINE_H
+
+#include <QString>
+#include <QIODevice>
+
+/**
+ * @class StartupTimeline
+ * @brief Records when the startup phases of cWin are reached, measured from process creation.
+ *
+ * main() calls start() first; the other phases are marked as they happen. When a report file is set
+ * (--startup-report), the timings are written as JSON once UI construction, first paint and the first
+ * fresh snapshot have all been reached, so startup regressions can be checked by a script. All methods
+ * are called from the UI thread.
+ */
+class StartupTimeline {
+public:
+    /**
+     * @brief Startup phases, in the order they normally occur.
+     */
+    enum Phase {
+        MainEntered,    // main() started
+        CacheLoaded,    // Warm snapshot cache mapped (not reached without a valid cache)
+        UiConstructed,  // MainWindow constructed
+        FirstPaint,     // MainWindow painted for the first time
+        FreshData,      // First fresh enumeration shown
+        PhaseCount
+    };
+
+    /**
+     * @brief Starts the timeline; call first thing in main().
+     */
+    static void start();
+
+    /**
+     * @brief Records that a phase was reached. Later marks of the same phase are ignored.
+     */
+    static void mark(Phase phase);
+
+    /**
+     * @brief Returns the time from process creation to a phase in microseconds, or -1 if it was not reached.
+     */
+    static qint64 elapsed(Phase phase);
+
+    /**
+     * @brief Writes the report when the startup is complete.
+     * @param path The JSON report file.
+     * @param quitWhenComplete Quit the application after writing the report.
+     */
+    static void setReport(const QString &path, bool quitWhenComplete);
+
+    /**
+     * @brief Writes the phase timings as JSON.
+     * @return False if writing failed.
+     */
+    static bool writeReport(QIODevice *device);
+
+private:
+    static const char *phaseName(Phase phase);
+};
+
+#endif // STARTUPTIMELINE_H
@@ -0,0 +1,177 @@
+#include "stringpool.h"
+#include <QHash>
+#include <atomic>
+#include <cstring>
+
+namespace {
+
+const qsizetype chunkSize = 32 * 1024;  // Code units per arena chunk (64 KB)
+const qsizetype initialBuckets = 1024;    // Must be a power of two
+
+// Generations are unique across pools so caches cannot confuse two pools
+std::atomic<quint64> nextGeneration(1);
+
+} // namespace
+
+#pragma region Constructor and Destructor
+
+/**
+ * @brief Constructs an empty pool. Memory is allocated on the first intern().
+ */
+StringPool::StringPool()
+    : currentChunk(0), chunkUsed(0), currentGeneration(nextGeneration++) {
+    entries.append({ u"", 0, 0 });  // ID 0 is the empty string
+}
+
+/**
+ * @brief Destructor for StringPool.
+ */
+StringPool::~StringPool() {}
+
+#pragma endregion
+
+#pragma region Interning
+
+/**
+ * @brief Looks the string up in the open addressing table and copies it into the arena if it is new.
+ */
+quint32 StringPool::intern(QStringView text) {
+    if (text.isEmpty()) {
+        return 0;
+    }
+
+    // Keep the load factor at or below 1/2
+    if ((entries.size() + 1) * 2 > buckets.size()) {
+        rehash(buckets.isEmpty() ? initialBuckets : buckets.size() * 2);
+    }
+
+    const quint32 hash = static_cast<quint32>(qHash(text));
+    const qsizetype mask = buckets.size() - 1;
+    const qsizetype length = text.size();
+
+    for (qsizetype bucket = hash & mask;; bucket = (bucket + 1) & mask) {
+        quint32 stored = buckets[bucket];
+        if (stored == 0) {
+            char16_t *data = allocate(length);
+            std::memcpy(data, text.utf16(), length * sizeof(char16_t));
+
+            quint32 id = static_cast<quint32>(entries.size());
+            entries.append({ data, static_cast<quint32>(length), hash });
+            buckets[bucket] = id + 1;
+            return id;
+        }
+
+        const Entry &entry = entries[stored - 1];
+        if (entry.hash == hash && entry.length == length
+            && std::memcmp(entry.data, text.utf16(), length * sizeof(char16_t)) == 0) {
+            return stored - 1;
+        }
+    }
+}
+
+/**
+ * @brief Returns a view on an interned string.
+ */
+QStringView StringPool::view(quint32 id) const {
+    const Entry &entry = entries[id];
+    return QStringView(entry.data, entry.length);
+}
+
+/**
+ * @brief Returns a copy of an interned string.
+ */
+QString StringPool::toString(quint32 id) const {
+    return view(id).toString();
+}
+
+#pragma endregion
+
+#pragma region Generations
+
+/**
+ * @brief Forgets all strings. Standard chunks are rewound for reuse, oversized ones are released.
+ */
+void StringPool::reset() {
+    entries.resize(1);
+    buckets.fill(0);
+
+    for (size_t i = chunks.size(); i-- > 0;) {
+        if (chunks[i].capacity != chunkSize) {
+            chunks.erase(chunks.begin() + static_cast<std::ptrdiff_t>(i));
+        }
+    }
+    currentChunk = 0;
+    chunkUsed = 0;
+    currentGeneration = nextGeneration++;
+}
+
+/**
+ * @brief Returns the unique ID of the current generation.
+ */
+quint64 StringPool::generation() const {
+    return currentGeneration;
+}
+
+/**
+ * @brief Returns the number of distinct strings.
+ */
+int StringPool::size() const {
+    return entries.size();
+}
+
+/**
+ * @brief Returns the reserved memory in bytes.
+ */
+qsizetype StringPool::memoryUsage() const {
+    qsizetype total = buckets.capacity() * qsizetype(sizeof(quint32)) + entries.capacity() * qsizetype(sizeof(Entry));
+    for (const Chunk &chunk : chunks) {
+        total += chunk.capacity * qsizetype(sizeof(char16_t));
+    }
+    return total;
+}
+
+#pragma endregion
+
+#pragma region Arena
+
+/**
+ * @brief Reserves space for a string in the arena. Strings longer than a chunk get their own chunk.
+ */
+char16_t *StringPool::allocate(qsizetype length) {
+    if (length > chunkSize) {
+        chunks.push_back({ std::unique_ptr<char16_t[]>(new char16_t[length]), length });
+        return chunks.back().data.get();
+    }
+
+    // Skip full and oversized chunks; chunks rewound by reset() are reused before allocating new ones
+    while (currentChunk < chunks.size() && (chunks[currentChunk].capacity != chunkSize || chunkUsed + length > chunkSize)) {
+        ++currentChunk;
+        chunkUsed = 0;
+    }
+    if (currentChunk == chunks.size()) {
+        chunks.push_back({ std::unique_ptr<char16_t[]>(new char16_t[chunkSize]), chunkSize });
+        chunkUsed = 0;
+    }
+
+    char16_t *data = chunks[currentChunk].data.get() + chunkUsed;
+    chunkUsed += length;
+    return data;
+}
+
+/**
+ * @brief Rebuilds the lookup table with a new size (a power of two).
+ */
+void StringPool::rehash(qsizetype bucketCount) {
+    buckets.fill(0, bucketCount);
+    const qsizetype mask = bucketCount - 1;
+
+    for (qsizetype id = 1; id < entries.size(); ++id) {
+        qsizetype bucket = entries[id].hash & mask;
+        while (buckets[bucket] != 0) {
+            bucket = (bucket + 1) & mask;
+        }
+        buckets[bucket] = static_cast<quint32>(id + 1);
+    }
+}
+
+#pragma endregion
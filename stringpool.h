@@ -0,0 +1,119 @@
+#ifndef STRINGPOOL_H
+#define STRINGPOOL_H
+
+#include <QString>
+#include <QStringView>
+#include <QVector>
+#include <memory>
+#include <vector>
+
+/**
+ * @class StringPool
+ * @brief Interning table backed by an arena allocator for process names, window titles and classes.
+ *
+ * Every distinct string is stored once in large arena chunks and identified by a small integer ID, so
+ * hundreds of "svchost.exe" rows share one copy and comparing two strings of the same pool is an integer
+ * compare. IDs are stable until reset(), which starts a new generation and reuses the arena memory.
+ * ID 0 is always the empty string.
+ */
+class StringPool {
+public:
+    #pragma region Constructors and Destructor
+
+    /**
+     * @brief Creates an empty pool.
+     */
+    StringPool();
+
+    /**
+     * @brief Destructor releasing the arena.
+     */
+    ~StringPool();
+
+    StringPool(const StringPool &) = delete;
+    StringPool &operator=(const StringPool &) = delete;
+
+    #pragma endregion
+
+    #pragma region Interning
+
+    /**
+     * @brief Returns the ID of a string, copying it into the arena on first use.
+     * @param text The string to intern.
+     * @return The ID of the string.
+     */
+    quint32 intern(QStringView text);
+
+    /**
+     * @brief Returns the characters of an interned string. The view stays valid until reset().
+     * @param id The string ID.
+     */
+    QStringView view(quint32 id) const;
+
+    /**
+     * @brief Returns a copy of an interned string.
+     * @param id The string ID.
+     */
+    QString toString(quint32 id) const;
+
+    #pragma endregion
+
+    #pragma region Generations
+
+    /**
+     * @brief Drops all strings and starts a new generation. Arena chunks are kept for reuse.
+     */
+    void reset();
+
+    /**
+     * @brief Returns an ID of the current generation, unique across all pools of the process.
+     *        Caches keyed by string ID must be discarded when it changes.
+     */
+    quint64 generation() const;
+
+    /**
+     * @brief Returns the number of distinct strings, including the empty string.
+     */
+    int size() const;
+
+    /**
+     * @brief Returns the number of bytes reserved by the arena and the lookup table.
+     */
+    qsizetype memoryUsage() const;
+
+    #pragma endregion
+
+private:
+    /**
+     * @brief Location and hash of one interned string.
+     */
+    struct Entry {
+        const char16_t *data;   // Characters in the arena
+        quint32 length;         // Number of UTF-16 code units
+        quint32 hash;           // Cached hash for rehashing
+    };
+
+    /**
+     * @brief One block of arena memory.
+     */
+    struct Chunk {
+        std::unique_ptr<char16_t[]> data;
+        qsizetype capacity;
+    };
+
+    char16_t *allocate(qsizetype length);
+    void rehash(qsizetype bucketCount);
+
+    #pragma region Member Variables
+
+    std::vector<Chunk> chunks;      // Arena chunks
+    size_t currentChunk;            // Chunk currently being filled
+    qsizetype chunkUsed;            // Code units used in the current chunk
+    QVector<Entry> entries;         // ID -> string
+    QVector<quint32> buckets;       // Open addressing table: 0 = empty, otherwise ID + 1
+    quint64 currentGeneration;      // Unique generation ID
+
+    #pragma endregion
+};
+
+#endif // STRINGPOOL_H
@@ -0,0 +1,330 @@
+#include "titlewatch.h"
+#include <QFile>
+#include <QSet>
+#include <QTextStream>
+#include <algorithm>
+
+#pragma region Constructor and Destructor
+
+/**
+ * @brief Constructs a watch without patterns.
+ */
+TitleWatch::TitleWatch() : matchCount(0), scanCount(0), scannedTitles(0) {}
+
+/**
+ * @brief Destructor for TitleWatch.
+ */
+TitleWatch::~TitleWatch() {}
+
+#pragma endregion
+
+#pragma region Patterns
+
+/**
+ * @brief Folds the patterns to lower case, drops empty ones and duplicates and compiles the rest.
+ * @return The number of patterns compiled.
+ */
+int TitleWatch::setPatterns(const QStringList &patterns) {
+    this->patterns.clear();
+    QVector<QString> foldedPatterns;
+    QSet<QString> seen;
+
+    for (const QString &pattern : patterns) {
+        QString trimmed = pattern.trimmed();
+        QString folded;
+        folded.reserve(trimmed.size());
+        for (QChar c : trimmed) {
+            folded.append(QChar(fold(c.unicode())));
+        }
+        if (folded.isEmpty() || seen.contains(folded)) {
+            continue;
+        }
+        seen.insert(folded);
+        this->patterns.append(trimmed);
+        foldedPatterns.append(folded);
+    }
+
+    compile(foldedPatterns);
+    knownTitles.clear();    // Titles seen before were matched against other patterns
+    return this->patterns.size();
+}
+
+/**
+ * @brief Loads a pattern file, see the class documentation for the format.
+ * @return The number of patterns compiled, or -1 if the file cannot be opened.
+ */
+int TitleWatch::loadPatterns(const QString &path, std::function<void(const QString &)> logCallback) {
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        logCallback(QString("Cannot open title watch patterns: %1").arg(path));
+        return -1;
+    }
+
+    QStringList lines;
+    QTextStream stream(&file);
+    while (!stream.atEnd()) {
+        QString line = stream.readLine();
+        if (!line.trimmed().startsWith('#')) {
+            lines.append(line);
+        }
+    }
+
+    return setPatterns(lines);
+}
+
+/**
+ * @brief Removes all patterns and forgets the known titles.
+ */
+void TitleWatch::clear() {
+    setPatterns(QStringList());
+}
+
+/**
+ * @brief Returns a pattern by index.
+ */
+const QString &TitleWatch::pattern(int index) const {
+    return patterns[index];
+}
+
+/**
+ * @brief Returns the number of patterns.
+ */
+int TitleWatch::patternCount() const {
+    return patterns.size();
+}
+
+/**
+ * @brief Returns the number of automaton states.
+ */
+int TitleWatch::stateCount() const {
+    return failure.size();
+}
+
+// Case folding; ASCII, by far the most common in titles, skips the Unicode tables
+char16_t TitleWatch::fold(char16_t c) {
+    if (c < 128) {
+        return c >= 'A' && c <= 'Z' ? static_cast<char16_t>(c + ('a' - 'A')) : c;
+    }
+    return static_cast<char16_t>(QChar::toCaseFolded(c));
+}
+
+// Goto function: the target of the edge labelled c, or -1
+int TitleWatch::transition(int state, char16_t c) const {
+    if (state == 0 && c < 128) {
+        return rootAscii[c];
+    }
+
+    const char16_t *begin = edgeChars.constData() + edgeStart[state];
+    const char16_t *end = edgeChars.constData() + edgeStart[state + 1];
+    const char16_t *edge = end - begin <= 8 ? std::find(begin, end, c) : std::lower_bound(begin, end, c);
+    if (edge == end || *edge != c) {
+        return -1;
+    }
+    return edgeTargets[static_cast<int>(edge - edgeChars.constData())];
+}
+
+// Build the trie, flatten it into sorted edge arrays and add the failure and output links breadth first
+void TitleWatch::compile(const QVector<QString> &foldedPatterns) {
+    // Trie with unsorted child lists, only needed while building
+    QVector<QVector<std::pair<char16_t, int>>> children(1);
+    statePattern = QVector<int>(1, -1);
+    for (int index = 0; index < foldedPatterns.size(); ++index) {
+        int state = 0;
+        for (QChar qc : foldedPatterns[index]) {
+            char16_t c = qc.unicode();
+            int next = -1;
+            for (const std::pair<char16_t, int> &child : children[state]) {
+                if (child.first == c) {
+                    next = child.second;
+                    break;
+                }
+            }
+            if (next < 0) {
+                next = static_cast<int>(children.size());
+                children[state].append(std::make_pair(c, next));
+                children.append(QVector<std::pair<char16_t, int>>());
+                statePattern.append(-1);
+            }
+            state = next;
+        }
+        statePattern[state] = index;
+    }
+
+    const int states = static_cast<int>(children.size());
+    edgeStart = QVector<int>(states + 1, 0);
+    edgeChars.clear();
+    edgeTargets.clear();
+    edgeChars.reserve(states - 1);
+    edgeTargets.reserve(states - 1);
+    for (int state = 0; state < states; ++state) {
+        QVector<std::pair<char16_t, int>> &edges = children[state];
+        std::sort(edges.begin(), edges.end());
+        edgeStart[state] = static_cast<int>(edgeChars.size());
+        for (const std::pair<char16_t, int> &edge : edges) {
+            edgeChars.append(edge.first);
+            edgeTargets.append(edge.second);
+        }
+    }
+    edgeStart[states] = static_cast<int>(edgeChars.size());
+
+    rootAscii = QVector<int>(128, -1);
+    for (const std::pair<char16_t, int> &edge : children[0]) {
+        if (edge.first < 128) {
+            rootAscii[edge.first] = edge.second;
+        }
+    }
+
+    // Parents come before their children in breadth-first order, so their links are already known
+    failure = QVector<int>(states, 0);
+    outputLink = QVector<int>(states, -1);
+    QVector<int> queue;
+    queue.reserve(states);
+    queue.append(0);
+    for (int head = 0; head < queue.size(); ++head) {
+        int state = queue[head];
+        for (int edge = edgeStart[state]; edge < edgeStart[state + 1]; ++edge) {
+            char16_t c = edgeChars[edge];
+            int target = edgeTargets[edge];
+            queue.append(target);
+            if (state == 0) {
+                continue;   // Depth 1 falls back to the root
+            }
+
+            int fallback = failure[state];
+            int next;
+            while ((next = transition(fallback, c)) < 0 && fallback != 0) {
+                fallback = failure[fallback];
+            }
+            failure[target] = next < 0 ? 0 : next;
+            outputLink[target] = statePattern[failure[target]] >= 0 ? failure[target] : outputLink[failure[target]];
+        }
+    }
+
+    foundIn = QVector<quint32>(foldedPatterns.size(), 0);
+    matchCount = 0;
+}
+
+#pragma endregion
+
+#pragma region Matching
+
+/**
+ * @brief Runs the text through the automaton once; each character costs one transition plus the failure
+ *        links taken, which are bounded by the characters consumed before.
+ */
+int TitleWatch::match(QStringView text, QVector<int> &found) {
+    found.clear();
+    if (patterns.isEmpty()) {
+        return 0;
+    }
+    if (++matchCount == 0) {
+        foundIn.fill(0);    // The stamps wrapped around
+        matchCount = 1;
+    }
+
+    int state = 0;
+    for (QChar qc : text) {
+        char16_t c = fold(qc.unicode());
+        int next;
+        while ((next = transition(state, c)) < 0 && state != 0) {
+            state = failure[state];
+        }
+        state = next < 0 ? 0 : next;
+
+        int output = statePattern[state] >= 0 ? state : outputLink[state];
+        for (; output >= 0; output = outputLink[output]) {
+            int index = statePattern[output];
+            if (foundIn[index] != matchCount) {
+                foundIn[index] = matchCount;
+                found.append(index);
+            }
+        }
+    }
+    return static_cast<int>(found.size());
+}
+
+/**
+ * @brief Matches the main window titles of a snapshot; see scanWindow().
+ */
+QVector<TitleWatch::Match> TitleWatch::scan(const ProcessSnapshot &snapshot) {
+    beginScan();
+    const int count = snapshot.size();
+    for (int row = 0; row < count; ++row) {
+        HWND hWnd = snapshot.windowHandle(row);
+        if (hWnd != NULL) {
+            scanWindow(hWnd, snapshot.processId(row), snapshot.processName(row), snapshot.windowTitle(row));
+        }
+    }
+    return endScan();
+}
+
+/**
+ * @brief Starts a scan with no pending matches.
+ */
+void TitleWatch::beginScan() {
+    pendingMatches.clear();
+    scannedTitles = 0;
+    ++scanCount;
+}
+
+/**
+ * @brief Matches only the titles that differ from the previous scan; unchanged titles cost one comparison
+ *        and no allocation.
+ */
+bool TitleWatch::scanWindow(HWND hWnd, DWORD processId, QStringView processName, QStringView title) {
+    if (patterns.isEmpty()) {
+        return false;
+    }
+
+    auto known = knownTitles.find(hWnd);
+    if (known == knownTitles.end()) {
+        known = knownTitles.insert(hWnd, { title.toString(), scanCount });
+    } else {
+        known.value().seenAt = scanCount;
+        if (known.value().title == title) {
+            return false;
+        }
+        known.value().title = title.toString();
+    }
+
+    ++scannedTitles;
+    if (match(title, found) == 0) {
+        return false;
+    }
+    pendingMatches.append({ hWnd, processId, processName.toString(), known.value().title, found });
+    return true;
+}
+
+/**
+ * @brief Ends a scan and hands over its matches.
+ */
+QVector<TitleWatch::Match> TitleWatch::endScan() {
+    // Forget windows that closed or were not passed to this scan
+    for (auto it = knownTitles.begin(); it != knownTitles.end();) {
+        if (it.value().seenAt != scanCount) {
+            it = knownTitles.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    QVector<Match> matches;
+    matches.swap(pendingMatches);
+    return matches;
+}
+
+/**
+ * @brief Returns the number of titles matched by the last scan.
+ */
+int TitleWatch::lastScanCount() const {
+    return scannedTitles;
+}
+
+/**
+ * @brief Forgets the known titles.
+ */
+void TitleWatch::resetTitles() {
+    knownTitles.clear();
+}
+
+#pragma endregion
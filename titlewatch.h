@@ -0,0 +1,188 @@
+#ifndef TITLEWATCH_H
+#define TITLEWATCH_H
+
+#include <QString>
+#include <QStringList>
+#include <QStringView>
+#include <QVector>
+#include <QHash>
+#include <functional>
+#include "platform.h" // For the DWORD and HWND types
+#include "processsnapshot.h"
+
+/**
+ * @class TitleWatch
+ * @brief Watches window titles for any of a set of keywords.
+ *
+ * All patterns are compiled into one Aho-Corasick automaton, so a title is matched against every pattern
+ * in a single pass over its characters, no matter how many patterns there are. Matching ignores case.
+ *
+ * A scan remembers the last title seen for every window and only matches titles that are new or changed
+ * since the previous scan; a window keeping its title is reported once, not on every sample. scan() covers
+ * the main windows of a snapshot; beginScan(), scanWindow() and endScan() take any set of windows, such as
+ * every visible top-level window (see ProcessManager::scanWindowTitles()).
+ *
+ * Pattern file format, one pattern per line, matched anywhere in the title (lines starting with `#` are
+ * comments, leading and trailing spaces are ignored):
+ * @code
+ *   Not Responding
+ *   error
+ *   BUILD FAILED
+ * @endcode
+ */
+class TitleWatch {
+public:
+    /**
+     * @brief A window whose new title contains at least one pattern.
+     */
+    struct Match {
+        HWND hWnd;              // Window handle
+        DWORD processId;        // ID of the owning process
+        QString processName;    // Name of the owning process
+        QString title;          // The new title
+        QVector<int> patterns;  // Indices of the patterns found, each reported once
+    };
+
+    #pragma region Constructors and Destructor
+
+    /**
+     * @brief Creates a watch without patterns.
+     */
+    TitleWatch();
+
+    /**
+     * @brief Destructor for cleaning up the watch.
+     */
+    ~TitleWatch();
+
+    #pragma endregion
+
+    #pragma region Patterns
+
+    /**
+     * @brief Replaces all patterns and compiles them. Empty patterns and duplicates (ignoring case) are dropped.
+     * @param patterns The keywords to watch for.
+     * @return The number of patterns compiled.
+     */
+    int setPatterns(const QStringList &patterns);
+
+    /**
+     * @brief Replaces all patterns with the patterns of a pattern file.
+     * @param path Path to the pattern file.
+     * @param logCallback Callback function to handle logging messages.
+     * @return The number of patterns compiled, or -1 if the file could not be opened.
+     */
+    int loadPatterns(const QString &path, std::function<void(const QString &)> logCallback);
+
+    /**
+     * @brief Removes all patterns and forgets the known titles.
+     */
+    void clear();
+
+    /**
+     * @brief Returns a pattern.
+     * @param index The pattern index.
+     */
+    const QString &pattern(int index) const;
+
+    /**
+     * @brief Returns the number of patterns.
+     */
+    int patternCount() const;
+
+    /**
+     * @brief Returns the number of automaton states (a measure of its memory use).
+     */
+    int stateCount() const;
+
+    #pragma endregion
+
+    #pragma region Matching
+
+    /**
+     * @brief Finds the patterns contained in a text.
+     * @param text The text to search.
+     * @param found Receives the indices of the patterns found, each once, in order of their first end.
+     * @return The number of patterns found.
+     */
+    int match(QStringView text, QVector<int> &found);
+
+    /**
+     * @brief Matches the main window titles of a snapshot that changed since the previous scan.
+     *        Windows no longer in the snapshot are forgotten.
+     * @param snapshot The sampled snapshot.
+     * @return The windows whose new title contains a pattern, in snapshot order.
+     */
+    QVector<Match> scan(const ProcessSnapshot &snapshot);
+
+    /**
+     * @brief Starts a scan; pass every current window to scanWindow(), then call endScan().
+     */
+    void beginScan();
+
+    /**
+     * @brief Matches the title of one window if it is new or changed since the previous scan.
+     * @param hWnd Window handle.
+     * @param processId ID of the owning process.
+     * @param processName Name of the owning process.
+     * @param title The current title.
+     * @return True if the title changed and contains a pattern; the match is reported by endScan().
+     */
+    bool scanWindow(HWND hWnd, DWORD processId, QStringView processName, QStringView title);
+
+    /**
+     * @brief Ends a scan. Windows not passed to scanWindow() since beginScan() are forgotten.
+     * @return The windows whose new title contains a pattern, in scan order.
+     */
+    QVector<Match> endScan();
+
+    /**
+     * @brief Returns the number of titles matched by the last scan.
+     */
+    int lastScanCount() const;
+
+    /**
+     * @brief Forgets the known titles, so the next scan matches every title again.
+     */
+    void resetTitles();
+
+    #pragma endregion
+
+private:
+    /**
+     * @brief Title of a window at the last scan.
+     */
+    struct KnownTitle {
+        QString title;      // Last title
+        quint32 seenAt;     // Scan in which the window was last present
+    };
+
+    static char16_t fold(char16_t c);
+    int transition(int state, char16_t c) const;
+    void compile(const QVector<QString> &foldedPatterns);
+
+    #pragma region Member Variables
+
+    QStringList patterns;                   // Patterns as given, by index
+
+    // Automaton, state 0 is the root. The edges of a state lie in [edgeStart[s], edgeStart[s + 1]) sorted by character.
+    QVector<int> edgeStart;                 // First edge of each state (one extra entry at the end)
+    QVector<char16_t> edgeChars;            // Folded character of each edge
+    QVector<int> edgeTargets;               // Target state of each edge
+    QVector<int> rootAscii;                 // Root transitions for ASCII characters, or -1
+    QVector<int> failure;                   // Longest proper suffix of each state that is also a state
+    QVector<int> statePattern;              // Pattern ending at each state, or -1
+    QVector<int> outputLink;                // Nearest suffix state with a pattern, or -1
+
+    QVector<quint32> foundIn;               // Per pattern: last match() call that found it
+    quint32 matchCount;                     // Number of match() calls
+    QHash<HWND, KnownTitle> knownTitles;    // Last title of every window seen
+    quint32 scanCount;                      // Number of scans started
+    int scannedTitles;                      // Titles matched by the last scan
+    QVector<Match> pendingMatches;          // Matches of the running scan
+    QVector<int> found;                     // Patterns found in the last title matched, reused across windows
+
+    #pragma endregion
+};
+
+#endif // TITLEWATCH_H
@@ -0,0 +1,94 @@
+#include "animationbenchmark.h"
+#include <QEventLoop>
+#include <QHash>
+#include <QTimer>
+#include <QVector>
+#include "processmanager.h"
+#include "simulatedbackend.h"
+#include "windowanimator.h"
+
+#pragma region Constructor
+
+/**
+ * @brief Creates a benchmark with a seeded generator.
+ */
+AnimationBenchmark::AnimationBenchmark(const Options &options) : options(options), random(options.seed) {}
+
+#pragma endregion
+
+#pragma region Run
+
+/**
+ * @brief Animates every window once per round; the simulation does not churn, so every window stays alive.
+ */
+bool AnimationBenchmark::run(QTextStream &out) {
+    SimulatedBackend::Options backendOptions;
+    backendOptions.processCount = options.windows;
+    backendOptions.hiddenWindows = 0;
+    backendOptions.seed = options.seed;
+    SimulatedBackend backend(backendOptions);
+
+    WindowAnimator animator(&backend);
+    ProcessManager manager(&backend);
+    manager.setLogCallback([](const QString &) {});
+    manager.setAnimator(&animator);
+
+    QVector<DWORD> processIds;
+    backend.enumerateProcesses([&](const WindowBackend::ProcessEntry &entry) {
+        processIds.append(entry.processId);
+        return true;
+    });
+    out << QString("animate: %1 windows, %2 ms transitions, %3 rounds at %4 Hz")
+               .arg(processIds.size()).arg(options.durationMs).arg(options.rounds).arg(animator.frameRate())
+        << Qt::endl;
+
+    qint64 missed = 0;
+    bool finishedInTime = true;
+    for (int round = 0; round < options.rounds; ++round) {
+        QHash<DWORD, RECT> targets;
+        for (DWORD processId : processIds) {
+            RECT rect = { random.bounded(1920), random.bounded(1080), 0, 0 };
+            rect.right = rect.left + 200 + random.bounded(1200);
+            rect.bottom = rect.top + 150 + random.bounded(800);
+            targets.insert(processId, rect);
+            manager.AnimateProcessWindowGeometry(rect, options.durationMs, processId);
+        }
+
+        // Wait for the last frame, with room for late ticks and retried values
+        QEventLoop loop;
+        QObject::connect(&animator, &WindowAnimator::idle, &loop, &QEventLoop::quit);
+        QTimer::singleShot(options.durationMs * 4 + 1000, &loop, &QEventLoop::quit);
+        if (animator.activeCount() > 0) {
+            loop.exec();
+        }
+        if (animator.activeCount() > 0) {
+            finishedInTime = false;
+            animator.stopAll();
+        }
+
+        backend.enumerateWindows([&](HWND hWnd) {
+            RECT rect;
+            auto target = targets.constFind(backend.windowProcessId(hWnd));
+            if (target != targets.constEnd() && backend.isWindowVisible(hWnd) && backend.windowRect(hWnd, rect)
+                && (rect.left != target.value().left || rect.top != target.value().top
+                    || rect.right != target.value().right || rect.bottom != target.value().bottom)) {
+                ++missed;
+            }
+            return true;
+        });
+    }
+
+    WindowAnimator::FrameStats stats = animator.frameStatistics();
+    out << QString("frames: %1 applied, %2 dropped, interval avg %3 us max %4 us, apply avg %5 us max %6 us")
+               .arg(stats.frames).arg(stats.droppedFrames).arg(stats.averageFrameUs).arg(stats.maxFrameUs)
+               .arg(stats.averageApplyUs).arg(stats.maxApplyUs)
+        << Qt::endl;
+    out << QString("targets: %1 windows missed their target rectangle").arg(missed) << Qt::endl;
+
+    if (!finishedInTime) {
+        out << "TIMEOUT: the animator was still running after the transitions should have ended" << Qt::endl;
+    }
+    return finishedInTime && missed == 0;
+}
+
+#pragma endregion
@@ -0,0 +1,46 @@
+#ifndef ANIMATIONBENCHMARK_H
+#define ANIMATIONBENCHMARK_H
+
+#include <QTextStream>
+#include <QRandomGenerator>
+
+/**
+ * @class AnimationBenchmark
+ * @brief Measures WindowAnimator geometry transitions of many simulated windows.
+ *
+ * Every round starts ProcessManager::AnimateProcessWindowGeometry() on the main window of every
+ * simulated process, runs the event loop until the animator is idle and then checks that each window
+ * ended on its target rectangle. Reports the frame timing of the animator and the windows that missed
+ * their target.
+ */
+class AnimationBenchmark {
+public:
+    /**
+     * @brief Size of the generated workload.
+     */
+    struct Options {
+        int windows = 200;              // Simulated processes, one animated window each
+        int durationMs = 500;           // Duration of every transition
+        int rounds = 5;                 // Transitions per window
+        quint32 seed = 1;               // Seed of the simulation and the target rectangles
+    };
+
+    /**
+     * @brief Creates a benchmark.
+     * @param options Size of the generated workload.
+     */
+    explicit AnimationBenchmark(const Options &options);
+
+    /**
+     * @brief Runs all rounds and prints the results.
+     * @param out Report output.
+     * @return False if a window did not end on its target or the animator did not finish in time.
+     */
+    bool run(QTextStream &out);
+
+private:
+    Options options;            // Size of the generated workload
+    QRandomGenerator random;    // Generates the target rectangles
+};
+
+#endif // ANIMATIONBENCHMARK_H
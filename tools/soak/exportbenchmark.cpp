@@ -0,0 +1,194 @@
+#include "exportbenchmark.h"
+#include <QBuffer>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QtEndian>
+#include <chrono>
+
+namespace {
+
+qint64 steadyNanoseconds() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+const char *const processNames[] = {
+    "chrome.exe", "explorer.exe", "svchost.exe", "code.exe", "devenv.exe", "msedge.exe", "python.exe", "conhost.exe"
+};
+const int processNameCount = sizeof(processNames) / sizeof(processNames[0]);
+
+const char *formatName(SnapshotExporter::Format format) {
+    switch (format) {
+    case SnapshotExporter::Csv:       return "csv";
+    case SnapshotExporter::JsonLines: return "jsonl";
+    default:                          return "columnar";
+    }
+}
+
+} // namespace
+
+#pragma region Constructor
+
+/**
+ * @brief Creates a benchmark with a seeded generator.
+ */
+ExportBenchmark::ExportBenchmark(const Options &options) : options(options), random(options.seed) {}
+
+#pragma endregion
+
+#pragma region Run
+
+/**
+ * @brief Measures every format in full and diff mode.
+ */
+bool ExportBenchmark::run(QTextStream &out) {
+    if (!checkStrings(out)) {
+        return false;
+    }
+
+    fillSnapshot(full, 0);
+    fillSnapshot(changed, qMax(1, static_cast<int>(options.records * options.changedFraction)));
+    out << QString("export: %1 records, %2 rounds per measurement").arg(options.records).arg(options.rounds) << Qt::endl;
+
+    const SnapshotExporter::Format formats[] = { SnapshotExporter::Csv, SnapshotExporter::JsonLines, SnapshotExporter::Columnar };
+    for (SnapshotExporter::Format format : formats) {
+        if (!measure(out, format, SnapshotExporter::Full) || !measure(out, format, SnapshotExporter::Diff)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Write one row per format and decode its title the way a reader of that format would
+bool ExportBenchmark::checkStrings(QTextStream &out) {
+    const QString title = QString::fromUtf8("Say \"hi\" to C:\\temp \u00e9\U0001F600");
+    ProcessSnapshot snapshot;
+    snapshot.setCaptureTime(1000);
+    int row = snapshot.appendProcess(4, 0, QString("quote.exe"), 1);
+    snapshot.setWindowInfo(row, reinterpret_cast<HWND>(quintptr(1)), title, QString("Quote"), RECT { 0, 0, 100, 100 }, false, 255);
+
+    const SnapshotExporter::Format formats[] = { SnapshotExporter::Csv, SnapshotExporter::JsonLines, SnapshotExporter::Columnar };
+    for (SnapshotExporter::Format format : formats) {
+        QByteArray data;
+        QBuffer buffer(&data);
+        buffer.open(QIODevice::WriteOnly);
+        SnapshotExporter exporter;
+        exporter.setFormat(format);
+        exporter.setDevice(&buffer);
+        if (!exporter.write(snapshot) || !exporter.flush()) {
+            out << QString("%1: %2").arg(formatName(format), exporter.errorString()) << Qt::endl;
+            return false;
+        }
+
+        QString decoded;
+        if (format == SnapshotExporter::Csv) {
+            // The title is the last field of the record line
+            QByteArray line = data.split('\n').value(1);
+            int start = line.indexOf(",\"", line.indexOf("quote.exe") + 1);
+            if (start >= 0 && line.endsWith('"')) {
+                decoded = QString::fromUtf8(line.mid(start + 2, line.size() - start - 3)).replace("\"\"", "\"");
+            }
+        } else if (format == SnapshotExporter::JsonLines) {
+            decoded = QJsonDocument::fromJson(data.trimmed()).object().value("title").toString();
+        } else {
+            // Header, numeric columns and record kinds, then the name and title offset tables, each followed by its bytes
+            auto offset = [&data](qsizetype table, int index) {
+                return qsizetype(qFromLittleEndian<quint32>(data.constData() + table + index * qsizetype(sizeof(quint32))));
+            };
+            qsizetype names = 24 + ProcessSnapshot::ColumnCount * qsizetype(sizeof(qint64)) + 1;
+            if (data.size() >= names + 8) {
+                qsizetype titles = names + 8 + offset(names, 1);
+                if (data.size() >= titles + 8 && data.size() >= titles + 8 + offset(titles, 1)) {
+                    decoded = QString::fromUtf8(data.constData() + titles + 8, offset(titles, 1));
+                }
+            }
+        }
+
+        if (decoded != title) {
+            out << QString("MISMATCH: %1 wrote the title as \"%2\"").arg(formatName(format), decoded) << Qt::endl;
+            return false;
+        }
+    }
+    out << "strings: a quoted title round-trips in every format" << Qt::endl;
+    return true;
+}
+
+// Write into a reused in-memory buffer; diff mode writes the full snapshot first, only the diff is timed
+bool ExportBenchmark::measure(QTextStream &out, SnapshotExporter::Format format, SnapshotExporter::Mode mode) {
+    QByteArray data;
+    qint64 fastestNs = 0;
+    qint64 records = 0;
+    qint64 bytes = 0;
+
+    for (int round = 0; round < options.rounds; ++round) {
+        data.clear();
+        QBuffer buffer(&data);
+        buffer.open(QIODevice::WriteOnly);
+
+        SnapshotExporter exporter;
+        exporter.setFormat(format);
+        exporter.setMode(mode);
+        exporter.setDevice(&buffer);
+        if (mode == SnapshotExporter::Diff && !exporter.write(full)) {
+            out << QString("%1: %2").arg(formatName(format), exporter.errorString()) << Qt::endl;
+            return false;
+        }
+        qint64 recordsBefore = exporter.recordsWritten();
+        qint64 bytesBefore = exporter.bytesWritten();
+
+        qint64 start = steadyNanoseconds();
+        bool ok = exporter.write(mode == SnapshotExporter::Diff ? changed : full) && exporter.flush();
+        qint64 elapsed = steadyNanoseconds() - start;
+        if (!ok) {
+            out << QString("%1: %2").arg(formatName(format), exporter.errorString()) << Qt::endl;
+            return false;
+        }
+
+        if (round == 0 || elapsed < fastestNs) {
+            fastestNs = elapsed;
+        }
+        records = exporter.recordsWritten() - recordsBefore;
+        bytes = exporter.bytesWritten() - bytesBefore;
+    }
+
+    double seconds = qMax<qint64>(1, fastestNs) / 1e9;
+    out << QString("%1 %2: %3 records, %4 KB in %5 ms (%6 records/s, %7 MB/s)")
+               .arg(formatName(format), mode == SnapshotExporter::Diff ? "diff" : "full")
+               .arg(records).arg(bytes / 1024).arg(fastestNs / 1e6, 0, 'f', 2)
+               .arg(static_cast<qint64>(records / seconds)).arg(bytes / seconds / (1024.0 * 1024.0), 0, 'f', 1)
+        << Qt::endl;
+    return true;
+}
+
+#pragma endregion
+
+#pragma region Data
+
+// The same processes in both snapshots; changedRows of them get new resource usage
+void ExportBenchmark::fillSnapshot(ProcessSnapshot &snapshot, int changedRows) {
+    random.seed(options.seed);
+    snapshot.clear();
+    snapshot.reserve(options.records);
+    snapshot.setCaptureTime(changedRows > 0 ? 2000 : 1000);
+
+    const QString className("Chrome_WidgetWin_1");
+    for (int i = 0; i < options.records; ++i) {
+        DWORD processId = static_cast<DWORD>(4 * (i + 1));
+        QString name(processNames[random.bounded(processNameCount)]);
+        int row = snapshot.appendProcess(processId, 4, name, 1 + random.bounded(64));
+        snapshot.setResourceUsage(row, static_cast<qint64>(random.bounded(1 << 30)), random.bounded(1000000));
+
+        RECT rect = { random.bounded(1920), random.bounded(1080), 0, 0 };
+        rect.right = rect.left + 200 + random.bounded(1200);
+        rect.bottom = rect.top + 150 + random.bounded(800);
+        QString title = QString("%1 - Window %2").arg(name).arg(i);
+        HWND hWnd = reinterpret_cast<HWND>(static_cast<quintptr>(i) + 1);
+        snapshot.setWindowInfo(row, hWnd, title, className, rect, false, 255);
+    }
+
+    // Change the first rows after generating all of them, so both snapshots share the same random sequence
+    for (int row = 0; row < changedRows && row < options.records; ++row) {
+        snapshot.setResourceUsage(row, static_cast<qint64>(row) * 4096, 1000000 + row);
+    }
+}
+
+#pragma endregion
@@ -0,0 +1,54 @@
+#ifndef EXPORTBENCHMARK_H
+#define EXPORTBENCHMARK_H
+
+#include <QTextStream>
+#include <QRandomGenerator>
+#include "processsnapshot.h"
+#include "snapshotexporter.h"
+
+/**
+ * @class ExportBenchmark
+ * @brief Measures SnapshotExporter on a generated snapshot.
+ *
+ * For CSV, JSON Lines and the columnar format, writes the full snapshot and a diff against a copy
+ * where a fraction of the rows changed into memory, and reports time, records per second, output
+ * size and throughput. Writing into memory keeps disk speed out of the numbers. Before measuring, a title
+ * with quotes, a backslash and non-ASCII characters is written in every format and read back.
+ */
+class ExportBenchmark {
+public:
+    /**
+     * @brief Size of the generated data.
+     */
+    struct Options {
+        int records = 100000;           // Processes in the snapshot
+        double changedFraction = 0.01;  // Rows changed between the full and the diff snapshot
+        int rounds = 5;                 // Repetitions per format, the fastest is reported
+        quint32 seed = 1;               // Seed of the generated data
+    };
+
+    /**
+     * @brief Creates a benchmark.
+     * @param options Size of the generated data.
+     */
+    explicit ExportBenchmark(const Options &options);
+
+    /**
+     * @brief Checks that strings round-trip, generates the snapshots, runs all measurements and prints the results.
+     * @param out Report output.
+     * @return False if a string did not round-trip or an export failed.
+     */
+    bool run(QTextStream &out);
+
+private:
+    bool checkStrings(QTextStream &out);
+    void fillSnapshot(ProcessSnapshot &snapshot, int changedRows);
+    bool measure(QTextStream &out, SnapshotExporter::Format format, SnapshotExporter::Mode mode);
+
+    Options options;            // Size of the generated data
+    QRandomGenerator random;    // Generates the rows
+    ProcessSnapshot full;       // Snapshot written in full
+    ProcessSnapshot changed;    // Same processes with some rows changed, written as a diff
+};
+
+#endif // EXPORTBENCHMARK_H
@@ -0,0 +1,71 @@
+#include "latencyhistogram.h"
+#include <QtAlgorithms>
+#include <algorithm>
+#include <cstring>
+
+// Constructor
+LatencyHistogram::LatencyHistogram() {
+    reset();
+}
+
+// Values below 32 map linearly; above, the top 6 significant bits select the bucket
+int LatencyHistogram::bucketIndex(quint64 value) {
+    if (value < static_cast<quint64>(subBucketCount)) {
+        return static_cast<int>(value);
+    }
+    int magnitude = 63 - static_cast<int>(qCountLeadingZeroBits(value));    // Highest set bit, >= subBucketBits
+    int shift = magnitude - subBucketBits;
+    int subBucket = static_cast<int>(value >> shift) - subBucketCount;
+    return (shift + 1) * subBucketCount + subBucket;
+}
+
+// Largest value that maps to a bucket
+qint64 LatencyHistogram::bucketUpperBound(int index) {
+    if (index < subBucketCount) {
+        return index;
+    }
+    int shift = index / subBucketCount - 1;
+    quint64 subBucket = static_cast<quint64>(index % subBucketCount + subBucketCount);
+    return static_cast<qint64>(((subBucket + 1) << shift) - 1);
+}
+
+// Record a sample
+void LatencyHistogram::record(qint64 nanoseconds) {
+    quint64 value = nanoseconds > 0 ? static_cast<quint64>(nanoseconds) : 0;
+    ++buckets[bucketIndex(value)];
+    ++samples;
+    largest = std::max(largest, static_cast<qint64>(value));
+}
+
+// Add the samples of another histogram
+void LatencyHistogram::merge(const LatencyHistogram &other) {
+    for (int i = 0; i < bucketCount; ++i) {
+        buckets[i] += other.buckets[i];
+    }
+    samples += other.samples;
+    largest = std::max(largest, other.largest);
+}
+
+// Remove all samples
+void LatencyHistogram::reset() {
+    std::memset(buckets, 0, sizeof(buckets));
+    samples = 0;
+    largest = 0;
+}
+
+// Walk the buckets until the requested rank is reached
+qint64 LatencyHistogram::percentile(double fraction) const {
+    if (samples == 0) {
+        return 0;
+    }
+
+    qint64 rank = std::max<qint64>(1, static_cast<qint64>(fraction * static_cast<double>(samples) + 0.5));
+    qint64 seen = 0;
+    for (int i = 0; i < bucketCount; ++i) {
+        seen += buckets[i];
+        if (seen >= rank) {
+            return std::min(bucketUpperBound(i), largest);
+        }
+    }
+    return largest;
+}
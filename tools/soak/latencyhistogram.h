@@ -0,0 +1,66 @@
+#ifndef LATENCYHISTOGRAM_H
+#define LATENCYHISTOGRAM_H
+
+#include <QtGlobal>
+
+/**
+ * @class LatencyHistogram
+ * @brief Fixed-size log-linear histogram of latencies in nanoseconds.
+ *
+ * Every power-of-two range is split into 32 linear sub-buckets, so percentiles are accurate to about 3%
+ * regardless of how many samples an hours-long run records, and memory use never grows.
+ */
+class LatencyHistogram {
+public:
+    LatencyHistogram();     // Constructor
+
+    /**
+     * @brief Records one latency.
+     * @param nanoseconds The latency; negative values are recorded as 0.
+     */
+    void record(qint64 nanoseconds);
+
+    /**
+     * @brief Adds all samples of another histogram.
+     */
+    void merge(const LatencyHistogram &other);
+
+    /**
+     * @brief Removes all samples.
+     */
+    void reset();
+
+    /**
+     * @brief Returns the latency below which the given fraction of samples lies (upper bucket bound).
+     * @param fraction A value between 0 and 1, e.g. 0.999 for p999.
+     */
+    qint64 percentile(double fraction) const;
+
+    /**
+     * @brief Returns the number of samples.
+     */
+    qint64 count() const { return samples; }
+
+    /**
+     * @brief Returns the largest recorded latency.
+     */
+    qint64 maximum() const { return largest; }
+
+private:
+    static const int subBucketBits = 5;                             // 32 sub-buckets per power of two
+    static const int subBucketCount = 1 << subBucketBits;
+    static const int bucketCount = (64 - subBucketBits + 1) * subBucketCount;
+
+    static int bucketIndex(quint64 value);
+    static qint64 bucketUpperBound(int index);
+
+    #pragma region Member Variables
+
+    qint64 buckets[bucketCount];    // Sample counts
+    qint64 samples;                 // Total number of samples
+    qint64 largest;                 // Largest sample
+
+    #pragma endregion
+};
+
+#endif // LATENCYHISTOGRAM_H
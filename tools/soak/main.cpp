@@ -0,0 +1,102 @@
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QTextStream>
+#include <QThread>
+#include "animationbenchmark.h"
+#include "exportbenchmark.h"
+#include "simulatedbackend.h"
+#include "soakrunner.h"
+#include "titlewatchbenchmark.h"
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("cwin-soak");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Drives ProcessManager from several threads against a simulated process and window "
+                                     "table and reports throughput, tail latency, memory growth and wrong-target hits.");
+    parser.addHelpOption();
+
+    QCommandLineOption threadsOption("threads", "Worker threads.", "n", QString::number(QThread::idealThreadCount()));
+    QCommandLineOption durationOption("duration", "Run length in seconds.", "seconds", "60");
+    QCommandLineOption intervalOption("report-interval", "Seconds between report lines.", "seconds", "10");
+    QCommandLineOption processesOption("processes", "Simulated processes.", "n", "200");
+    QCommandLineOption pidSpaceOption("pid-space", "Process IDs are drawn below this value (smaller = more reuse).", "n", "4096");
+    QCommandLineOption hiddenOption("hidden-windows", "Invisible windows per process.", "n", "1");
+    QCommandLineOption churnOption("churn", "Processes replaced per second.", "rate", "50");
+    QCommandLineOption changesOption("changes", "Window property changes per second.", "rate", "2000");
+    QCommandLineOption seedOption("seed", "Random seed.", "n", "1");
+    QCommandLineOption titleWatchOption("title-watch", "Benchmark the title watch instead of running the soak test.");
+    QCommandLineOption patternsOption("patterns", "Title watch patterns.", "n", "1000");
+    QCommandLineOption titlesOption("titles", "Window titles scanned by the title watch.", "n", "10000");
+    QCommandLineOption exportOption("export", "Benchmark the snapshot export formats instead of running the soak test.");
+    QCommandLineOption recordsOption("records", "Processes in the exported snapshot.", "n", "100000");
+    QCommandLineOption animateOption("animate", "Benchmark window geometry animations instead of running the soak test.");
+    QCommandLineOption transitionOption("transition", "Duration of each animated transition in milliseconds.", "ms", "500");
+    parser.addOptions({ threadsOption, durationOption, intervalOption, processesOption, pidSpaceOption,
+                        hiddenOption, churnOption, changesOption, seedOption, titleWatchOption, patternsOption,
+                        titlesOption, exportOption, recordsOption, animateOption, transitionOption });
+    parser.process(app);
+
+    if (parser.isSet(animateOption)) {
+        AnimationBenchmark::Options benchmarkOptions;
+        benchmarkOptions.windows = qMax(1, parser.value(processesOption).toInt());
+        benchmarkOptions.durationMs = qMax(0, parser.value(transitionOption).toInt());
+        benchmarkOptions.seed = parser.value(seedOption).toUInt();
+
+        QTextStream out(stdout);
+        AnimationBenchmark benchmark(benchmarkOptions);
+        return benchmark.run(out) ? 0 : 1;
+    }
+
+    if (parser.isSet(exportOption)) {
+        ExportBenchmark::Options benchmarkOptions;
+        benchmarkOptions.records = qMax(1, parser.value(recordsOption).toInt());
+        benchmarkOptions.seed = parser.value(seedOption).toUInt();
+
+        QTextStream out(stdout);
+        ExportBenchmark benchmark(benchmarkOptions);
+        return benchmark.run(out) ? 0 : 1;
+    }
+
+    if (parser.isSet(titleWatchOption)) {
+        TitleWatchBenchmark::Options benchmarkOptions;
+        benchmarkOptions.patterns = qMax(1, parser.value(patternsOption).toInt());
+        benchmarkOptions.titles = qMax(1, parser.value(titlesOption).toInt());
+        benchmarkOptions.seed = parser.value(seedOption).toUInt();
+
+        QTextStream out(stdout);
+        TitleWatchBenchmark benchmark(benchmarkOptions);
+        return benchmark.run(out) ? 0 : 1;
+    }
+
+    SimulatedBackend::Options backendOptions;
+    backendOptions.processCount = parser.value(processesOption).toInt();
+    backendOptions.processIdSpace = parser.value(pidSpaceOption).toInt();
+    backendOptions.hiddenWindows = parser.value(hiddenOption).toInt();
+    backendOptions.seed = parser.value(seedOption).toUInt();
+
+    SoakRunner::Options runOptions;
+    runOptions.threads = qMax(1, parser.value(threadsOption).toInt());
+    runOptions.durationMs = parser.value(durationOption).toLongLong() * 1000;
+    runOptions.reportIntervalMs = qMax(1LL, parser.value(intervalOption).toLongLong()) * 1000;
+    runOptions.churnPerSecond = parser.value(churnOption).toDouble();
+    runOptions.changesPerSecond = parser.value(changesOption).toDouble();
+    runOptions.seed = backendOptions.seed;
+
+    QTextStream out(stdout);
+    out << QString("cwin-soak: %1 threads, %2 s, %3 processes (pid space %4), %5 churn/s, %6 changes/s")
+               .arg(runOptions.threads)
+               .arg(runOptions.durationMs / 1000)
+               .arg(backendOptions.processCount)
+               .arg(backendOptions.processIdSpace)
+               .arg(runOptions.churnPerSecond)
+               .arg(runOptions.changesPerSecond)
+        << Qt::endl;
+
+    SimulatedBackend backend(backendOptions);
+    SoakRunner runner(backend, runOptions);
+    qint64 wrongTargets = runner.run(out);
+    return wrongTargets > 0 ? 1 : 0;   // Scripts fail a run that changed the wrong process
+}
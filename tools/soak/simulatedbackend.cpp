@@ -0,0 +1,661 @@
+#include "simulatedbackend.h"
+#include <QReadLocker>
+#include <QWriteLocker>
+#include <QElapsedTimer>
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <vector>
+
+namespace {
+
+const char *const classNames[] = { "Chrome_WidgetWin_1", "Notepad", "CabinetWClass", "ConsoleWindowClass", "SimWindow" };
+const int classNameCount = sizeof(classNames) / sizeof(classNames[0]);
+
+// The last successful change made by each thread, read back by the harness
+thread_local bool hasLastChange = false;
+thread_local SimulatedBackend::ProcessIdentity lastChange;
+
+qint64 steadyMilliseconds() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+int copyString(const QString &text, char16_t *buffer, int capacity) {
+    if (capacity <= 0) {
+        return 0;
+    }
+    int length = std::min(static_cast<int>(text.size()), capacity - 1);
+    std::memcpy(buffer, text.utf16(), static_cast<size_t>(length) * sizeof(char16_t));
+    buffer[length] = 0;
+    return length;
+}
+
+} // namespace
+
+#pragma region Constructor and Destructor
+
+/**
+ * @brief Creates the initial process table.
+ */
+SimulatedBackend::SimulatedBackend(const Options &options)
+    : options(options), random(options.seed), nextSerial(1), windowGeneration(0), startTime(steadyMilliseconds()) {
+    QWriteLocker locker(&lock);
+    for (int i = 0; i < options.processCount; ++i) {
+        spawnProcess();
+    }
+}
+
+/**
+ * @brief Destructor for SimulatedBackend.
+ */
+SimulatedBackend::~SimulatedBackend() {}
+
+#pragma endregion
+
+#pragma region Processes
+
+/**
+ * @brief Copies the process list under the lock and reports it unlocked.
+ */
+bool SimulatedBackend::enumerateProcesses(const std::function<bool(const ProcessEntry &)> &callback) {
+    struct Entry {
+        DWORD processId;
+        DWORD parentProcessId;
+        int nameIndex;
+        int threadCount;
+    };
+    thread_local std::vector<Entry> entries;
+    entries.clear();
+
+    {
+        QReadLocker locker(&lock);
+        for (DWORD processId : processIds) {
+            const Process &process = processes.constFind(processId).value();
+            entries.push_back({ processId, process.parentProcessId, process.nameIndex, process.threadCount });
+        }
+    }
+
+    const QVector<QString> &names = executableNames();
+    for (const Entry &entry : entries) {
+        if (!callback({ entry.processId, entry.parentProcessId, QStringView(names[entry.nameIndex]), entry.threadCount })) {
+            break;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Reads the simulated working set and CPU time.
+ */
+bool SimulatedBackend::queryResourceUsage(DWORD processId, qint64 &workingSet, qint64 &cpuTime, qint64 &creationTime) {
+    QReadLocker locker(&lock);
+    auto it = processes.constFind(processId);
+    if (it == processes.constEnd()) {
+        return false;
+    }
+    workingSet = it.value().workingSet;
+    cpuTime = it.value().cpuTime;
+    creationTime = static_cast<qint64>(it.value().serial);
+    return true;
+}
+
+/**
+ * @brief Removes a process and its windows.
+ */
+bool SimulatedBackend::terminateProcess(DWORD processId) {
+    QWriteLocker locker(&lock);
+    auto it = processes.constFind(processId);
+    if (it == processes.constEnd()) {
+        return false;
+    }
+    recordChange(processId, it.value().serial);
+    exitProcess(processId);
+    return true;
+}
+
+/**
+ * @brief The serial number stands in for the creation time; it is never reused.
+ */
+qint64 SimulatedBackend::processCreationTime(DWORD processId) {
+    QReadLocker locker(&lock);
+    auto it = processes.constFind(processId);
+    return it != processes.constEnd() ? static_cast<qint64>(it.value().serial) : 0;
+}
+
+#pragma endregion
+
+#pragma region Window Queries
+
+/**
+ * @brief Copies the z-order under the lock and reports it unlocked.
+ */
+void SimulatedBackend::enumerateWindows(const std::function<bool(HWND)> &callback) {
+    thread_local std::vector<HWND> handles;
+    handles.clear();
+
+    {
+        QReadLocker locker(&lock);
+        for (int slot : zOrder) {
+            handles.push_back(handleOf(slot));
+        }
+    }
+
+    for (HWND hWnd : handles) {
+        if (!callback(hWnd)) {
+            break;
+        }
+    }
+}
+
+/**
+ * @brief Simulated windows are all top-level and have no children.
+ */
+void SimulatedBackend::enumerateChildWindows(HWND, const std::function<bool(HWND)> &) {}
+
+/**
+ * @brief Simulated windows are all top-level.
+ */
+HWND SimulatedBackend::parentWindow(HWND) {
+    return NULL;
+}
+
+/**
+ * @brief Returns the owner of a window, or 0 if the handle is stale.
+ */
+DWORD SimulatedBackend::windowProcessId(HWND hWnd) {
+    QReadLocker locker(&lock);
+    Window *window = findWindow(hWnd);
+    return window ? window->processId : 0;
+}
+
+/**
+ * @brief Returns the visibility of a window.
+ */
+bool SimulatedBackend::isWindowVisible(HWND hWnd) {
+    QReadLocker locker(&lock);
+    Window *window = findWindow(hWnd);
+    return window && window->visible;
+}
+
+/**
+ * @brief Copies the window title.
+ */
+int SimulatedBackend::windowTitle(HWND hWnd, char16_t *buffer, int capacity) {
+    QReadLocker locker(&lock);
+    Window *window = findWindow(hWnd);
+    return window ? copyString(window->title, buffer, capacity) : 0;
+}
+
+/**
+ * @brief Copies the window class name.
+ */
+int SimulatedBackend::windowClass(HWND hWnd, char16_t *buffer, int capacity) {
+    QReadLocker locker(&lock);
+    Window *window = findWindow(hWnd);
+    return window ? copyString(QString::fromLatin1(classNames[window->classIndex]), buffer, capacity) : 0;
+}
+
+/**
+ * @brief Reads the window rectangle.
+ */
+bool SimulatedBackend::windowRect(HWND hWnd, RECT &rect) {
+    QReadLocker locker(&lock);
+    Window *window = findWindow(hWnd);
+    if (!window) {
+        return false;
+    }
+    rect = window->rect;
+    return true;
+}
+
+/**
+ * @brief Simulated windows have no invisible borders; the frame is the window rectangle.
+ */
+bool SimulatedBackend::windowFrameRect(HWND hWnd, RECT &rect) {
+    return windowRect(hWnd, rect);
+}
+
+/**
+ * @brief Returns the TopMost flag.
+ */
+bool SimulatedBackend::isTopMost(HWND hWnd) {
+    QReadLocker locker(&lock);
+    Window *window = findWindow(hWnd);
+    return window && window->topMost;
+}
+
+/**
+ * @brief Reads the opacity of layered windows.
+ */
+bool SimulatedBackend::windowOpacity(HWND hWnd, int &opacity) {
+    QReadLocker locker(&lock);
+    Window *window = findWindow(hWnd);
+    if (!window || !window->layered) {
+        return false;
+    }
+    opacity = window->opacity;
+    return true;
+}
+
+/**
+ * @brief Returns the minimized state.
+ */
+bool SimulatedBackend::isMinimized(HWND hWnd) {
+    QReadLocker locker(&lock);
+    Window *window = findWindow(hWnd);
+    return window && window->minimized;
+}
+
+/**
+ * @brief The simulation has no virtual desktops; no window is cloaked.
+ */
+bool SimulatedBackend::isCloaked(HWND hWnd) {
+    return false;
+}
+
+/**
+ * @brief Checks all windows whenever the table changed; the simulation has no per-window events.
+ */
+HWND SimulatedBackend::waitForWindow(const std::function<bool(HWND)> &match, int timeoutMs, const std::atomic<bool> *cancelled) {
+    QElapsedTimer elapsed;
+    elapsed.start();
+
+    for (;;) {
+        quint64 generation;
+        {
+            QReadLocker locker(&lock);
+            generation = windowGeneration;
+        }
+
+        HWND found = NULL;
+        enumerateWindows([&](HWND hWnd) {
+            if (match(hWnd)) {
+                found = hWnd;
+                return false;
+            }
+            return true;
+        });
+        if (found != NULL) {
+            return found;
+        }
+
+        QReadLocker locker(&lock);
+        while (windowGeneration == generation) {
+            qint64 remaining = timeoutMs - elapsed.elapsed();
+            if (remaining <= 0 || (cancelled && cancelled->load())) {
+                return NULL;
+            }
+            windowsChanged.wait(&lock, static_cast<unsigned long>(qMin<qint64>(remaining, 100)));
+        }
+    }
+}
+
+/**
+ * @brief Not supported: the simulation has no per-window events, so callers re-read the whole layout.
+ */
+bool SimulatedBackend::watchWindowLayout(const std::function<void(HWND)> &changed) {
+    return false;
+}
+
+#pragma endregion
+
+#pragma region Window Changes
+
+/**
+ * @brief Changes the title.
+ */
+bool SimulatedBackend::setWindowTitle(HWND hWnd, const QString &title) {
+    QWriteLocker locker(&lock);
+    Window *window = findWindow(hWnd);
+    if (!window) {
+        return false;
+    }
+    window->title = title;
+    recordChange(window->processId, window->serial);
+    notifyWindowsChanged();
+    return true;
+}
+
+/**
+ * @brief Changes the TopMost flag; TopMost windows move to the front.
+ */
+bool SimulatedBackend::setTopMost(HWND hWnd, bool topMost) {
+    QWriteLocker locker(&lock);
+    Window *window = findWindow(hWnd);
+    if (!window) {
+        return false;
+    }
+    window->topMost = topMost;
+    raiseWindow(static_cast<int>(reinterpret_cast<quintptr>(hWnd) - 1));
+    recordChange(window->processId, window->serial);
+    return true;
+}
+
+/**
+ * @brief Changes the size.
+ */
+bool SimulatedBackend::resizeWindow(HWND hWnd, int width, int height) {
+    QWriteLocker locker(&lock);
+    Window *window = findWindow(hWnd);
+    if (!window) {
+        return false;
+    }
+    window->rect.right = window->rect.left + width;
+    window->rect.bottom = window->rect.top + height;
+    recordChange(window->processId, window->serial);
+    return true;
+}
+
+/**
+ * @brief Moves and resizes several windows under one lock.
+ */
+bool SimulatedBackend::setWindowGeometries(const QVector<GeometryUpdate> &updates) {
+    QWriteLocker locker(&lock);
+    bool positioned = true;
+    for (const GeometryUpdate &update : updates) {
+        Window *window = findWindow(update.hWnd);
+        if (!window) {
+            positioned = false;
+            continue;
+        }
+        window->rect = update.rect;
+        recordChange(window->processId, window->serial);
+    }
+    return positioned;
+}
+
+/**
+ * @brief Makes the window layered and changes its opacity.
+ */
+bool SimulatedBackend::setWindowOpacity(HWND hWnd, int opacity) {
+    QWriteLocker locker(&lock);
+    Window *window = findWindow(hWnd);
+    if (!window) {
+        return false;
+    }
+    window->layered = true;
+    window->opacity = std::clamp(opacity, 0, 255);
+    recordChange(window->processId, window->serial);
+    return true;
+}
+
+/**
+ * @brief Changes the minimized state.
+ */
+bool SimulatedBackend::showWindow(HWND hWnd, ShowCommand command) {
+    QWriteLocker locker(&lock);
+    Window *window = findWindow(hWnd);
+    if (!window) {
+        return false;
+    }
+    window->minimized = command == ShowMinimized;
+    window->visible = true;
+    recordChange(window->processId, window->serial);
+    notifyWindowsChanged();
+    return true;
+}
+
+/**
+ * @brief Moves the window to the front of its z-order band.
+ */
+bool SimulatedBackend::focusWindow(HWND hWnd) {
+    QWriteLocker locker(&lock);
+    Window *window = findWindow(hWnd);
+    if (!window) {
+        return false;
+    }
+    raiseWindow(static_cast<int>(reinterpret_cast<quintptr>(hWnd) - 1));
+    recordChange(window->processId, window->serial);
+    return true;
+}
+
+/**
+ * @brief Milliseconds since the backend was created.
+ */
+qint64 SimulatedBackend::tickCount() {
+    return steadyMilliseconds() - startTime;
+}
+
+#pragma endregion
+
+#pragma region Simulation
+
+/**
+ * @brief Replaces random processes and tops the table up to the configured size.
+ */
+void SimulatedBackend::churnProcesses(int count) {
+    QWriteLocker locker(&lock);
+    for (int i = 0; i < count && !processIds.isEmpty(); ++i) {
+        exitProcess(processIds[random.bounded(static_cast<int>(processIds.size()))]);
+        spawnProcess();
+    }
+    for (int attempts = 0; processIds.size() < options.processCount && attempts < options.processCount; ++attempts) {
+        spawnProcess();
+    }
+    notifyWindowsChanged();
+}
+
+/**
+ * @brief Applies random title, position, visibility and state changes; a few windows are recreated,
+ *        which hands their handle to the next window created.
+ */
+void SimulatedBackend::changeWindowProperties(int count) {
+    QWriteLocker locker(&lock);
+    const QVector<QString> &names = executableNames();
+
+    for (int i = 0; i < count && !zOrder.isEmpty(); ++i) {
+        int slot = zOrder[random.bounded(static_cast<int>(zOrder.size()))];
+        Window &window = windows[slot];
+        auto owner = processes.find(window.processId);
+        if (owner == processes.end()) {
+            continue;
+        }
+        owner.value().cpuTime += random.bounded(50);
+
+        int roll = random.bounded(100);
+        if (roll < 60) {
+            window.title = QString("%1 - Document %2").arg(names[owner.value().nameIndex]).arg(random.bounded(100000));
+        } else if (roll < 85) {
+            int dx = random.bounded(41) - 20;
+            int dy = random.bounded(41) - 20;
+            window.rect.left += dx;
+            window.rect.right += dx;
+            window.rect.top += dy;
+            window.rect.bottom += dy;
+        } else if (roll < 90) {
+            window.visible = !window.visible;
+        } else if (roll < 95) {
+            window.minimized = !window.minimized;
+        } else {
+            bool visible = window.visible;
+            destroyWindow(slot);
+            int newSlot = createWindow(owner.key(), owner.value(), visible);
+            QVector<int> &ownedWindows = owner.value().windows;
+            ownedWindows[ownedWindows.indexOf(slot)] = newSlot;
+        }
+    }
+    notifyWindowsChanged();
+}
+
+/**
+ * @brief Picks a random live process.
+ */
+bool SimulatedBackend::sampleProcess(QRandomGenerator &generator, ProcessIdentity &identity) {
+    QReadLocker locker(&lock);
+    if (processIds.isEmpty()) {
+        return false;
+    }
+    DWORD processId = processIds[generator.bounded(static_cast<int>(processIds.size()))];
+    const Process &process = processes.constFind(processId).value();
+    identity.processId = processId;
+    identity.serial = process.serial;
+    identity.nameIndex = process.nameIndex;
+    return true;
+}
+
+/**
+ * @brief Returns the executable names; built once and never modified, so views stay valid.
+ */
+const QVector<QString> &SimulatedBackend::executableNames() {
+    static const QVector<QString> names = {
+        "chrome.exe", "firefox.exe", "explorer.exe", "notepad.exe", "code.exe", "svchost.exe",
+        "Teams.exe", "slack.exe", "spotify.exe", "WINWORD.EXE", "EXCEL.EXE", "cmd.exe",
+        "powershell.exe", "WindowsTerminal.exe", "devenv.exe", "qtcreator.exe", "steam.exe", "discord.exe",
+        "obs64.exe", "vlc.exe", "Taskmgr.exe", "mspaint.exe", "OUTLOOK.EXE", "zoom.exe"
+    };
+    return names;
+}
+
+/**
+ * @brief Returns and clears the last change of the calling thread.
+ */
+bool SimulatedBackend::takeLastChange(ProcessIdentity &identity) {
+    if (!hasLastChange) {
+        return false;
+    }
+    identity = lastChange;
+    hasLastChange = false;
+    return true;
+}
+
+/**
+ * @brief Returns the number of live processes and windows.
+ */
+void SimulatedBackend::counts(int &processCount, int &windowCount) {
+    QReadLocker locker(&lock);
+    processCount = static_cast<int>(processIds.size());
+    windowCount = static_cast<int>(zOrder.size());
+}
+
+#pragma endregion
+
+#pragma region Helpers
+
+// Resolve a handle to a live window (caller holds the lock)
+SimulatedBackend::Window *SimulatedBackend::findWindow(HWND hWnd) {
+    quintptr value = reinterpret_cast<quintptr>(hWnd);
+    if (value == 0 || value > static_cast<quintptr>(windows.size())) {
+        return nullptr;
+    }
+    Window &window = windows[static_cast<int>(value - 1)];
+    return window.alive ? &window : nullptr;
+}
+
+// Remember which process a change was applied to
+void SimulatedBackend::recordChange(DWORD processId, quint64 serial) {
+    hasLastChange = true;
+    lastChange.processId = processId;
+    lastChange.serial = serial;
+    auto it = processes.constFind(processId);
+    lastChange.nameIndex = it != processes.constEnd() ? it.value().nameIndex : 0;
+}
+
+// Wake the threads in waitForWindow(); called under the write lock
+void SimulatedBackend::notifyWindowsChanged() {
+    ++windowGeneration;
+    windowsChanged.wakeAll();
+}
+
+// Start a process on a free (possibly recently used) ID with a main window and hidden windows
+void SimulatedBackend::spawnProcess() {
+    const int idSlots = std::max(2, options.processIdSpace / 4);
+    DWORD processId = 0;
+    for (int attempt = 0; attempt < 64; ++attempt) {
+        DWORD candidate = static_cast<DWORD>(random.bounded(1, idSlots)) * 4;
+        if (!processes.contains(candidate)) {
+            processId = candidate;
+            break;
+        }
+    }
+    if (processId == 0) {
+        return;     // ID space exhausted
+    }
+
+    Process process;
+    process.serial = nextSerial++;
+    process.nameIndex = random.bounded(static_cast<int>(executableNames().size()));
+    process.parentProcessId = processIds.isEmpty() ? 4 : processIds[random.bounded(static_cast<int>(processIds.size()))];
+    process.threadCount = 1 + random.bounded(64);
+    process.workingSet = (1 + random.bounded(1024)) * qint64(1024 * 1024);
+    process.cpuTime = 0;
+    process.listIndex = static_cast<int>(processIds.size());
+
+    Process &stored = processes.insert(processId, process).value();
+    processIds.append(processId);
+
+    stored.windows.append(createWindow(processId, stored, true));
+    for (int i = 0; i < options.hiddenWindows; ++i) {
+        stored.windows.append(createWindow(processId, stored, false));
+    }
+}
+
+// Remove a process and its windows
+void SimulatedBackend::exitProcess(DWORD processId) {
+    auto it = processes.find(processId);
+    if (it == processes.end()) {
+        return;
+    }
+
+    for (int slot : it.value().windows) {
+        destroyWindow(slot);
+    }
+
+    int index = it.value().listIndex;
+    processes.erase(it);
+
+    DWORD last = processIds.takeLast();
+    if (last != processId) {
+        processIds[index] = last;
+        processes[last].listIndex = index;
+    }
+}
+
+// Create a window in a reused or new slot, in front of the other non-TopMost windows
+int SimulatedBackend::createWindow(DWORD processId, const Process &process, bool visible) {
+    int slot;
+    if (freeSlots.isEmpty()) {
+        slot = static_cast<int>(windows.size());
+        windows.append(Window());
+    } else {
+        slot = freeSlots.takeLast();
+    }
+
+    Window &window = windows[slot];
+    window = Window();
+    window.alive = true;
+    window.processId = processId;
+    window.serial = process.serial;
+    window.visible = visible;
+    window.classIndex = random.bounded(classNameCount);
+    window.title = QString("%1 - Document %2").arg(executableNames()[process.nameIndex]).arg(random.bounded(100000));
+    window.rect.left = random.bounded(1600);
+    window.rect.top = random.bounded(900);
+    window.rect.right = window.rect.left + 200 + random.bounded(1000);
+    window.rect.bottom = window.rect.top + 150 + random.bounded(700);
+
+    zOrder.append(slot);
+    raiseWindow(slot);
+    return slot;
+}
+
+// Free a window slot for reuse
+void SimulatedBackend::destroyWindow(int slot) {
+    windows[slot].alive = false;
+    windows[slot].title.clear();
+    zOrder.removeOne(slot);
+    freeSlots.append(slot);
+}
+
+// Move a window to the front of its band (TopMost windows stay in front of the others)
+void SimulatedBackend::raiseWindow(int slot) {
+    zOrder.removeOne(slot);
+    int position = 0;
+    if (!windows[slot].topMost) {
+        while (position < zOrder.size() && windows[zOrder[position]].topMost) {
+            ++position;
+        }
+    }
+    zOrder.insert(position, slot);
+}
+
+#pragma endregion
@@ -0,0 +1,177 @@
+#ifndef SIMULATEDBACKEND_H
+#define SIMULATEDBACKEND_H
+
+#include <QString>
+#include <QVector>
+#include <QHash>
+#include <QReadWriteLock>
+#include <QWaitCondition>
+#include <QRandomGenerator>
+#include "windowbackend.h"
+
+/**
+ * @class SimulatedBackend
+ * @brief In-memory process and window table implementing WindowBackend for headless soak runs.
+ *
+ * Process IDs come from a small, configurable ID space and window handles are recycled as soon as a
+ * window is destroyed, the same way Windows reuses both, so the races between looking up a target and
+ * acting on it are exercised. Every process gets a serial number that is never reused; each successful
+ * change records the (process ID, serial) of the window or process it was applied to, which lets the
+ * harness detect operations that hit a different process than intended.
+ *
+ * All methods are thread-safe. Enumerations copy the handle list first and run the callback unlocked,
+ * so windows can disappear while being enumerated, as with EnumWindows.
+ */
+class SimulatedBackend : public WindowBackend {
+public:
+    /**
+     * @brief Size of the simulated system.
+     */
+    struct Options {
+        int processCount = 200;         // Processes kept alive
+        int processIdSpace = 4096;      // Process IDs are multiples of 4 below this value
+        int hiddenWindows = 1;          // Invisible windows per process besides the main window
+        quint32 seed = 1;               // Random seed of the simulation
+    };
+
+    /**
+     * @brief A process identity that stays unique when IDs are reused.
+     */
+    struct ProcessIdentity {
+        DWORD processId = 0;
+        quint64 serial = 0;
+        int nameIndex = 0;
+    };
+
+    explicit SimulatedBackend(const Options &options);
+    ~SimulatedBackend();
+
+    #pragma region WindowBackend
+
+    bool enumerateProcesses(const std::function<bool(const ProcessEntry &)> &callback) override;
+    bool queryResourceUsage(DWORD processId, qint64 &workingSet, qint64 &cpuTime, qint64 &creationTime) override;
+    bool terminateProcess(DWORD processId) override;
+    qint64 processCreationTime(DWORD processId) override;
+
+    void enumerateWindows(const std::function<bool(HWND)> &callback) override;
+    void enumerateChildWindows(HWND parent, const std::function<bool(HWND)> &callback) override;
+    HWND parentWindow(HWND hWnd) override;
+    DWORD windowProcessId(HWND hWnd) override;
+    bool isWindowVisible(HWND hWnd) override;
+    int windowTitle(HWND hWnd, char16_t *buffer, int capacity) override;
+    int windowClass(HWND hWnd, char16_t *buffer, int capacity) override;
+    bool windowRect(HWND hWnd, RECT &rect) override;
+    bool windowFrameRect(HWND hWnd, RECT &rect) override;
+    bool isTopMost(HWND hWnd) override;
+    bool windowOpacity(HWND hWnd, int &opacity) override;
+    bool isMinimized(HWND hWnd) override;
+    bool isCloaked(HWND hWnd) override;
+    HWND waitForWindow(const std::function<bool(HWND)> &match, int timeoutMs, const std::atomic<bool> *cancelled) override;
+    bool watchWindowLayout(const std::function<void(HWND)> &changed) override;
+
+    bool setWindowTitle(HWND hWnd, const QString &title) override;
+    bool setTopMost(HWND hWnd, bool topMost) override;
+    bool resizeWindow(HWND hWnd, int width, int height) override;
+    bool setWindowGeometries(const QVector<GeometryUpdate> &updates) override;
+    bool setWindowOpacity(HWND hWnd, int opacity) override;
+    bool showWindow(HWND hWnd, ShowCommand command) override;
+    bool focusWindow(HWND hWnd) override;
+
+    qint64 tickCount() override;
+
+    #pragma endregion
+
+    #pragma region Simulation
+
+    /**
+     * @brief Lets processes exit and starts replacements, keeping the process count.
+     * @param count Number of processes to replace.
+     */
+    void churnProcesses(int count);
+
+    /**
+     * @brief Changes titles, positions and visibility of random windows; some windows are recreated.
+     * @param count Number of changes.
+     */
+    void changeWindowProperties(int count);
+
+    /**
+     * @brief Picks a random live process.
+     * @return False if no process is running.
+     */
+    bool sampleProcess(QRandomGenerator &random, ProcessIdentity &identity);
+
+    /**
+     * @brief Returns the executable names used by the simulation.
+     */
+    static const QVector<QString> &executableNames();
+
+    /**
+     * @brief Returns the identity of the target of the last successful change made by the calling thread
+     *        and clears it.
+     * @return False if the calling thread changed nothing since the last call.
+     */
+    static bool takeLastChange(ProcessIdentity &identity);
+
+    /**
+     * @brief Returns the number of live processes and windows.
+     */
+    void counts(int &processes, int &windows);
+
+    #pragma endregion
+
+private:
+    struct Process {
+        quint64 serial;             // Unique across ID reuse
+        int nameIndex;              // Index into executableNames()
+        DWORD parentProcessId;      // Parent process
+        int threadCount;            // Thread count
+        qint64 workingSet;          // Working set in bytes
+        qint64 cpuTime;             // CPU time in ms
+        int listIndex;              // Position in processIds
+        QVector<int> windows;       // Window slots, main window first
+    };
+
+    struct Window {
+        bool alive = false;
+        DWORD processId = 0;
+        quint64 serial = 0;         // Serial of the owning process
+        bool visible = false;
+        bool topMost = false;
+        bool layered = false;
+        bool minimized = false;
+        int opacity = 255;
+        int classIndex = 0;
+        QString title;
+        RECT rect = {};
+    };
+
+    Window *findWindow(HWND hWnd);
+    void recordChange(DWORD processId, quint64 serial);
+    void notifyWindowsChanged();
+    void spawnProcess();
+    void exitProcess(DWORD processId);
+    int createWindow(DWORD processId, const Process &process, bool visible);
+    void destroyWindow(int slot);
+    void raiseWindow(int slot);
+    static HWND handleOf(int slot) { return reinterpret_cast<HWND>(static_cast<quintptr>(slot) + 1); }
+
+    #pragma region Member Variables
+
+    Options options;                    // Simulation size
+    QReadWriteLock lock;                // Guards everything below
+    QRandomGenerator random;            // Simulation randomness (used under the write lock)
+    QHash<DWORD, Process> processes;    // Live processes by ID
+    QVector<DWORD> processIds;          // Live process IDs, for random picks
+    QVector<Window> windows;            // Window slots; the handle is slot + 1
+    QVector<int> freeSlots;             // Destroyed slots, reused last-in first-out
+    QVector<int> zOrder;                // Live window slots, topmost first
+    quint64 nextSerial;                 // Serial of the next process
+    quint64 windowGeneration;           // Incremented when windows are created, shown or renamed
+    QWaitCondition windowsChanged;      // Woken with windowGeneration, used with lock
+    qint64 startTime;                   // Steady clock at construction, for tickCount()
+
+    #pragma endregion
+};
+
+#endif // SIMULATEDBACKEND_H
@@ -0,0 +1,44 @@
+# Headless soak test: ProcessManager against a simulated backend (builds on Windows and Linux)
+QT = core
+
+CONFIG += c++17 console
+CONFIG -= app_bundle
+
+TARGET = cwin-soak
+
+INCLUDEPATH += ../..
+
+SOURCES += \
+    animationbenchmark.cpp \
+    exportbenchmark.cpp \
+    latencyhistogram.cpp \
+    main.cpp \
+    simulatedbackend.cpp \
+    soakrunner.cpp \
+    titlewatchbenchmark.cpp \
+    ../../changejournal.cpp \
+    ../../processfilter.cpp \
+    ../../processinfo.cpp \
+    ../../processmanager.cpp \
+    ../../processsnapshot.cpp \
+    ../../snapshotexporter.cpp \
+    ../../stringpool.cpp \
+    ../../titlewatch.cpp \
+    ../../tracer.cpp \
+    ../../windowanimator.cpp \
+    ../../windowbackend.cpp \
+    ../../windowspatialindex.cpp \
+    ../../windowtree.cpp
+
+HEADERS += \
+    animationbenchmark.h \
+    exportbenchmark.h \
+    latencyhistogram.h \
+    simulatedbackend.h \
+    soakrunner.h \
+    titlewatchbenchmark.h \
+    ../../windowanimator.h
+
+# WindowBackend::systemBackend() and resident memory on Windows
+win32: SOURCES += ../../win32backend.cpp
+win32: LIBS += -lpsapi -ldwmapi
@@ -0,0 +1,408 @@
+#include "soakrunner.h"
+#include <QMutexLocker>
+#include <QThread>
+#include <algorithm>
+#include <chrono>
+#include "processmanager.h"
+#include "processfilter.h"
+
+#ifdef _WIN32
+#include <psapi.h>
+#elif defined(__linux__)
+#include <cstdio>
+#include <unistd.h>
+#endif
+
+namespace {
+
+qint64 steadyNanoseconds() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+qint64 steadyMilliseconds() {
+    return steadyNanoseconds() / 1000000;
+}
+
+} // namespace
+
+#pragma region Constructor
+
+/**
+ * @brief Creates a runner with one statistics block per worker.
+ */
+SoakRunner::SoakRunner(SimulatedBackend &backend, const Options &options)
+    : backend(backend), options(options), stopping(false), wrongTargets(0), missedTargets(0),
+      startMemory(0), baselineMemory(0), peakMemory(0) {
+    for (int i = 0; i < options.threads; ++i) {
+        workers.push_back(std::make_unique<WorkerStats>());
+    }
+}
+
+#pragma endregion
+
+#pragma region Run
+
+/**
+ * @brief Starts the workers and the churn thread, reports until the duration is over, then stops them.
+ */
+qint64 SoakRunner::run(QTextStream &out) {
+    startMemory = residentMemory();
+    peakMemory = startMemory;
+
+    std::vector<QThread *> threads;
+    for (int i = 0; i < options.threads; ++i) {
+        threads.push_back(QThread::create([this, i]() { workerLoop(i); }));
+    }
+    threads.push_back(QThread::create([this]() { churnLoop(); }));
+    for (QThread *thread : threads) {
+        thread->start();
+    }
+
+    const qint64 start = steadyMilliseconds();
+    qint64 lastReport = start;
+    while (true) {
+        qint64 now = steadyMilliseconds();
+        qint64 end = start + options.durationMs;
+        qint64 nextReport = std::min(lastReport + options.reportIntervalMs, end);
+        if (now < nextReport) {
+            QThread::msleep(static_cast<unsigned long>(std::min<qint64>(nextReport - now, 100)));
+            continue;
+        }
+
+        report(out, now - start, now - lastReport);
+        lastReport = now;
+        if (now >= end) {
+            break;
+        }
+    }
+
+    stopping.store(true);
+    for (QThread *thread : threads) {
+        thread->wait();
+        delete thread;
+    }
+
+    summary(out, steadyMilliseconds() - start);
+    return wrongTargets;
+}
+
+/**
+ * @brief Issues random operations against random live processes and checks which process each change hit.
+ */
+void SoakRunner::workerLoop(int index) {
+    WorkerStats &stats = *workers[index];
+    QRandomGenerator random(options.seed + static_cast<quint32>(index) * 7919u);
+
+    ProcessManager manager(&backend);
+    auto discardLog = [](const QString &) {};
+    manager.setLogCallback(discardLog);
+
+    // Every worker compiles its own filters, like an independent caller would
+    std::vector<ProcessFilter> nameFilters;
+    for (const QString &name : SimulatedBackend::executableNames()) {
+        nameFilters.emplace_back(QString("name == \"%1\"").arg(name));
+    }
+    ProcessSnapshot snapshot;
+    WindowSpatialIndex layout;
+    manager.captureWindowLayout(layout);
+    quint64 titleCounter = 0;
+
+    while (!stopping.load(std::memory_order_relaxed)) {
+        SimulatedBackend::ProcessIdentity target;
+        if (!backend.sampleProcess(random, target)) {
+            QThread::msleep(1);
+            continue;
+        }
+
+        Operation operation = pickOperation(random);
+        SimulatedBackend::ProcessIdentity changed;
+        SimulatedBackend::takeLastChange(changed);     // Forget changes of the previous iteration
+
+        qint64 start = steadyNanoseconds();
+        switch (operation) {
+        case GetDetails:
+            manager.getProcessDetails(QString::number(target.processId), discardLog);
+            break;
+        case SetTitle:
+            manager.SetProcessWindowTitle(QString("soak %1-%2").arg(index).arg(++titleCounter), target.processId);
+            break;
+        case SetTopMost:
+            manager.SetProcessWindowTopMost(random.bounded(2) == 0, target.processId);
+            break;
+        case SetOpacity:
+            manager.SetProcessWindowTransparency(64 + random.bounded(192), target.processId);
+            break;
+        case WindowCommand: {
+            const ProcessManager::WindowCommand commands[] = { ProcessManager::Maximize, ProcessManager::Minimize, ProcessManager::Focus };
+            manager.ExecuteWindowCommand(commands[random.bounded(3)], target.processId);
+            break;
+        }
+        case FilterDetails:
+            manager.getProcessDetailsByFilter(nameFilters[static_cast<size_t>(target.nameIndex)], discardLog);
+            break;
+        case CaptureSnapshot:
+            manager.captureSnapshot(snapshot);
+            break;
+        case WindowLayout: {
+            // Half of the updates follow one window, like the window change events of the application do
+            HWND hWnd = random.bounded(2) == 0 ? manager.windowForProcess(target.processId) : NULL;
+            if (hWnd == NULL || !manager.updateWindowLayout(layout, hWnd)) {
+                manager.captureWindowLayout(layout);
+            }
+            break;
+        }
+        case HitTest: {
+            HWND hWnd = layout.windowAt(random.bounded(1920), random.bounded(1080));
+            if (hWnd != NULL) {
+                layout.isOccluded(hWnd);
+            }
+            break;
+        }
+        case Kill:
+            manager.ExecuteWindowCommand(ProcessManager::Kill, target.processId);
+            break;
+        default:
+            break;
+        }
+        qint64 elapsed = steadyNanoseconds() - start;
+
+        bool wrongTarget = false;
+        bool missedTarget = false;
+        if (changesTarget(operation)) {
+            if (SimulatedBackend::takeLastChange(changed)) {
+                wrongTarget = changed.processId != target.processId || changed.serial != target.serial;
+            } else {
+                missedTarget = true;
+            }
+        }
+
+        QMutexLocker locker(&stats.mutex);
+        stats.latencies[operation].record(elapsed);
+        stats.wrongTargets += wrongTarget ? 1 : 0;
+        stats.missedTargets += missedTarget ? 1 : 0;
+    }
+}
+
+/**
+ * @brief Replaces processes and changes window properties at the configured rates.
+ */
+void SoakRunner::churnLoop() {
+    double churnDue = 0;
+    double changesDue = 0;
+    qint64 last = steadyNanoseconds();
+
+    while (!stopping.load(std::memory_order_relaxed)) {
+        QThread::msleep(5);
+        qint64 now = steadyNanoseconds();
+        double seconds = static_cast<double>(now - last) / 1e9;
+        last = now;
+
+        churnDue += options.churnPerSecond * seconds;
+        changesDue += options.changesPerSecond * seconds;
+
+        int churn = static_cast<int>(churnDue);
+        int changes = static_cast<int>(changesDue);
+        churnDue -= churn;
+        changesDue -= changes;
+
+        if (churn > 0) {
+            backend.churnProcesses(churn);
+        }
+        if (changes > 0) {
+            backend.changeWindowProperties(changes);
+        }
+    }
+}
+
+#pragma endregion
+
+#pragma region Reporting
+
+/**
+ * @brief Moves the worker statistics since the last call into the run totals.
+ */
+void SoakRunner::collect(LatencyHistogram &interval, qint64 &intervalWrong, qint64 &intervalMissed) {
+    intervalWrong = 0;
+    intervalMissed = 0;
+
+    for (const std::unique_ptr<WorkerStats> &worker : workers) {
+        QMutexLocker locker(&worker->mutex);
+        for (int op = 0; op < OperationCount; ++op) {
+            interval.merge(worker->latencies[op]);
+            totals[op].merge(worker->latencies[op]);
+            worker->latencies[op].reset();
+        }
+        intervalWrong += worker->wrongTargets;
+        intervalMissed += worker->missedTargets;
+        worker->wrongTargets = 0;
+        worker->missedTargets = 0;
+    }
+    wrongTargets += intervalWrong;
+    missedTargets += intervalMissed;
+}
+
+/**
+ * @brief Collects the worker statistics of the last interval and prints one line.
+ */
+void SoakRunner::report(QTextStream &out, qint64 elapsedMs, qint64 intervalMs) {
+    LatencyHistogram interval;
+    qint64 intervalWrong = 0;
+    qint64 intervalMissed = 0;
+    collect(interval, intervalWrong, intervalMissed);
+
+    qint64 memory = residentMemory();
+    peakMemory = std::max(peakMemory, memory);
+    if (baselineMemory == 0) {
+        baselineMemory = memory;    // The first interval warms up caches and buffers
+    }
+
+    int processCount = 0;
+    int windowCount = 0;
+    backend.counts(processCount, windowCount);
+
+    double throughput = intervalMs > 0 ? static_cast<double>(interval.count()) * 1000.0 / static_cast<double>(intervalMs) : 0;
+    out << QString("[%1 s] %2 ops/s  p50 %3  p99 %4  p999 %5  max %6 | rss %7 (%8) | %9 processes, %10 windows | wrong-target %11, missed %12")
+               .arg(elapsedMs / 1000, 6)
+               .arg(qRound64(throughput))
+               .arg(formatLatency(interval.percentile(0.50)),
+                    formatLatency(interval.percentile(0.99)),
+                    formatLatency(interval.percentile(0.999)),
+                    formatLatency(interval.maximum()),
+                    formatMegabytes(memory),
+                    (memory >= baselineMemory ? "+" : "") + formatMegabytes(memory - baselineMemory))
+               .arg(processCount)
+               .arg(windowCount)
+               .arg(intervalWrong)
+               .arg(intervalMissed)
+        << Qt::endl;
+}
+
+/**
+ * @brief Prints per-operation latencies, memory growth and target accuracy of the whole run.
+ */
+void SoakRunner::summary(QTextStream &out, qint64 elapsedMs) {
+    // Samples recorded while the workers were stopping
+    LatencyHistogram remaining;
+    qint64 remainingWrong = 0;
+    qint64 remainingMissed = 0;
+    collect(remaining, remainingWrong, remainingMissed);
+
+    out << Qt::endl << "Operation            Count        p50        p99       p999        max" << Qt::endl;
+    LatencyHistogram all;
+    for (int op = 0; op < OperationCount; ++op) {
+        const LatencyHistogram &histogram = totals[op];
+        all.merge(histogram);
+        out << QString("%1 %2 %3 %4 %5 %6")
+                   .arg(QString(operationName(static_cast<Operation>(op))), -16)
+                   .arg(histogram.count(), 9)
+                   .arg(formatLatency(histogram.percentile(0.50)), 10)
+                   .arg(formatLatency(histogram.percentile(0.99)), 10)
+                   .arg(formatLatency(histogram.percentile(0.999)), 10)
+                   .arg(formatLatency(histogram.maximum()), 10)
+            << Qt::endl;
+    }
+    out << QString("%1 %2 %3 %4 %5 %6")
+               .arg(QString("all"), -16)
+               .arg(all.count(), 9)
+               .arg(formatLatency(all.percentile(0.50)), 10)
+               .arg(formatLatency(all.percentile(0.99)), 10)
+               .arg(formatLatency(all.percentile(0.999)), 10)
+               .arg(formatLatency(all.maximum()), 10)
+        << Qt::endl << Qt::endl;
+
+    double seconds = static_cast<double>(std::max<qint64>(elapsedMs, 1)) / 1000.0;
+    qint64 memory = residentMemory();
+    qint64 growth = memory - baselineMemory;
+    out << QString("Throughput:    %1 ops/s over %2 s").arg(qRound64(static_cast<double>(all.count()) / seconds)).arg(qRound64(seconds)) << Qt::endl;
+    out << QString("Memory:        start %1, warm %2, end %3, peak %4")
+               .arg(formatMegabytes(startMemory), formatMegabytes(baselineMemory), formatMegabytes(memory), formatMegabytes(peakMemory))
+        << Qt::endl;
+    out << QString("Memory growth: %1 since warm-up (%2 per hour)")
+               .arg(formatMegabytes(growth), formatMegabytes(qRound64(static_cast<double>(growth) * 3600.0 / seconds)))
+        << Qt::endl;
+    out << QString("Targets:       %1 wrong-target hits, %2 missed (target exited or hidden)").arg(wrongTargets).arg(missedTargets) << Qt::endl;
+}
+
+#pragma endregion
+
+#pragma region Helpers
+
+// Operation mix: mostly single-window changes, a few full enumerations and kills
+SoakRunner::Operation SoakRunner::pickOperation(QRandomGenerator &random) {
+    static const int weights[OperationCount] = { 16, 22, 12, 12, 20, 5, 5, 2, 5, 1 };
+    int roll = random.bounded(100);
+    for (int op = 0; op < OperationCount; ++op) {
+        if (roll < weights[op]) {
+            return static_cast<Operation>(op);
+        }
+        roll -= weights[op];
+    }
+    return GetDetails;
+}
+
+// Operation names used in the summary
+const char *SoakRunner::operationName(Operation operation) {
+    switch (operation) {
+    case GetDetails:      return "getDetails";
+    case SetTitle:        return "setTitle";
+    case SetTopMost:      return "setTopMost";
+    case SetOpacity:      return "setOpacity";
+    case WindowCommand:   return "windowCommand";
+    case FilterDetails:   return "filterDetails";
+    case CaptureSnapshot: return "captureSnapshot";
+    case WindowLayout:    return "windowLayout";
+    case HitTest:         return "hitTest";
+    case Kill:            return "kill";
+    default:              return "?";
+    }
+}
+
+// Operations whose target is checked against the change the backend recorded
+bool SoakRunner::changesTarget(Operation operation) {
+    return operation == SetTitle || operation == SetTopMost || operation == SetOpacity
+        || operation == WindowCommand || operation == Kill;
+}
+
+// Human readable latency
+QString SoakRunner::formatLatency(qint64 nanoseconds) {
+    if (nanoseconds < 1000) {
+        return QString("%1 ns").arg(nanoseconds);
+    }
+    if (nanoseconds < 1000000) {
+        return QString("%1 us").arg(static_cast<double>(nanoseconds) / 1e3, 0, 'f', 1);
+    }
+    if (nanoseconds < 1000000000) {
+        return QString("%1 ms").arg(static_cast<double>(nanoseconds) / 1e6, 0, 'f', 2);
+    }
+    return QString("%1 s").arg(static_cast<double>(nanoseconds) / 1e9, 0, 'f', 2);
+}
+
+// Human readable memory size
+QString SoakRunner::formatMegabytes(qint64 bytes) {
+    return QString("%1 MB").arg(static_cast<double>(bytes) / (1024.0 * 1024.0), 0, 'f', 1);
+}
+
+// Resident set size of this process in bytes (0 if unknown)
+qint64 SoakRunner::residentMemory() {
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+        return static_cast<qint64>(counters.WorkingSetSize);
+    }
+    return 0;
+#elif defined(__linux__)
+    long long totalPages = 0;
+    long long residentPages = 0;
+    FILE *statm = std::fopen("/proc/self/statm", "r");
+    if (!statm) {
+        return 0;
+    }
+    int fields = std::fscanf(statm, "%lld %lld", &totalPages, &residentPages);
+    std::fclose(statm);
+    return fields == 2 ? static_cast<qint64>(residentPages) * sysconf(_SC_PAGESIZE) : 0;
+#else
+    return 0;
+#endif
+}
+
+#pragma endregion
@@ -0,0 +1,107 @@
+#ifndef SOAKRUNNER_H
+#define SOAKRUNNER_H
+
+#include <QMutex>
+#include <QTextStream>
+#include <atomic>
+#include <memory>
+#include <vector>
+#include "latencyhistogram.h"
+#include "simulatedbackend.h"
+
+/**
+ * @class SoakRunner
+ * @brief Drives ProcessManager operations from several threads against a SimulatedBackend.
+ *
+ * Every worker thread owns a ProcessManager and repeatedly picks a random live process and a random
+ * operation, timing each call. A separate thread replaces processes and changes window properties at
+ * the configured rates. At every report interval the runner prints throughput, p50/p99/p999 latency,
+ * resident memory growth and the number of operations that changed a different process than the one
+ * they were aimed at (wrong-target hits, caused by process ID or window handle reuse).
+ */
+class SoakRunner {
+public:
+    /**
+     * @brief Load and duration of a run.
+     */
+    struct Options {
+        int threads = 4;                        // Worker threads
+        qint64 durationMs = 60 * 1000;          // Run length
+        qint64 reportIntervalMs = 10 * 1000;    // Time between report lines
+        double churnPerSecond = 50;             // Processes replaced per second
+        double changesPerSecond = 2000;         // Window property changes per second
+        quint32 seed = 1;                       // Seed of the worker random generators
+    };
+
+    /**
+     * @brief Operations issued by the workers.
+     */
+    enum Operation {
+        GetDetails,         // getProcessDetails by process ID
+        SetTitle,           // SetProcessWindowTitle
+        SetTopMost,         // SetProcessWindowTopMost
+        SetOpacity,         // SetProcessWindowTransparency
+        WindowCommand,      // ExecuteWindowCommand (maximize, minimize, focus)
+        FilterDetails,      // getProcessDetailsByFilter by executable name
+        CaptureSnapshot,    // captureSnapshot
+        WindowLayout,       // updateWindowLayout or captureWindowLayout into the worker's spatial index
+        HitTest,            // WindowSpatialIndex::windowAt and isOccluded
+        Kill,               // ExecuteWindowCommand(Kill)
+        OperationCount
+    };
+
+    /**
+     * @brief Creates a runner.
+     * @param backend The simulated system; must outlive the runner.
+     * @param options Load and duration.
+     */
+    SoakRunner(SimulatedBackend &backend, const Options &options);
+
+    /**
+     * @brief Runs the soak test, printing interval reports and a final summary.
+     * @param out Report output.
+     * @return The number of wrong-target hits.
+     */
+    qint64 run(QTextStream &out);
+
+private:
+    /**
+     * @brief Results of one worker since the last report.
+     */
+    struct WorkerStats {
+        QMutex mutex;                                   // Taken by the worker per operation and by the reporter
+        LatencyHistogram latencies[OperationCount];     // Latencies since the last report
+        qint64 wrongTargets = 0;                        // Changes applied to another process
+        qint64 missedTargets = 0;                       // Changes not applied (target gone)
+    };
+
+    void workerLoop(int index);
+    void churnLoop();
+    void collect(LatencyHistogram &interval, qint64 &intervalWrong, qint64 &intervalMissed);
+    void report(QTextStream &out, qint64 elapsedMs, qint64 intervalMs);
+    void summary(QTextStream &out, qint64 elapsedMs);
+
+    static Operation pickOperation(QRandomGenerator &random);
+    static const char *operationName(Operation operation);
+    static bool changesTarget(Operation operation);
+    static QString formatLatency(qint64 nanoseconds);
+    static QString formatMegabytes(qint64 bytes);
+    static qint64 residentMemory();
+
+    #pragma region Member Variables
+
+    SimulatedBackend &backend;                          // Simulated system
+    Options options;                                    // Load and duration
+    std::atomic<bool> stopping;                         // Set when the run ends
+    std::vector<std::unique_ptr<WorkerStats>> workers;  // One per worker thread
+    LatencyHistogram totals[OperationCount];            // Latencies of the whole run
+    qint64 wrongTargets;                                // Wrong-target hits of the whole run
+    qint64 missedTargets;                               // Missed targets of the whole run
+    qint64 startMemory;                                 // Resident memory before the workers started
+    qint64 baselineMemory;                              // Resident memory after the first interval (warm)
+    qint64 peakMemory;                                  // Largest resident memory seen
+
+    #pragma endregion
+};
+
+#endif // SOAKRUNNER_H
@@ -0,0 +1,161 @@
+#include "titlewatchbenchmark.h"
+#include <chrono>
+#include "latencyhistogram.h"
+#include "titlewatch.h"
+
+namespace {
+
+qint64 steadyNanoseconds() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Realistic title fragments; patterns are built from the same words, so partial matches are common
+const char *const words[] = {
+    "error", "warning", "build", "failed", "not", "responding", "untitled", "document", "project", "release",
+    "debug", "setup", "update", "download", "chrome", "explorer", "terminal", "editor", "settings", "report"
+};
+const int wordCount = sizeof(words) / sizeof(words[0]);
+
+} // namespace
+
+#pragma region Constructor
+
+/**
+ * @brief Creates a benchmark with a seeded generator.
+ */
+TitleWatchBenchmark::TitleWatchBenchmark(const Options &options) : options(options), random(options.seed) {}
+
+#pragma endregion
+
+#pragma region Run
+
+/**
+ * @brief Runs the measurements in order; the reference check runs on the first scan, where every title is new.
+ */
+bool TitleWatchBenchmark::run(QTextStream &out) {
+    patterns.clear();
+    for (int i = 0; i < options.patterns; ++i) {
+        patterns.append(randomText(4, 24));
+    }
+    titles.clear();
+    for (int i = 0; i < options.titles; ++i) {
+        titles.append(randomTitle());
+    }
+
+    TitleWatch watch;
+    qint64 start = steadyNanoseconds();
+    int compiled = watch.setPatterns(patterns);
+    qint64 compileNs = steadyNanoseconds() - start;
+    out << QString("compile: %1 patterns, %2 states in %3 ms").arg(compiled).arg(watch.stateCount()).arg(compileNs / 1e6, 0, 'f', 2)
+        << Qt::endl;
+
+    ProcessSnapshot snapshot;
+    fillSnapshot(snapshot);
+
+    // First scan: every title is new
+    start = steadyNanoseconds();
+    QVector<TitleWatch::Match> matches = watch.scan(snapshot);
+    qint64 scanNs = steadyNanoseconds() - start;
+    qint64 automatonHits = 0;
+    for (const TitleWatch::Match &match : matches) {
+        automatonHits += match.patterns.size();
+    }
+
+    // Reference: every distinct pattern against every title
+    QStringList distinct;
+    for (int i = 0; i < watch.patternCount(); ++i) {
+        distinct.append(watch.pattern(i));
+    }
+    start = steadyNanoseconds();
+    qint64 referenceHits = 0;
+    for (const QString &title : titles) {
+        for (const QString &pattern : distinct) {
+            referenceHits += title.contains(pattern, Qt::CaseInsensitive) ? 1 : 0;
+        }
+    }
+    qint64 referenceNs = steadyNanoseconds() - start;
+
+    out << QString("full scan: %1 titles, %2 windows matched, %3 hits in %4 ms (%5 ns/title)")
+               .arg(watch.lastScanCount()).arg(matches.size()).arg(automatonHits)
+               .arg(scanNs / 1e6, 0, 'f', 2).arg(scanNs / qMax(1, watch.lastScanCount()))
+        << Qt::endl;
+    out << QString("reference: %1 hits in %2 ms (%3x slower)")
+               .arg(referenceHits).arg(referenceNs / 1e6, 0, 'f', 2).arg(double(referenceNs) / qMax<qint64>(1, scanNs), 0, 'f', 1)
+        << Qt::endl;
+
+    // No title changed: one comparison per window
+    fillSnapshot(snapshot);
+    start = steadyNanoseconds();
+    watch.scan(snapshot);
+    qint64 unchangedNs = steadyNanoseconds() - start;
+    out << QString("unchanged scan: %1 titles matched in %2 ms").arg(watch.lastScanCount()).arg(unchangedNs / 1e6, 0, 'f', 2)
+        << Qt::endl;
+
+    // Samples with a fraction of the titles changed
+    LatencyHistogram latencies;
+    qint64 scanned = 0;
+    int changes = qMax(1, static_cast<int>(options.titles * options.changedFraction));
+    for (int round = 0; round < options.rounds; ++round) {
+        for (int i = 0; i < changes; ++i) {
+            titles[random.bounded(options.titles)] = randomTitle();
+        }
+        fillSnapshot(snapshot);
+
+        start = steadyNanoseconds();
+        watch.scan(snapshot);
+        latencies.record(steadyNanoseconds() - start);
+        scanned += watch.lastScanCount();
+    }
+    out << QString("incremental scan: %1 rounds, %2 titles matched per round, p50 %3 us, p99 %4 us, max %5 us")
+               .arg(options.rounds).arg(scanned / qMax(1, options.rounds))
+               .arg(latencies.percentile(0.5) / 1000).arg(latencies.percentile(0.99) / 1000).arg(latencies.maximum() / 1000)
+        << Qt::endl;
+
+    if (automatonHits != referenceHits) {
+        out << "MISMATCH: the automaton and the reference found different hits" << Qt::endl;
+        return false;
+    }
+    return true;
+}
+
+#pragma endregion
+
+#pragma region Data
+
+// Words separated by spaces, cut to a random length
+QString TitleWatchBenchmark::randomText(int minLength, int maxLength) {
+    int length = minLength + random.bounded(maxLength - minLength + 1);
+    QString text;
+    while (text.size() < length) {
+        if (!text.isEmpty()) {
+            text.append(' ');
+        }
+        QString word(words[random.bounded(wordCount)]);
+        if (random.bounded(4) == 0) {
+            word[0] = word[0].toUpper();
+        }
+        text.append(word);
+    }
+    return text.left(length).trimmed();
+}
+
+// Typical title lengths
+QString TitleWatchBenchmark::randomTitle() {
+    return randomText(16, 96);
+}
+
+// One process with one main window per title
+void TitleWatchBenchmark::fillSnapshot(ProcessSnapshot &snapshot) const {
+    snapshot.clear();
+    snapshot.reserve(titles.size());
+    const QString processName("bench.exe");
+    const QString className("BenchWindow");
+    const RECT rect = { 0, 0, 800, 600 };
+    for (int i = 0; i < titles.size(); ++i) {
+        int row = snapshot.appendProcess(static_cast<DWORD>(4 * (i + 1)), 0, processName, 1);
+        HWND hWnd = reinterpret_cast<HWND>(static_cast<quintptr>(i) + 1);
+        snapshot.setWindowInfo(row, hWnd, titles[i], className, rect, false, 255);
+    }
+}
+
+#pragma endregion
@@ -0,0 +1,54 @@
+#ifndef TITLEWATCHBENCHMARK_H
+#define TITLEWATCHBENCHMARK_H
+
+#include <QStringList>
+#include <QTextStream>
+#include <QRandomGenerator>
+#include "processsnapshot.h"
+
+/**
+ * @class TitleWatchBenchmark
+ * @brief Measures TitleWatch on generated patterns and window titles.
+ *
+ * Reports the compile time and size of the automaton, a first scan over all titles compared against
+ * testing every pattern with QString::contains (the match counts must agree), a scan with no changed
+ * title, and the latency of scans where a fraction of the titles changed since the previous sample.
+ */
+class TitleWatchBenchmark {
+public:
+    /**
+     * @brief Size of the generated data.
+     */
+    struct Options {
+        int patterns = 1000;            // Watch patterns
+        int titles = 10000;             // Windows, one title each
+        double changedFraction = 0.01;  // Titles changed between two samples
+        int rounds = 100;               // Samples with changed titles
+        quint32 seed = 1;               // Seed of the generated data
+    };
+
+    /**
+     * @brief Creates a benchmark.
+     * @param options Size of the generated data.
+     */
+    explicit TitleWatchBenchmark(const Options &options);
+
+    /**
+     * @brief Generates the data, runs all measurements and prints the results.
+     * @param out Report output.
+     * @return False if the automaton and the reference disagree.
+     */
+    bool run(QTextStream &out);
+
+private:
+    QString randomText(int minLength, int maxLength);
+    QString randomTitle();
+    void fillSnapshot(ProcessSnapshot &snapshot) const;
+
+    Options options;            // Size of the generated data
+    QRandomGenerator random;    // Generates patterns and titles
+    QStringList patterns;       // Generated patterns
+    QStringList titles;         // Current title of every window
+};
+
+#endif // TITLEWATCHBENCHMARK_H
@@ -0,0 +1,82 @@
+#include "topprocessesdialog.h"
+#include <QVBoxLayout>
+#include <QHeaderView>
+
+//#region Constructor and Destructor
+
+/**
+ * Main constructor for TopProcessesDialog class.
+ * Creates the metric selector, the process table and the status line.
+ */
+TopProcessesDialog::TopProcessesDialog(QWidget *parent)
+    : QDialog(parent)
+{
+    setWindowTitle("Top Processes");
+
+    cbMetric = new QComboBox(this);
+    cbMetric->addItem("By CPU");
+    cbMetric->addItem("By Memory");
+
+    tblProcesses = new QTableWidget(0, 4, this);
+    tblProcesses->setHorizontalHeaderLabels({ "Process", "PID", "CPU %", "Memory (MB)" });
+    tblProcesses->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    tblProcesses->setSelectionBehavior(QAbstractItemView::SelectRows);
+    tblProcesses->horizontalHeader()->setSectionResizeMode(0, QHeaderView::Stretch);
+    tblProcesses->verticalHeader()->setVisible(false);
+
+    lblStatus = new QLabel(this);
+
+    QVBoxLayout *layout = new QVBoxLayout(this);
+    layout->addWidget(cbMetric);
+    layout->addWidget(tblProcesses);
+    layout->addWidget(lblStatus);
+
+    this->resize(420, 520);
+}
+
+/**
+ * Destructor for TopProcessesDialog class.
+ */
+TopProcessesDialog::~TopProcessesDialog()
+{
+}
+
+//#endregion
+
+//#region Helper Methods
+
+/**
+ * Fills the table with the top entries of the selected metric.
+ * Existing items are reused so a refresh does not recreate the table.
+ */
+void TopProcessesDialog::showRanking(const ProcessRanking &ranking)
+{
+    ProcessRanking::Metric metric = cbMetric->currentIndex() == 0 ? ProcessRanking::CpuUsage : ProcessRanking::MemoryUsage;
+    QVector<ProcessRanking::Entry> entries = ranking.top(metric, maxEntries);
+
+    tblProcesses->setRowCount(entries.size());
+    for (int row = 0; row < entries.size(); ++row) {
+        const ProcessRanking::Entry &entry = entries[row];
+        setCell(row, 0, entry.processName);
+        setCell(row, 1, QString::number(entry.processId));
+        setCell(row, 2, QString::number(entry.cpuUsage / 100.0, 'f', 1));
+        setCell(row, 3, QString::number(entry.memoryUsage / (1024.0 * 1024.0), 'f', 1));
+    }
+
+    lblStatus->setText(QString("%1 ranking changes in the last refresh").arg(ranking.lastChurn()));
+}
+
+/**
+ * Sets the text of a table cell, creating the item on first use.
+ */
+void TopProcessesDialog::setCell(int row, int column, const QString &text)
+{
+    QTableWidgetItem *item = tblProcesses->item(row, column);
+    if (item == nullptr) {
+        item = new QTableWidgetItem();
+        tblProcesses->setItem(row, column, item);
+    }
+    item->setText(text);
+}
+
+//#endregion
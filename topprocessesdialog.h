@@ -0,0 +1,50 @@
+#ifndef TOPPROCESSESDIALOG_H
+#define TOPPROCESSESDIALOG_H
+
+#include <QDialog>
+#include <QComboBox>
+#include <QTableWidget>
+#include <QLabel>
+#include "processranking.h"
+
+/**
+ * TopProcessesDialog class:
+ * A lightweight task manager view listing the processes with the highest CPU or memory usage.
+ * The dialog only displays a ProcessRanking; sampling is driven by the MainWindow.
+ */
+class TopProcessesDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    /**
+     * Constructor: Builds the ranking table and the metric selector.
+     * @param parent The parent widget.
+     */
+    explicit TopProcessesDialog(QWidget *parent = nullptr);
+
+    /**
+     * Destructor: Cleans up the dialog.
+     */
+    ~TopProcessesDialog();
+
+    /**
+     * Shows the current top entries of the ranking.
+     * @param ranking The ranking to display.
+     */
+    void showRanking(const ProcessRanking &ranking);
+
+private:
+    /**
+     * Sets the text of a table cell, creating the item on first use.
+     */
+    void setCell(int row, int column, const QString &text);
+
+    QComboBox *cbMetric;        // Selects the ranking metric (CPU or memory)
+    QTableWidget *tblProcesses; // Displays the ranked processes
+    QLabel *lblStatus;          // Shows the churn of the last update
+
+    static const int maxEntries = 20;   // Number of processes listed
+};
+
+#endif // TOPPROCESSESDIALOG_H
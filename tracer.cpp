@@ -0,0 +1,219 @@
+#include "tracer.h"
+#include <QCoreApplication>
+#include <QByteArray>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QThread>
+#include <chrono>
+#include <memory>
+#include <vector>
+
+namespace {
+
+const int bufferCapacity = 16 * 1024;   // Events per thread and session
+
+struct Event {
+    const char *name;   // Span name (string literal)
+    qint64 start;       // Start time in microseconds
+    qint64 duration;    // Duration in microseconds
+};
+
+// Written only by its own thread; the exporter reads events below `count` of the current session. A reset for a
+// new session takes the registry lock, so it never overwrites events an export is still reading
+struct ThreadBuffer {
+    int threadIndex = 0;                    // Trace thread ID
+    QString threadName;                     // Name shown in the viewer
+    std::atomic<quint64> session{0};        // Session the events belong to
+    std::atomic<int> count{0};              // Number of published events
+    std::atomic<qint64> dropped{0};         // Events dropped because the buffer was full
+    std::unique_ptr<Event[]> events;        // Fixed-size event storage
+};
+
+// Buffers are kept until exit so events of finished threads can still be exported
+struct Registry {
+    QMutex mutex;
+    std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+};
+
+Registry &registry() {
+    static Registry instance;
+    return instance;
+}
+
+const std::chrono::steady_clock::time_point origin = std::chrono::steady_clock::now();
+std::atomic<quint64> currentSession(1);
+thread_local ThreadBuffer *localBuffer = nullptr;
+
+// Creates the buffer of the calling thread; apart from the session reset, the only place recording takes a lock
+ThreadBuffer *registerThread() {
+    auto buffer = std::make_unique<ThreadBuffer>();
+    buffer->events.reset(new Event[bufferCapacity]);
+
+    QThread *thread = QThread::currentThread();
+    QCoreApplication *application = QCoreApplication::instance();
+    if (application && thread == application->thread()) {
+        buffer->threadName = "Main";
+    } else {
+        buffer->threadName = thread ? thread->objectName() : QString();
+    }
+
+    Registry &reg = registry();
+    QMutexLocker locker(&reg.mutex);
+    buffer->threadIndex = static_cast<int>(reg.buffers.size()) + 1;
+    if (buffer->threadName.isEmpty()) {
+        buffer->threadName = QString("Thread %1").arg(buffer->threadIndex);
+    }
+    localBuffer = buffer.get();
+    reg.buffers.push_back(std::move(buffer));
+    return localBuffer;
+}
+
+void appendJsonString(QByteArray &out, const QString &text) {
+    out.append('"');
+    for (char c : text.toUtf8()) {
+        if (c == '"' || c == '\\') {
+            out.append('\\');
+        }
+        if (static_cast<unsigned char>(c) >= 0x20) {
+            out.append(c);
+        }
+    }
+    out.append('"');
+}
+
+} // namespace
+
+std::atomic<bool> Tracer::enabled(false);
+
+#pragma region Recording
+
+/**
+ * @brief Starts a new session when enabling; buffers reset themselves on their next event.
+ */
+void Tracer::setEnabled(bool enable) {
+    if (enable && !enabled.load(std::memory_order_relaxed)) {
+        currentSession.fetch_add(1, std::memory_order_acq_rel);
+    }
+    enabled.store(enable, std::memory_order_release);
+}
+
+/**
+ * @brief Returns microseconds since the tracer was loaded.
+ */
+qint64 Tracer::now() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - origin).count();
+}
+
+/**
+ * @brief Appends an event to the buffer of the calling thread without locking.
+ */
+void Tracer::record(const char *name, qint64 start, qint64 end) {
+    if (!isEnabled()) {
+        return;
+    }
+
+    ThreadBuffer *buffer = localBuffer ? localBuffer : registerThread();
+
+    quint64 session = currentSession.load(std::memory_order_acquire);
+    if (buffer->session.load(std::memory_order_relaxed) != session) {
+        // Once per session: waits for an export that may still be reading the old events
+        QMutexLocker locker(&registry().mutex);
+        buffer->count.store(0, std::memory_order_release);
+        buffer->dropped.store(0, std::memory_order_relaxed);
+        buffer->session.store(session, std::memory_order_release);
+    }
+
+    int index = buffer->count.load(std::memory_order_relaxed);
+    if (index >= bufferCapacity) {
+        buffer->dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    buffer->events[index] = { name, start, end - start };
+    buffer->count.store(index + 1, std::memory_order_release);   // Publish to the exporter
+}
+
+#pragma endregion
+
+#pragma region Export
+
+/**
+ * @brief Writes thread name metadata followed by one complete ("X") event per span. The registry lock is held
+ *        throughout, so no buffer is reset for a new session while its events are written.
+ */
+qint64 Tracer::writeChromeTrace(QIODevice *device) {
+    const QByteArray pid = QByteArray::number(QCoreApplication::applicationPid());
+    const quint64 session = currentSession.load(std::memory_order_acquire);
+    const int flushThreshold = 256 * 1024;
+
+    QByteArray out;
+    out.reserve(flushThreshold + 4096);
+    out.append("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+
+    qint64 written = 0;
+    bool first = true;
+    auto separator = [&out, &first]() {
+        if (!first) {
+            out.append(",\n");
+        }
+        first = false;
+    };
+
+    Registry &reg = registry();
+    QMutexLocker locker(&reg.mutex);
+    for (const std::unique_ptr<ThreadBuffer> &buffer : reg.buffers) {
+        if (buffer->session.load(std::memory_order_acquire) != session) {
+            continue;
+        }
+        int count = buffer->count.load(std::memory_order_acquire);
+        const QByteArray tid = QByteArray::number(buffer->threadIndex);
+
+        separator();
+        out.append("{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":").append(pid);
+        out.append(",\"tid\":").append(tid).append(",\"args\":{\"name\":");
+        appendJsonString(out, buffer->threadName);
+        out.append("}}");
+
+        for (int i = 0; i < count; ++i) {
+            const Event &event = buffer->events[i];
+            separator();
+            out.append("{\"name\":\"").append(event.name);
+            out.append("\",\"cat\":\"cWin\",\"ph\":\"X\",\"ts\":").append(QByteArray::number(event.start));
+            out.append(",\"dur\":").append(QByteArray::number(event.duration));
+            out.append(",\"pid\":").append(pid).append(",\"tid\":").append(tid).append('}');
+            ++written;
+
+            if (out.size() >= flushThreshold) {
+                if (device->write(out) != out.size()) {
+                    return -1;
+                }
+                out.clear();
+            }
+        }
+    }
+
+    out.append("]}\n");
+    if (device->write(out) != out.size()) {
+        return -1;
+    }
+    return written;
+}
+
+/**
+ * @brief Sums the dropped events of all buffers in the current session.
+ */
+qint64 Tracer::droppedEvents() {
+    const quint64 session = currentSession.load(std::memory_order_acquire);
+    qint64 dropped = 0;
+
+    Registry &reg = registry();
+    QMutexLocker locker(&reg.mutex);
+    for (const std::unique_ptr<ThreadBuffer> &buffer : reg.buffers) {
+        if (buffer->session.load(std::memory_order_acquire) == session) {
+            dropped += buffer->dropped.load(std::memory_order_relaxed);
+        }
+    }
+    return dropped;
+}
+
+#pragma endregion
@@ -0,0 +1,422 @@
+#include "win32backend.h"
+#include <tlhelp32.h>
+#include <psapi.h>
+#include <dwmapi.h>
+#include <QVarLengthArray>
+#include <algorithm>
+#include <cwchar>
+#include "tracer.h"
+
+namespace {
+
+thread_local QVector<HWND> *windowEvents = nullptr;    // Collects the hook events of the waiting thread
+
+// Out-of-context WinEvent callback, delivered on the thread that installed the hook
+void CALLBACK onWindowEvent(HWINEVENTHOOK, DWORD, HWND hWnd, LONG idObject, LONG idChild, DWORD, DWORD) {
+    if (windowEvents != nullptr && hWnd != NULL && idObject == OBJID_WINDOW && idChild == CHILDID_SELF
+        && GetAncestor(hWnd, GA_ROOT) == hWnd) {
+        windowEvents->append(hWnd);
+    }
+}
+
+thread_local std::function<void(HWND)> layoutChanged;     // Callback of the layout watch of this thread
+thread_local QVector<HWINEVENTHOOK> layoutHooks;        // Hooks of the layout watch of this thread
+
+// Out-of-context WinEvent callback of the layout watch; z-order changes are reported as NULL
+void CALLBACK onLayoutEvent(HWINEVENTHOOK, DWORD event, HWND hWnd, LONG idObject, LONG idChild, DWORD, DWORD) {
+    if (!layoutChanged) {
+        return;
+    }
+    if (event == EVENT_SYSTEM_FOREGROUND || event == EVENT_OBJECT_REORDER) {
+        layoutChanged(NULL);
+        return;
+    }
+    // A destroyed window has no ancestor any more; the receiver drops it if it is known
+    if (hWnd != NULL && idObject == OBJID_WINDOW && idChild == CHILDID_SELF
+        && (event == EVENT_OBJECT_DESTROY || GetAncestor(hWnd, GA_ROOT) == hWnd)) {
+        layoutChanged(hWnd);
+    }
+}
+
+} // namespace
+
+// Constructor and Destructor
+Win32Backend::Win32Backend() {}
+Win32Backend::~Win32Backend() {}
+
+// The process-wide Windows backend
+WindowBackend *WindowBackend::systemBackend() {
+    static Win32Backend backend;
+    return &backend;
+}
+
+#pragma region Processes
+
+// Walk the Toolhelp process list
+bool Win32Backend::enumerateProcesses(const std::function<bool(const ProcessEntry &)> &callback) {
+    HANDLE processSnapshot;
+    {
+        TRACE_SCOPE("Win32::CreateToolhelp32Snapshot");
+        processSnapshot = CreateToolhelp32Snapshot(TH32CS_SNAPPROCESS, 0);
+    }
+    if (processSnapshot == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+
+    PROCESSENTRY32 processEntry;
+    processEntry.dwSize = sizeof(PROCESSENTRY32);
+
+    if (Process32First(processSnapshot, &processEntry)) {
+        do {
+            ProcessEntry entry = { processEntry.th32ProcessID,
+                                   processEntry.th32ParentProcessID,
+                                   QStringView(processEntry.szExeFile, static_cast<qsizetype>(wcslen(processEntry.szExeFile))),
+                                   static_cast<int>(processEntry.cntThreads) };
+            if (!callback(entry)) {
+                break;
+            }
+        } while (Process32Next(processSnapshot, &processEntry));
+    }
+
+    CloseHandle(processSnapshot);
+    return true;
+}
+
+// Memory usage, CPU usage and creation time (fails for protected processes)
+bool Win32Backend::queryResourceUsage(DWORD processId, qint64 &workingSet, qint64 &cpuTime, qint64 &creationTime) {
+    HANDLE hProcess = OpenProcess(PROCESS_QUERY_LIMITED_INFORMATION, FALSE, processId);
+    if (!hProcess) {
+        return false;
+    }
+
+    PROCESS_MEMORY_COUNTERS counters;
+    workingSet = 0;
+    if (GetProcessMemoryInfo(hProcess, &counters, sizeof(counters))) {
+        workingSet = static_cast<qint64>(counters.WorkingSetSize);
+    }
+
+    FILETIME created, exitTime, kernelTime, userTime;
+    cpuTime = 0;
+    creationTime = 0;
+    if (GetProcessTimes(hProcess, &created, &exitTime, &kernelTime, &userTime)) {
+        ULARGE_INTEGER kernel = { { kernelTime.dwLowDateTime, kernelTime.dwHighDateTime } };
+        ULARGE_INTEGER user = { { userTime.dwLowDateTime, userTime.dwHighDateTime } };
+        ULARGE_INTEGER start = { { created.dwLowDateTime, created.dwHighDateTime } };
+        cpuTime = static_cast<qint64>((kernel.QuadPart + user.QuadPart) / 10000);  // 100 ns -> ms
+        creationTime = static_cast<qint64>(start.QuadPart);
+    }
+
+    CloseHandle(hProcess);
+    return true;
+}
+
+// Terminate a process
+bool Win32Backend::terminateProcess(DWORD processId) {
+    HANDLE hProcess = OpenProcess(PROCESS_TERMINATE, FALSE, processId);
+    if (!hProcess) {
+        return false;
+    }
+
+    TRACE_SCOPE("Win32::TerminateProcess");
+    TerminateProcess(hProcess, 0);
+    CloseHandle(hProcess);
+    return true;
+}
+
+// Creation time of the process, distinguishing processes that reused an ID
+qint64 Win32Backend::processCreationTime(DWORD processId) {
+    HANDLE hProcess = OpenProcess(PROCESS_QUERY_LIMITED_INFORMATION, FALSE, processId);
+    if (!hProcess) {
+        return 0;
+    }
+
+    FILETIME creationTime, exitTime, kernelTime, userTime;
+    qint64 created = 0;
+    if (GetProcessTimes(hProcess, &creationTime, &exitTime, &kernelTime, &userTime)) {
+        ULARGE_INTEGER value = { { creationTime.dwLowDateTime, creationTime.dwHighDateTime } };
+        created = static_cast<qint64>(value.QuadPart);
+    }
+    CloseHandle(hProcess);
+    return created;
+}
+
+#pragma endregion
+
+#pragma region Window Queries
+
+// Enumerate top-level windows in z-order
+void Win32Backend::enumerateWindows(const std::function<bool(HWND)> &callback) {
+    EnumWindows([](HWND hWnd, LPARAM lParam) -> BOOL {
+        const std::function<bool(HWND)> *callback = reinterpret_cast<const std::function<bool(HWND)> *>(lParam);
+        return (*callback)(hWnd) ? TRUE : FALSE;
+    }, reinterpret_cast<LPARAM>(&callback));
+}
+
+// Walk the direct children with GetWindow; EnumChildWindows would visit every descendant
+void Win32Backend::enumerateChildWindows(HWND parent, const std::function<bool(HWND)> &callback) {
+    TRACE_SCOPE("Win32::GetWindow");
+    const int maxChildren = 65536;  // Guards against a loop when windows are re-ordered during the walk
+    int count = 0;
+    for (HWND child = GetWindow(parent, GW_CHILD); child != NULL && count < maxChildren; child = GetWindow(child, GW_HWNDNEXT)) {
+        ++count;
+        if (!callback(child)) {
+            break;
+        }
+    }
+}
+
+// GetAncestor rather than GetParent, which returns the owner of owned top-level windows
+HWND Win32Backend::parentWindow(HWND hWnd) {
+    HWND parent = GetAncestor(hWnd, GA_PARENT);
+    return parent == GetDesktopWindow() ? NULL : parent;
+}
+
+// Owning process of a window
+DWORD Win32Backend::windowProcessId(HWND hWnd) {
+    DWORD windowProcessId = 0;
+    GetWindowThreadProcessId(hWnd, &windowProcessId);
+    return windowProcessId;
+}
+
+// Window visibility
+bool Win32Backend::isWindowVisible(HWND hWnd) {
+    return IsWindowVisible(hWnd) != FALSE;
+}
+
+// Window title (TCHAR is UTF-16 in this Unicode build)
+int Win32Backend::windowTitle(HWND hWnd, char16_t *buffer, int capacity) {
+    return GetWindowText(hWnd, reinterpret_cast<TCHAR *>(buffer), capacity);
+}
+
+// Window class name
+int Win32Backend::windowClass(HWND hWnd, char16_t *buffer, int capacity) {
+    return GetClassName(hWnd, reinterpret_cast<TCHAR *>(buffer), capacity);
+}
+
+// Window rectangle in screen coordinates
+bool Win32Backend::windowRect(HWND hWnd, RECT &rect) {
+    return GetWindowRect(hWnd, &rect) != FALSE;
+}
+
+// Visible frame from DWM; since Windows 10 the window rectangle includes invisible resize borders
+bool Win32Backend::windowFrameRect(HWND hWnd, RECT &rect) {
+    if (SUCCEEDED(DwmGetWindowAttribute(hWnd, DWMWA_EXTENDED_FRAME_BOUNDS, &rect, sizeof(rect)))) {
+        return true;
+    }
+    return GetWindowRect(hWnd, &rect) != FALSE;
+}
+
+// TopMost style
+bool Win32Backend::isTopMost(HWND hWnd) {
+    return (GetWindowLongPtr(hWnd, GWL_EXSTYLE) & WS_EX_TOPMOST) != 0;
+}
+
+// Layered window opacity
+bool Win32Backend::windowOpacity(HWND hWnd, int &opacity) {
+    BYTE alpha = 255;
+    if (!GetLayeredWindowAttributes(hWnd, NULL, &alpha, NULL)) {
+        return false;
+    }
+    opacity = static_cast<int>(alpha);
+    return true;
+}
+
+// Minimized state
+bool Win32Backend::isMinimized(HWND hWnd) {
+    return IsIconic(hWnd) != FALSE;
+}
+
+// DWM cloaking (other virtual desktops, suspended store apps)
+bool Win32Backend::isCloaked(HWND hWnd) {
+    DWORD cloaked = 0;
+    return SUCCEEDED(DwmGetWindowAttribute(hWnd, DWMWA_CLOAKED, &cloaked, sizeof(cloaked))) && cloaked != 0;
+}
+
+// Wait for create, show and name change events of top-level windows; the hook is installed before the existing
+// windows are checked, so a window appearing in between is not missed
+HWND Win32Backend::waitForWindow(const std::function<bool(HWND)> &match, int timeoutMs, const std::atomic<bool> *cancelled) {
+    TRACE_SCOPE("Win32::waitForWindow");
+    QVector<HWND> events;
+    windowEvents = &events;
+    const DWORD flags = WINEVENT_OUTOFCONTEXT | WINEVENT_SKIPOWNPROCESS;
+    HWINEVENTHOOK shownHook = SetWinEventHook(EVENT_OBJECT_CREATE, EVENT_OBJECT_SHOW, NULL, onWindowEvent, 0, 0, flags);
+    HWINEVENTHOOK renamedHook = SetWinEventHook(EVENT_OBJECT_NAMECHANGE, EVENT_OBJECT_NAMECHANGE, NULL, onWindowEvent, 0, 0, flags);
+    bool hooked = shownHook != NULL && renamedHook != NULL;
+
+    HWND found = NULL;
+    auto checkExisting = [&] {
+        enumerateWindows([&](HWND hWnd) {
+            if (match(hWnd)) {
+                found = hWnd;
+                return false;
+            }
+            return true;
+        });
+    };
+    checkExisting();
+
+    const ULONGLONG deadline = GetTickCount64() + static_cast<ULONGLONG>(qMax(0, timeoutMs));
+    while (found == NULL && !(cancelled && cancelled->load())) {
+        ULONGLONG now = GetTickCount64();
+        if (now >= deadline) {
+            break;
+        }
+        // Wake up at least every 100 ms to notice cancellation
+        DWORD wait = static_cast<DWORD>(qMin<ULONGLONG>(deadline - now, 100));
+        MsgWaitForMultipleObjectsEx(0, NULL, wait, QS_ALLINPUT, MWMO_INPUTAVAILABLE);
+
+        MSG msg;
+        while (PeekMessage(&msg, NULL, 0, 0, PM_REMOVE)) {
+            TranslateMessage(&msg);
+            DispatchMessage(&msg);
+        }
+
+        if (!hooked) {
+            checkExisting();    // No events without the hooks; fall back to looking at all windows
+        }
+        for (HWND hWnd : events) {
+            if (match(hWnd)) {
+                found = hWnd;
+                break;
+            }
+        }
+        events.clear();
+    }
+
+    if (shownHook != NULL) {
+        UnhookWinEvent(shownHook);
+    }
+    if (renamedHook != NULL) {
+        UnhookWinEvent(renamedHook);
+    }
+    windowEvents = nullptr;
+    return found;
+}
+
+// One narrow hook per event range, so the many other object events are not delivered to the thread at all
+bool Win32Backend::watchWindowLayout(const std::function<void(HWND)> &changed) {
+    for (HWINEVENTHOOK hook : layoutHooks) {
+        UnhookWinEvent(hook);
+    }
+    layoutHooks.clear();
+    layoutChanged = changed;
+    if (!changed) {
+        return true;
+    }
+
+    const DWORD ranges[][2] = {
+        { EVENT_SYSTEM_FOREGROUND, EVENT_SYSTEM_FOREGROUND },
+        { EVENT_SYSTEM_MINIMIZESTART, EVENT_SYSTEM_MINIMIZEEND },
+        { EVENT_OBJECT_DESTROY, EVENT_OBJECT_REORDER },
+        { EVENT_OBJECT_LOCATIONCHANGE, EVENT_OBJECT_LOCATIONCHANGE },
+        { EVENT_OBJECT_CLOAKED, EVENT_OBJECT_UNCLOAKED },
+    };
+    for (const auto &range : ranges) {
+        HWINEVENTHOOK hook = SetWinEventHook(range[0], range[1], NULL, onLayoutEvent, 0, 0, WINEVENT_OUTOFCONTEXT);
+        if (hook == NULL) {
+            watchWindowLayout(nullptr);     // A partial watch would miss changes silently
+            return false;
+        }
+        layoutHooks.append(hook);
+    }
+    return true;
+}
+
+#pragma endregion
+
+#pragma region Window Changes
+
+// Change the window title
+bool Win32Backend::setWindowTitle(HWND hWnd, const QString &title) {
+    TRACE_SCOPE("Win32::SetWindowText");
+    return SetWindowText(hWnd, title.toStdWString().c_str()) != FALSE;
+}
+
+// Add or remove the TopMost style
+bool Win32Backend::setTopMost(HWND hWnd, bool topMost) {
+    TRACE_SCOPE("Win32::SetWindowPos");
+    return SetWindowPos(hWnd, topMost ? HWND_TOPMOST : HWND_NOTOPMOST, 0, 0, 0, 0, SWP_NOMOVE | SWP_NOSIZE) != FALSE;
+}
+
+// Resize without moving or activating
+bool Win32Backend::resizeWindow(HWND hWnd, int width, int height) {
+    TRACE_SCOPE("Win32::SetWindowPos");
+    return SetWindowPos(hWnd, HWND_TOP, 0, 0, width, height, SWP_NOMOVE | SWP_NOACTIVATE) != FALSE;
+}
+
+// Position top-level windows together with DeferWindowPos (one redraw pass); child windows, which
+// DeferWindowPos only batches per parent, are positioned one by one in their parent's client coordinates
+bool Win32Backend::setWindowGeometries(const QVector<GeometryUpdate> &updates) {
+    TRACE_SCOPE("Win32::DeferWindowPos");
+    const UINT flags = SWP_NOZORDER | SWP_NOOWNERZORDER | SWP_NOACTIVATE;
+    bool positioned = true;
+    HDWP batch = BeginDeferWindowPos(static_cast<int>(updates.size()));
+    QVarLengthArray<GeometryUpdate, 16> deferred;   // Parent-relative rectangles in the batch so far
+
+    // A failed batch is discarded as a whole; position its windows one by one instead
+    auto applyDeferred = [&]() {
+        for (const GeometryUpdate &update : deferred) {
+            const RECT &rect = update.rect;
+            positioned &= SetWindowPos(update.hWnd, NULL, rect.left, rect.top, rect.right - rect.left,
+                                       rect.bottom - rect.top, flags) != FALSE;
+        }
+        deferred.clear();
+    };
+
+    for (const GeometryUpdate &update : updates) {
+        RECT rect = update.rect;
+        bool child = (GetWindowLongPtr(update.hWnd, GWL_STYLE) & WS_CHILD) != 0;
+        if (child) {
+            MapWindowPoints(HWND_DESKTOP, GetParent(update.hWnd), reinterpret_cast<POINT *>(&rect), 2);
+        }
+        int width = rect.right - rect.left;
+        int height = rect.bottom - rect.top;
+
+        if (!child && batch != NULL) {
+            batch = DeferWindowPos(batch, update.hWnd, NULL, rect.left, rect.top, width, height, flags);
+            if (batch != NULL) {
+                deferred.append({ update.hWnd, rect });
+                continue;
+            }
+            applyDeferred();
+        }
+        positioned &= SetWindowPos(update.hWnd, NULL, rect.left, rect.top, width, height, flags) != FALSE;
+    }
+
+    if (batch != NULL && !EndDeferWindowPos(batch)) {
+        applyDeferred();
+    }
+    return positioned;
+}
+
+// Make the window layered and set its opacity
+bool Win32Backend::setWindowOpacity(HWND hWnd, int opacity) {
+    TRACE_SCOPE("Win32::SetLayeredWindowAttributes");
+    BYTE alpha = static_cast<BYTE>(std::clamp(opacity, 0, 255));
+    SetWindowLongPtr(hWnd, GWL_EXSTYLE, GetWindowLongPtr(hWnd, GWL_EXSTYLE) | WS_EX_LAYERED);
+    return SetLayeredWindowAttributes(hWnd, 0, alpha, LWA_ALPHA) != FALSE;
+}
+
+// Maximize, minimize or restore
+bool Win32Backend::showWindow(HWND hWnd, ShowCommand command) {
+    TRACE_SCOPE("Win32::ShowWindow");
+    int showCommand = command == ShowMaximized ? SW_MAXIMIZE : command == ShowMinimized ? SW_MINIMIZE : SW_RESTORE;
+    ShowWindow(hWnd, showCommand);
+    return true;
+}
+
+// Foreground and keyboard focus (a child window is focused inside its activated top-level window)
+bool Win32Backend::focusWindow(HWND hWnd) {
+    TRACE_SCOPE("Win32::SetForegroundWindow");
+    HWND root = GetAncestor(hWnd, GA_ROOT);
+    bool focused = SetForegroundWindow(root != NULL ? root : hWnd) != FALSE;
+    SetFocus(hWnd);
+    return focused;
+}
+
+#pragma endregion
+
+// Milliseconds since boot
+qint64 Win32Backend::tickCount() {
+    return static_cast<qint64>(GetTickCount64());
+}
@@ -0,0 +1,60 @@
+#ifndef WIN32BACKEND_H
+#define WIN32BACKEND_H
+
+#include "windowbackend.h"
+
+/**
+ * @class Win32Backend
+ * @brief WindowBackend forwarding to the Windows API. Stateless apart from per-thread event hooks, so one instance
+ *        serves all threads.
+ */
+class Win32Backend : public WindowBackend {
+public:
+    Win32Backend();     // Constructor
+    ~Win32Backend();    // Destructor
+
+    #pragma region Processes
+
+    bool enumerateProcesses(const std::function<bool(const ProcessEntry &)> &callback) override;
+    bool queryResourceUsage(DWORD processId, qint64 &workingSet, qint64 &cpuTime, qint64 &creationTime) override;
+    bool terminateProcess(DWORD processId) override;
+    qint64 processCreationTime(DWORD processId) override;
+
+    #pragma endregion
+
+    #pragma region Window Queries
+
+    void enumerateWindows(const std::function<bool(HWND)> &callback) override;
+    void enumerateChildWindows(HWND parent, const std::function<bool(HWND)> &callback) override;
+    HWND parentWindow(HWND hWnd) override;
+    DWORD windowProcessId(HWND hWnd) override;
+    bool isWindowVisible(HWND hWnd) override;
+    int windowTitle(HWND hWnd, char16_t *buffer, int capacity) override;
+    int windowClass(HWND hWnd, char16_t *buffer, int capacity) override;
+    bool windowRect(HWND hWnd, RECT &rect) override;
+    bool windowFrameRect(HWND hWnd, RECT &rect) override;
+    bool isTopMost(HWND hWnd) override;
+    bool windowOpacity(HWND hWnd, int &opacity) override;
+    bool isMinimized(HWND hWnd) override;
+    bool isCloaked(HWND hWnd) override;
+    HWND waitForWindow(const std::function<bool(HWND)> &match, int timeoutMs, const std::atomic<bool> *cancelled) override;
+    bool watchWindowLayout(const std::function<void(HWND)> &changed) override;
+
+    #pragma endregion
+
+    #pragma region Window Changes
+
+    bool setWindowTitle(HWND hWnd, const QString &title) override;
+    bool setTopMost(HWND hWnd, bool topMost) override;
+    bool resizeWindow(HWND hWnd, int width, int height) override;
+    bool setWindowGeometries(const QVector<GeometryUpdate> &updates) override;
+    bool setWindowOpacity(HWND hWnd, int opacity) override;
+    bool showWindow(HWND hWnd, ShowCommand command) override;
+    bool focusWindow(HWND hWnd) override;
+
+    #pragma endregion
+
+    qint64 tickCount() override;
+};
+
+#endif // WIN32BACKEND_H
@@ -0,0 +1,328 @@
+#include "windowanimator.h"
+#include <QVector>
+#include <QtMath>
+#include <algorithm>
+#include "tracer.h"
+
+namespace {
+
+const int maxFailedFrames = 30;     // A track gives up after this many frames in a row were not applied
+
+} // namespace
+
+#pragma region Constructor and Destructor
+
+/**
+ * @brief Creates an idle animator ticking at 60 Hz.
+ */
+WindowAnimator::WindowAnimator(WindowBackend *backend, QObject *parent)
+    : QObject(parent), backend(backend ? backend : WindowBackend::systemBackend()), hz(0), frameIntervalUs(0),
+      lastTickUs(-1) {
+    frameTimer.setTimerType(Qt::PreciseTimer);
+    connect(&frameTimer, &QTimer::timeout, this, &WindowAnimator::onFrameTimer_Timeout);
+    clock.start();
+    setFrameRate(60);
+    resetFrameStatistics();
+}
+
+/**
+ * @brief Stops ticking; windows keep their current values.
+ */
+WindowAnimator::~WindowAnimator() {
+    frameTimer.stop();
+}
+
+#pragma endregion
+
+#pragma region Animations
+
+/**
+ * @brief Sets the tick rate; the timer interval is rounded down so no display frame is missed.
+ */
+void WindowAnimator::setFrameRate(double hz) {
+    this->hz = qBound(1.0, hz, 480.0);
+    frameIntervalUs = qRound64(1000000.0 / this->hz);
+    frameTimer.setInterval(qMax(1, static_cast<int>(1000.0 / this->hz)));
+}
+
+/**
+ * @brief Returns the tick rate in frames per second.
+ */
+double WindowAnimator::frameRate() const {
+    return hz;
+}
+
+/**
+ * @brief Starts an opacity transition from the current (animated or real) opacity.
+ */
+bool WindowAnimator::animateOpacity(HWND hWnd, int to, int durationMs, Easing easing) {
+    int from = 0;
+    auto it = animations.constFind(hWnd);
+    if (it != animations.constEnd() && it.value().opacity.active) {
+        from = it.value().opacity.current[0];
+    } else if (!backend->windowOpacity(hWnd, from)) {
+        return false;
+    }
+
+    int target = qBound(0, to, 255);
+    startTrack(animation(hWnd).opacity, &from, &target, 1, durationMs, easing);
+    updateTimer();
+    return true;
+}
+
+/**
+ * @brief Starts a geometry transition from the current (animated or real) rectangle.
+ */
+bool WindowAnimator::animateGeometry(HWND hWnd, const RECT &to, int durationMs, Easing easing) {
+    int from[4];
+    auto it = animations.constFind(hWnd);
+    if (it != animations.constEnd() && it.value().geometry.active) {
+        std::copy(it.value().geometry.current, it.value().geometry.current + 4, from);
+    } else {
+        RECT rect;
+        if (!backend->windowRect(hWnd, rect)) {
+            return false;
+        }
+        from[0] = rect.left;
+        from[1] = rect.top;
+        from[2] = rect.right;
+        from[3] = rect.bottom;
+    }
+
+    int target[4] = { static_cast<int>(to.left), static_cast<int>(to.top), static_cast<int>(to.right), static_cast<int>(to.bottom) };
+    startTrack(animation(hWnd).geometry, from, target, 4, durationMs, easing);
+    updateTimer();
+    return true;
+}
+
+/**
+ * @brief Stops the animations of a window, optionally applying the target values.
+ */
+void WindowAnimator::stop(HWND hWnd, bool jumpToEnd) {
+    auto it = animations.find(hWnd);
+    if (it == animations.end()) {
+        return;
+    }
+    if (jumpToEnd) {
+        applyTargets(hWnd, it.value());
+    }
+    animations.erase(it);
+    updateTimer();
+}
+
+/**
+ * @brief Stops all animations where they are.
+ */
+void WindowAnimator::stopAll() {
+    animations.clear();
+    updateTimer();
+}
+
+/**
+ * @brief Returns true if the window has a running animation.
+ */
+bool WindowAnimator::isAnimating(HWND hWnd) const {
+    return animations.contains(hWnd);
+}
+
+/**
+ * @brief Returns the number of windows with a running animation.
+ */
+int WindowAnimator::activeCount() const {
+    return static_cast<int>(animations.size());
+}
+
+// Animation entry of a window, created with both tracks inactive
+WindowAnimator::Animation &WindowAnimator::animation(HWND hWnd) {
+    auto it = animations.find(hWnd);
+    if (it == animations.end()) {
+        Animation idle = {};
+        it = animations.insert(hWnd, idle);
+    }
+    return it.value();
+}
+
+// (Re)start a track at the current time
+void WindowAnimator::startTrack(Track &track, const int *from, const int *to, int count, int durationMs, Easing easing) {
+    track.active = true;
+    track.startUs = clock.nsecsElapsed() / 1000;
+    track.durationUs = qMax(0, durationMs) * qint64(1000);
+    track.easing = easing;
+    track.failedFrames = 0;
+    for (int i = 0; i < count; ++i) {
+        track.from[i] = from[i];
+        track.to[i] = to[i];
+        track.current[i] = from[i];
+    }
+}
+
+// Compute the value of a track at a time; returns true if it differs from the last computed value
+bool WindowAnimator::advanceTrack(Track &track, qint64 nowUs, int count) {
+    double t = track.durationUs > 0 ? double(nowUs - track.startUs) / double(track.durationUs) : 1.0;
+    if (t >= 1.0) {
+        t = 1.0;
+        track.active = false;
+    }
+    double progress = ease(track.easing, qMax(0.0, t));
+
+    bool changed = false;
+    for (int i = 0; i < count; ++i) {
+        int value = track.from[i] + qRound((track.to[i] - track.from[i]) * progress);
+        changed |= value != track.current[i];
+        track.current[i] = value;
+    }
+    return changed;
+}
+
+// Keep a track running while its value is not applied, so the value is sent again next frame
+void WindowAnimator::trackApplied(Track &track, bool applied) {
+    if (applied) {
+        track.failedFrames = 0;
+        return;
+    }
+    ++track.failedFrames;
+    track.active = track.failedFrames <= maxFailedFrames;
+}
+
+// Progress curve value for t in [0, 1]
+double WindowAnimator::ease(Easing easing, double t) {
+    switch (easing) {
+    case EaseInOut:
+        return t < 0.5 ? 4 * t * t * t : 1 - qPow(-2 * t + 2, 3) / 2;
+    case EaseOut:
+        return 1 - qPow(1 - t, 3);
+    default:
+        return t;
+    }
+}
+
+#pragma endregion
+
+#pragma region Frames
+
+// Measure the tick interval, count late ticks as dropped frames and apply the frame
+void WindowAnimator::onFrameTimer_Timeout() {
+    TRACE_SCOPE("WindowAnimator::frame");
+    qint64 nowUs = clock.nsecsElapsed() / 1000;
+
+    if (lastTickUs >= 0) {
+        qint64 interval = nowUs - lastTickUs;
+        stats.lastFrameUs = interval;
+        stats.maxFrameUs = qMax(stats.maxFrameUs, interval);
+        totalFrameUs += interval;
+        ++intervals;
+        stats.averageFrameUs = totalFrameUs / intervals;
+        if (interval > frameIntervalUs + frameIntervalUs / 2) {
+            stats.droppedFrames += (interval + frameIntervalUs / 2) / frameIntervalUs - 1;
+        }
+    }
+    lastTickUs = nowUs;
+
+    applyFrame(nowUs);
+
+    qint64 applyUs = clock.nsecsElapsed() / 1000 - nowUs;
+    ++stats.frames;
+    stats.maxApplyUs = qMax(stats.maxApplyUs, applyUs);
+    totalApplyUs += applyUs;
+    stats.averageApplyUs = totalApplyUs / stats.frames;
+
+    updateTimer();
+}
+
+// Advance every animation and apply all geometry changes of the frame in one batch
+void WindowAnimator::applyFrame(qint64 nowUs) {
+    QVector<WindowBackend::GeometryUpdate> geometry;
+
+    for (auto it = animations.begin(); it != animations.end();) {
+        HWND hWnd = it.key();
+        Animation &current = it.value();
+
+        if (backend->windowProcessId(hWnd) == 0) {
+            it = animations.erase(it);  // Window closed
+            continue;
+        }
+        if (current.opacity.active && (advanceTrack(current.opacity, nowUs, 1) || current.opacity.failedFrames > 0)) {
+            trackApplied(current.opacity, backend->setWindowOpacity(hWnd, current.opacity.current[0]));
+        }
+        if (current.geometry.active && (advanceTrack(current.geometry, nowUs, 4) || current.geometry.failedFrames > 0)) {
+            const int *r = current.geometry.current;
+            WindowBackend::GeometryUpdate update = { hWnd, { r[0], r[1], r[2], r[3] } };
+            geometry.append(update);
+        }
+        ++it;
+    }
+
+    // The batch has one result; after a failure every window of the frame is sent again
+    if (!geometry.isEmpty()) {
+        bool applied = backend->setWindowGeometries(geometry);
+        for (const WindowBackend::GeometryUpdate &update : geometry) {
+            trackApplied(animations[update.hWnd].geometry, applied);
+        }
+    }
+
+    QVector<HWND> completed;
+    for (auto it = animations.begin(); it != animations.end();) {
+        const Animation &current = it.value();
+        if (current.opacity.active || current.geometry.active) {
+            ++it;
+            continue;
+        }
+        if (current.opacity.failedFrames == 0 && current.geometry.failedFrames == 0) {
+            completed.append(it.key());
+        }
+        it = animations.erase(it);      // Finished, or gave up on a window that refuses the value
+    }
+
+    for (HWND hWnd : completed) {
+        emit finished(hWnd);
+    }
+}
+
+// Apply the target values of the running tracks of a window
+void WindowAnimator::applyTargets(HWND hWnd, const Animation &animation) {
+    if (animation.opacity.active) {
+        backend->setWindowOpacity(hWnd, animation.opacity.to[0]);
+    }
+    if (animation.geometry.active) {
+        const int *r = animation.geometry.to;
+        WindowBackend::GeometryUpdate update = { hWnd, { r[0], r[1], r[2], r[3] } };
+        backend->setWindowGeometries({ update });
+    }
+}
+
+// Tick only while animations run; the first tick after a pause starts a new interval measurement
+void WindowAnimator::updateTimer() {
+    if (animations.isEmpty()) {
+        if (frameTimer.isActive()) {
+            frameTimer.stop();
+            lastTickUs = -1;
+            emit idle();
+        }
+    } else if (!frameTimer.isActive()) {
+        lastTickUs = -1;
+        frameTimer.start();
+    }
+}
+
+#pragma endregion
+
+#pragma region Frame Statistics
+
+/**
+ * @brief Returns the frame timing since the last reset.
+ */
+WindowAnimator::FrameStats WindowAnimator::frameStatistics() const {
+    return stats;
+}
+
+/**
+ * @brief Clears the frame timing.
+ */
+void WindowAnimator::resetFrameStatistics() {
+    stats = FrameStats();
+    totalFrameUs = 0;
+    totalApplyUs = 0;
+    intervals = 0;
+}
+
+#pragma endregion
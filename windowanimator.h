@@ -0,0 +1,204 @@
+#ifndef WINDOWANIMATOR_H
+#define WINDOWANIMATOR_H
+
+#include <QObject>
+#include <QHash>
+#include <QTimer>
+#include <QElapsedTimer>
+#include "platform.h" // For the HWND and RECT types
+#include "windowbackend.h"
+
+/**
+ * @class WindowAnimator
+ * @brief Runs opacity, position and size transitions of many windows at once.
+ *
+ * The animator ticks once per display frame. Each tick computes the current value of every running
+ * animation from the elapsed time and applies all geometry changes of the frame in one
+ * WindowBackend::setWindowGeometries() call; opacity is only written for windows whose value changed.
+ * Progress is based on time, not on ticks, so a late tick skips the missed frames instead of queueing
+ * them and an animation always ends on time. Skipped frames are counted in the frame statistics.
+ *
+ * A value the backend fails to apply is sent again on the following frames, so a track only ends once
+ * its target was applied. Windows that close during an animation, or that refuse a value for 30
+ * frames in a row, are dropped without finished().
+ *
+ * The animator lives on the UI thread.
+ */
+class WindowAnimator : public QObject {
+    Q_OBJECT
+
+public:
+    /**
+     * @brief Progress curves.
+     */
+    enum Easing {
+        Linear,     // Constant speed
+        EaseInOut,  // Accelerate, then decelerate (cubic)
+        EaseOut     // Decelerate towards the end (cubic)
+    };
+
+    /**
+     * @brief Frame timing since the last resetFrameStatistics(); times in microseconds.
+     */
+    struct FrameStats {
+        qint64 frames;          // Frames applied
+        qint64 droppedFrames;   // Frames skipped because a tick came late
+        qint64 lastFrameUs;     // Interval between the last two ticks
+        qint64 maxFrameUs;      // Longest interval between two ticks
+        qint64 averageFrameUs;  // Average interval between two ticks
+        qint64 averageApplyUs;  // Average time spent applying one frame
+        qint64 maxApplyUs;      // Longest time spent applying one frame
+    };
+
+    #pragma region Constructors and Destructor
+
+    /**
+     * @brief Creates an idle animator ticking at 60 Hz.
+     * @param backend The backend the values are applied through; nullptr selects WindowBackend::systemBackend().
+     *        The backend is not owned and must outlive the animator.
+     * @param parent The parent object.
+     */
+    explicit WindowAnimator(WindowBackend *backend = nullptr, QObject *parent = nullptr);
+
+    /**
+     * @brief Stops all animations where they are.
+     */
+    ~WindowAnimator();
+
+    #pragma endregion
+
+    #pragma region Animations
+
+    /**
+     * @brief Sets the tick rate, normally the refresh rate of the display.
+     * @param hz Frames per second (clamped to 1-480).
+     */
+    void setFrameRate(double hz);
+
+    /**
+     * @brief Returns the tick rate in frames per second.
+     */
+    double frameRate() const;
+
+    /**
+     * @brief Fades a window to an opacity. A running opacity animation of the window continues from its current value.
+     * @param hWnd The window.
+     * @param to The target opacity (0-255).
+     * @param durationMs The duration; 0 applies the value on the next frame.
+     * @param easing The progress curve.
+     * @return False if the current opacity of the window cannot be read.
+     */
+    bool animateOpacity(HWND hWnd, int to, int durationMs, Easing easing = EaseInOut);
+
+    /**
+     * @brief Moves and resizes a window to a rectangle. A running geometry animation of the window continues from its current value.
+     * @param hWnd The window.
+     * @param to The target rectangle in screen coordinates.
+     * @param durationMs The duration; 0 applies the value on the next frame.
+     * @param easing The progress curve.
+     * @return False if the current rectangle of the window cannot be read.
+     */
+    bool animateGeometry(HWND hWnd, const RECT &to, int durationMs, Easing easing = EaseInOut);
+
+    /**
+     * @brief Stops the animations of a window.
+     * @param hWnd The window.
+     * @param jumpToEnd Apply the target values instead of leaving the window where it is.
+     */
+    void stop(HWND hWnd, bool jumpToEnd = false);
+
+    /**
+     * @brief Stops all animations where they are.
+     */
+    void stopAll();
+
+    /**
+     * @brief Returns true if the window has a running animation.
+     */
+    bool isAnimating(HWND hWnd) const;
+
+    /**
+     * @brief Returns the number of windows with a running animation.
+     */
+    int activeCount() const;
+
+    #pragma endregion
+
+    #pragma region Frame Statistics
+
+    /**
+     * @brief Returns the frame timing since the last reset.
+     */
+    FrameStats frameStatistics() const;
+
+    /**
+     * @brief Clears the frame timing.
+     */
+    void resetFrameStatistics();
+
+    #pragma endregion
+
+signals:
+    /**
+     * @brief Emitted when all animations of a window reached their target.
+     */
+    void finished(HWND hWnd);
+
+    /**
+     * @brief Emitted after the last running animation finished or was stopped.
+     */
+    void idle();
+
+private slots:
+    void onFrameTimer_Timeout();
+
+private:
+    /**
+     * @brief One animated property.
+     */
+    struct Track {
+        bool active;            // Property is animating
+        qint64 startUs;         // Start on the animation clock
+        qint64 durationUs;      // Duration
+        Easing easing;          // Progress curve
+        int from[4];            // Start value (opacity uses from[0])
+        int to[4];              // Target value
+        int current[4];         // Last computed value
+        int failedFrames;       // Consecutive frames whose value was not applied
+    };
+
+    /**
+     * @brief Animations of one window.
+     */
+    struct Animation {
+        Track opacity;          // Opacity transition
+        Track geometry;         // Rectangle transition (left, top, right, bottom)
+    };
+
+    Animation &animation(HWND hWnd);
+    void startTrack(Track &track, const int *from, const int *to, int count, int durationMs, Easing easing);
+    bool advanceTrack(Track &track, qint64 nowUs, int count);
+    void trackApplied(Track &track, bool applied);
+    void applyFrame(qint64 nowUs);
+    void applyTargets(HWND hWnd, const Animation &animation);
+    void updateTimer();
+    static double ease(Easing easing, double t);
+
+    #pragma region Member Variables
+
+    WindowBackend *backend;                 // System calls (not owned)
+    QHash<HWND, Animation> animations;      // Running animations by window
+    QTimer frameTimer;                      // Ticks while animations run
+    QElapsedTimer clock;                    // Animation clock
+    double hz;                              // Tick rate
+    qint64 frameIntervalUs;                 // Duration of one frame
+    qint64 lastTickUs;                      // Time of the previous tick (-1 = first tick)
+    FrameStats stats;                       // Frame timing
+    qint64 totalFrameUs;                    // Sum of the tick intervals
+    qint64 totalApplyUs;                    // Sum of the apply times
+    qint64 intervals;                       // Number of measured tick intervals
+
+    #pragma endregion
+};
+
+#endif // WINDOWANIMATOR_H
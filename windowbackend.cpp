@@ -0,0 +1,11 @@
+#include "windowbackend.h"
+
+// Destructor
+WindowBackend::~WindowBackend() {}
+
+#ifndef _WIN32
+// No native backend outside Windows; callers pass their own (see tools/soak)
+WindowBackend *WindowBackend::systemBackend() {
+    return nullptr;
+}
+#endif
@@ -0,0 +1,228 @@
+#ifndef WINDOWBACKEND_H
+#define WINDOWBACKEND_H
+
+#include <QString>
+#include <QStringView>
+#include <QVector>
+#include <atomic>
+#include <functional>
+#include "platform.h"
+
+/**
+ * @class WindowBackend
+ * @brief The operating system calls ProcessManager needs, behind an interface.
+ *
+ * Win32Backend forwards to the Windows API; the soak harness provides a simulated backend so
+ * ProcessManager can be driven headless (and on Linux) under process churn. Implementations must be
+ * safe to call from several threads at once, since each thread may own its own ProcessManager.
+ */
+class WindowBackend {
+public:
+    /**
+     * @brief One entry of a process enumeration. The name is only valid during the callback.
+     */
+    struct ProcessEntry {
+        DWORD processId;        // ID of the process
+        DWORD parentProcessId;  // ID of the parent process
+        QStringView name;       // Executable name
+        int threadCount;        // Number of threads
+    };
+
+    /**
+     * @brief New position and size of one window for setWindowGeometries().
+     */
+    struct GeometryUpdate {
+        HWND hWnd;              // Window to move
+        RECT rect;              // New rectangle in screen coordinates
+    };
+
+    /**
+     * @brief Show states accepted by showWindow().
+     */
+    enum ShowCommand {
+        ShowMaximized,
+        ShowMinimized,
+        ShowRestored
+    };
+
+    virtual ~WindowBackend();
+
+    /**
+     * @brief Returns the backend of the running system (Win32Backend on Windows, nullptr elsewhere).
+     */
+    static WindowBackend *systemBackend();
+
+    #pragma region Processes
+
+    /**
+     * @brief Calls the callback for every running process until it returns false.
+     * @return False if the process list could not be read.
+     */
+    virtual bool enumerateProcesses(const std::function<bool(const ProcessEntry &)> &callback) = 0;
+
+    /**
+     * @brief Reads the working set (bytes), total CPU time (ms) and creation time (see processCreationTime())
+     *        of a process with one process handle.
+     * @return False if the process cannot be queried (e.g. protected or exited).
+     */
+    virtual bool queryResourceUsage(DWORD processId, qint64 &workingSet, qint64 &cpuTime, qint64 &creationTime) = 0;
+
+    /**
+     * @brief Terminates a process.
+     * @return False if the process could not be opened for termination.
+     */
+    virtual bool terminateProcess(DWORD processId) = 0;
+
+    /**
+     * @brief Returns a value identifying one lifetime of a process ID: two processes that used the same
+     *        ID one after the other return different values.
+     * @return The creation time of the process (Windows FILETIME units), or 0 if the process does not exist.
+     */
+    virtual qint64 processCreationTime(DWORD processId) = 0;
+
+    #pragma endregion
+
+    #pragma region Window Queries
+
+    /**
+     * @brief Calls the callback for every top-level window, topmost first, until it returns false.
+     */
+    virtual void enumerateWindows(const std::function<bool(HWND)> &callback) = 0;
+
+    /**
+     * @brief Calls the callback for every direct child of a window, topmost first, until it returns false.
+     *        Grandchildren are not visited, so the cost is proportional to the children listed.
+     */
+    virtual void enumerateChildWindows(HWND parent, const std::function<bool(HWND)> &callback) = 0;
+
+    /**
+     * @brief Returns the parent of a child window, or NULL for top-level windows and windows that no longer exist.
+     */
+    virtual HWND parentWindow(HWND hWnd) = 0;
+
+    /**
+     * @brief Returns the ID of the process owning a window, or 0 if the window no longer exists.
+     */
+    virtual DWORD windowProcessId(HWND hWnd) = 0;
+
+    /**
+     * @brief Returns true if the window is visible.
+     */
+    virtual bool isWindowVisible(HWND hWnd) = 0;
+
+    /**
+     * @brief Copies the window title into a buffer.
+     * @return The number of UTF-16 code units copied (0 on failure).
+     */
+    virtual int windowTitle(HWND hWnd, char16_t *buffer, int capacity) = 0;
+
+    /**
+     * @brief Copies the window class name into a buffer.
+     * @return The number of UTF-16 code units copied (0 on failure).
+     */
+    virtual int windowClass(HWND hWnd, char16_t *buffer, int capacity) = 0;
+
+    /**
+     * @brief Reads the window rectangle in screen coordinates.
+     */
+    virtual bool windowRect(HWND hWnd, RECT &rect) = 0;
+
+    /**
+     * @brief Reads the visible frame in screen coordinates, without the invisible resize borders that
+     *        windowRect() includes; falls back to the window rectangle where the frame is not known.
+     */
+    virtual bool windowFrameRect(HWND hWnd, RECT &rect) = 0;
+
+    /**
+     * @brief Returns true if the window has the TopMost style.
+     */
+    virtual bool isTopMost(HWND hWnd) = 0;
+
+    /**
+     * @brief Reads the window opacity (0-255).
+     * @return False if the window is not layered; opacity is left unchanged.
+     */
+    virtual bool windowOpacity(HWND hWnd, int &opacity) = 0;
+
+    /**
+     * @brief Returns true if the window is minimized.
+     */
+    virtual bool isMinimized(HWND hWnd) = 0;
+
+    /**
+     * @brief Returns true if the window is cloaked: visible, but not drawn (on another virtual desktop,
+     *        a suspended store app).
+     */
+    virtual bool isCloaked(HWND hWnd) = 0;
+
+    /**
+     * @brief Blocks until a top-level window accepted by the predicate exists. The existing windows are checked
+     *        once; after that only windows that are created, shown or renamed are passed to the predicate, so the
+     *        wait ends as soon as the window appears instead of at the next poll.
+     * @param match Returns true for the awaited window; called on the waiting thread.
+     * @param timeoutMs Maximum time to wait.
+     * @param cancelled Ends the wait early when it becomes true (optional).
+     * @return The window, or NULL on timeout or cancellation.
+     */
+    virtual HWND waitForWindow(const std::function<bool(HWND)> &match, int timeoutMs, const std::atomic<bool> *cancelled) = 0;
+
+    /**
+     * @brief Reports layout changes of top-level windows to a callback on the calling thread, which must run a
+     *        message loop: the window is passed when it moved, was resized, shown, hidden, minimized, restored,
+     *        cloaked, uncloaked or destroyed, and NULL when the z-order changed (foreground or reorder). Replaces
+     *        the previous watch of the thread.
+     * @param changed The callback; an empty function stops watching.
+     * @return False if the backend cannot report window changes.
+     */
+    virtual bool watchWindowLayout(const std::function<void(HWND)> &changed) = 0;
+
+    #pragma endregion
+
+    #pragma region Window Changes
+
+    /**
+     * @brief Changes the window title.
+     */
+    virtual bool setWindowTitle(HWND hWnd, const QString &title) = 0;
+
+    /**
+     * @brief Adds or removes the TopMost style.
+     */
+    virtual bool setTopMost(HWND hWnd, bool topMost) = 0;
+
+    /**
+     * @brief Resizes the window without moving or activating it.
+     */
+    virtual bool resizeWindow(HWND hWnd, int width, int height) = 0;
+
+    /**
+     * @brief Moves and resizes several windows in one pass, without activating them or changing the z-order.
+     *        If the pass fails part way, the remaining windows are still positioned one by one.
+     * @return False if any window could not be positioned.
+     */
+    virtual bool setWindowGeometries(const QVector<GeometryUpdate> &updates) = 0;
+
+    /**
+     * @brief Makes the window layered and sets its opacity (0-255).
+     */
+    virtual bool setWindowOpacity(HWND hWnd, int opacity) = 0;
+
+    /**
+     * @brief Maximizes, minimizes or restores the window.
+     */
+    virtual bool showWindow(HWND hWnd, ShowCommand command) = 0;
+
+    /**
+     * @brief Brings the window to the foreground and gives it keyboard focus.
+     */
+    virtual bool focusWindow(HWND hWnd) = 0;
+
+    #pragma endregion
+
+    /**
+     * @brief Returns a monotonic clock in milliseconds.
+     */
+    virtual qint64 tickCount() = 0;
+};
+
+#endif // WINDOWBACKEND_H
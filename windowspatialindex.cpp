@@ -0,0 +1,445 @@
+#include "windowspatialindex.h"
+#include <QVarLengthArray>
+#include <algorithm>
+
+namespace {
+
+const int maxCellsPerWindow = 1024;     // Larger windows go to the oversized list
+const int maxOcclusionPieces = 256;     // Give up (report visible) when coverage is this fragmented
+
+// Appends the parts of `piece` not covered by `cover`
+template <typename Pieces>
+void subtractRect(const RECT &piece, const RECT &cover, Pieces &out) {
+    if (cover.left >= piece.right || cover.right <= piece.left || cover.top >= piece.bottom || cover.bottom <= piece.top) {
+        out.append(piece);
+        return;
+    }
+
+    LONG top = std::max(piece.top, cover.top);
+    LONG bottom = std::min(piece.bottom, cover.bottom);
+    if (piece.top < cover.top) {
+        out.append(RECT{ piece.left, piece.top, piece.right, cover.top });
+    }
+    if (cover.bottom < piece.bottom) {
+        out.append(RECT{ piece.left, cover.bottom, piece.right, piece.bottom });
+    }
+    if (piece.left < cover.left) {
+        out.append(RECT{ piece.left, top, cover.left, bottom });
+    }
+    if (cover.right < piece.right) {
+        out.append(RECT{ cover.right, top, piece.right, bottom });
+    }
+}
+
+} // namespace
+
+#pragma region Constructor and Destructor
+
+/**
+ * @brief Constructs an empty index with the given cell size.
+ */
+WindowSpatialIndex::WindowSpatialIndex(int cellSize)
+    : cellSize(std::max(16, cellSize)), generation(0), visitStamp(0) {}
+
+/**
+ * @brief Destructor for WindowSpatialIndex.
+ */
+WindowSpatialIndex::~WindowSpatialIndex() {}
+
+#pragma endregion
+
+#pragma region Updates
+
+/**
+ * @brief Removes all windows and cells.
+ */
+void WindowSpatialIndex::clear() {
+    entries.clear();
+    freeEntries.clear();
+    entryByHandle.clear();
+    cells.clear();
+    oversizedEntries.clear();
+    visitMarks.clear();
+}
+
+/**
+ * @brief Starts a new generation; windows not set again are removed by endUpdate().
+ */
+void WindowSpatialIndex::beginUpdate() {
+    ++generation;
+}
+
+/**
+ * @brief Updates an existing entry in place (re-registering cells only if the rectangle changed) or adds one.
+ */
+bool WindowSpatialIndex::setWindow(HWND hWnd, DWORD processId, const RECT &rect, int zOrder, bool opaque) {
+    auto it = entryByHandle.constFind(hWnd);
+    if (it != entryByHandle.constEnd()) {
+        int index = it.value();
+        Entry &entry = entries[index];
+        entry.processId = processId;
+        entry.zOrder = zOrder;
+        entry.opaque = opaque;
+        entry.generation = generation;
+
+        if (entry.rect.left == rect.left && entry.rect.top == rect.top
+            && entry.rect.right == rect.right && entry.rect.bottom == rect.bottom) {
+            return false;
+        }
+
+        unregisterCells(index);
+        entries[index].rect = rect;
+        registerCells(index);
+        return true;
+    }
+
+    int index;
+    if (freeEntries.isEmpty()) {
+        index = entries.size();
+        entries.append(Entry());
+    } else {
+        index = freeEntries.takeLast();
+    }
+
+    Entry &entry = entries[index];
+    entry.hWnd = hWnd;
+    entry.processId = processId;
+    entry.rect = rect;
+    entry.zOrder = zOrder;
+    entry.opaque = opaque;
+    entry.generation = generation;
+    entry.oversized = false;
+    entryByHandle.insert(hWnd, index);
+    registerCells(index);
+    return true;
+}
+
+/**
+ * @brief Removes the entries of the previous generation.
+ */
+int WindowSpatialIndex::endUpdate() {
+    int removed = 0;
+    for (int index = 0; index < entries.size(); ++index) {
+        if (entries[index].hWnd != NULL && entries[index].generation != generation) {
+            removeEntry(index);
+            ++removed;
+        }
+    }
+    return removed;
+}
+
+/**
+ * @brief Removes one window.
+ */
+bool WindowSpatialIndex::removeWindow(HWND hWnd) {
+    auto it = entryByHandle.constFind(hWnd);
+    if (it == entryByHandle.constEnd()) {
+        return false;
+    }
+    removeEntry(it.value());
+    return true;
+}
+
+#pragma endregion
+
+#pragma region Queries
+
+/**
+ * @brief Returns the number of indexed windows.
+ */
+int WindowSpatialIndex::size() const {
+    return entryByHandle.size();
+}
+
+/**
+ * @brief Returns true if the window is indexed.
+ */
+bool WindowSpatialIndex::contains(HWND hWnd) const {
+    return entryByHandle.contains(hWnd);
+}
+
+/**
+ * @brief Reads the rectangle of an indexed window.
+ */
+bool WindowSpatialIndex::windowRect(HWND hWnd, RECT &rect) const {
+    auto it = entryByHandle.constFind(hWnd);
+    if (it == entryByHandle.constEnd()) {
+        return false;
+    }
+    rect = entries[it.value()].rect;
+    return true;
+}
+
+/**
+ * @brief Returns the owning process of an indexed window.
+ */
+DWORD WindowSpatialIndex::windowProcessId(HWND hWnd) const {
+    auto it = entryByHandle.constFind(hWnd);
+    return it != entryByHandle.constEnd() ? entries[it.value()].processId : 0;
+}
+
+/**
+ * @brief Returns the z-order stored with an indexed window.
+ */
+int WindowSpatialIndex::windowZOrder(HWND hWnd) const {
+    auto it = entryByHandle.constFind(hWnd);
+    return it != entryByHandle.constEnd() ? entries[it.value()].zOrder : -1;
+}
+
+/**
+ * @brief Checks the windows of one cell plus the oversized windows.
+ */
+HWND WindowSpatialIndex::windowAt(int x, int y) const {
+    const Entry *best = nullptr;
+    auto consider = [&](int index) {
+        const Entry &entry = entries[index];
+        if (x >= entry.rect.left && x < entry.rect.right && y >= entry.rect.top && y < entry.rect.bottom
+            && (best == nullptr || entry.zOrder < best->zOrder)) {
+            best = &entry;
+        }
+    };
+
+    auto cell = cells.constFind(cellKey(cellOf(x), cellOf(y)));
+    if (cell != cells.constEnd()) {
+        for (int index : cell.value()) {
+            consider(index);
+        }
+    }
+    for (int index : oversizedEntries) {
+        consider(index);
+    }
+    return best ? best->hWnd : NULL;
+}
+
+/**
+ * @brief Collects the intersecting windows and sorts them by z-order.
+ */
+QVector<HWND> WindowSpatialIndex::overlapping(const RECT &rect) const {
+    QVarLengthArray<const Entry *, 64> found;
+    forEachCandidate(rect, [&](int index) {
+        if (intersects(entries[index].rect, rect)) {
+            found.append(&entries[index]);
+        }
+    });
+    std::sort(found.begin(), found.end(), [](const Entry *a, const Entry *b) { return a->zOrder < b->zOrder; });
+
+    QVector<HWND> windows;
+    windows.reserve(found.size());
+    for (const Entry *entry : found) {
+        windows.append(entry->hWnd);
+    }
+    return windows;
+}
+
+/**
+ * @brief Same as overlapping(rect) for the rectangle of an indexed window, without the window itself.
+ */
+QVector<HWND> WindowSpatialIndex::overlapping(HWND hWnd) const {
+    RECT rect;
+    if (!windowRect(hWnd, rect)) {
+        return QVector<HWND>();
+    }
+    QVector<HWND> windows = overlapping(rect);
+    windows.removeOne(hWnd);
+    return windows;
+}
+
+/**
+ * @brief Subtracts every opaque window above from the window rectangle; occluded if nothing is left.
+ */
+bool WindowSpatialIndex::isOccluded(HWND hWnd) const {
+    auto it = entryByHandle.constFind(hWnd);
+    if (it == entryByHandle.constEnd()) {
+        return false;
+    }
+    const Entry &target = entries[it.value()];
+    if (isEmpty(target.rect)) {
+        return true;
+    }
+
+    QVarLengthArray<int, 32> occluders;
+    forEachCandidate(target.rect, [&](int index) {
+        const Entry &entry = entries[index];
+        if (entry.opaque && entry.zOrder < target.zOrder && intersects(entry.rect, target.rect)) {
+            occluders.append(index);
+        }
+    });
+    if (occluders.isEmpty()) {
+        return false;
+    }
+
+    // Large occluders first: they usually remove most of the area in one step
+    std::sort(occluders.begin(), occluders.end(), [this](int a, int b) {
+        const RECT &ra = entries[a].rect;
+        const RECT &rb = entries[b].rect;
+        return qint64(ra.right - ra.left) * (ra.bottom - ra.top) > qint64(rb.right - rb.left) * (rb.bottom - rb.top);
+    });
+
+    QVarLengthArray<RECT, 32> pieces;
+    QVarLengthArray<RECT, 32> remaining;
+    pieces.append(target.rect);
+    for (int index : occluders) {
+        remaining.clear();
+        for (const RECT &piece : pieces) {
+            subtractRect(piece, entries[index].rect, remaining);
+        }
+        if (remaining.isEmpty()) {
+            return true;
+        }
+        if (remaining.size() > maxOcclusionPieces) {
+            return false;
+        }
+        std::swap(pieces, remaining);
+    }
+    return false;
+}
+
+/**
+ * @brief Tests every indexed window.
+ */
+QVector<HWND> WindowSpatialIndex::occludedWindows() const {
+    QVector<HWND> windows;
+    for (const Entry &entry : entries) {
+        if (entry.hWnd != NULL && isOccluded(entry.hWnd)) {
+            windows.append(entry.hWnd);
+        }
+    }
+    return windows;
+}
+
+#pragma endregion
+
+#pragma region Grid
+
+// Floor division, so negative coordinates (monitors left of or above the primary) map correctly
+int WindowSpatialIndex::cellOf(int coordinate) const {
+    return coordinate >= 0 ? coordinate / cellSize : -((-coordinate + cellSize - 1) / cellSize);
+}
+
+// Packs signed cell coordinates into one hash key
+quint64 WindowSpatialIndex::cellKey(int cellX, int cellY) {
+    return (static_cast<quint64>(static_cast<quint32>(cellX)) << 32) | static_cast<quint32>(cellY);
+}
+
+// Zero-area rectangles are never hit and never overlap
+bool WindowSpatialIndex::isEmpty(const RECT &rect) {
+    return rect.right <= rect.left || rect.bottom <= rect.top;
+}
+
+// Half-open rectangle intersection
+bool WindowSpatialIndex::intersects(const RECT &a, const RECT &b) {
+    return a.left < b.right && b.left < a.right && a.top < b.bottom && b.top < a.bottom;
+}
+
+// Add an entry to the cells it covers, or to the oversized list
+void WindowSpatialIndex::registerCells(int index) {
+    Entry &entry = entries[index];
+    entry.oversized = false;
+    if (isEmpty(entry.rect)) {
+        entry.cellLeft = entry.cellTop = 0;
+        entry.cellRight = entry.cellBottom = -1;
+        return;
+    }
+
+    entry.cellLeft = cellOf(entry.rect.left);
+    entry.cellTop = cellOf(entry.rect.top);
+    entry.cellRight = cellOf(entry.rect.right - 1);
+    entry.cellBottom = cellOf(entry.rect.bottom - 1);
+
+    qint64 cellCount = qint64(entry.cellRight - entry.cellLeft + 1) * (entry.cellBottom - entry.cellTop + 1);
+    if (cellCount > maxCellsPerWindow) {
+        entry.oversized = true;
+        oversizedEntries.append(index);
+        return;
+    }
+
+    for (int cy = entry.cellTop; cy <= entry.cellBottom; ++cy) {
+        for (int cx = entry.cellLeft; cx <= entry.cellRight; ++cx) {
+            cells[cellKey(cx, cy)].append(index);
+        }
+    }
+}
+
+// Remove an entry from its cells; empty cells are dropped so the grid does not grow over time
+void WindowSpatialIndex::unregisterCells(int index) {
+    const Entry &entry = entries[index];
+    if (entry.oversized) {
+        oversizedEntries.removeOne(index);
+        return;
+    }
+
+    for (int cy = entry.cellTop; cy <= entry.cellBottom; ++cy) {
+        for (int cx = entry.cellLeft; cx <= entry.cellRight; ++cx) {
+            auto cell = cells.find(cellKey(cx, cy));
+            if (cell == cells.end()) {
+                continue;
+            }
+            cell.value().removeOne(index);
+            if (cell.value().isEmpty()) {
+                cells.erase(cell);
+            }
+        }
+    }
+}
+
+// Free an entry for reuse
+void WindowSpatialIndex::removeEntry(int index) {
+    unregisterCells(index);
+    entryByHandle.remove(entries[index].hWnd);
+    entries[index].hWnd = NULL;
+    freeEntries.append(index);
+}
+
+// Calls visit once for every entry registered in a cell touched by the rectangle and for every oversized entry
+template <typename Visitor>
+void WindowSpatialIndex::forEachCandidate(const RECT &rect, Visitor visit) const {
+    if (isEmpty(rect)) {
+        return;
+    }
+
+    if (visitMarks.size() < entries.size()) {
+        visitMarks.resize(entries.size());
+    }
+    if (++visitStamp == 0) {    // Wrapped: old stamps could collide
+        visitMarks.fill(0);
+        visitStamp = 1;
+    }
+
+    auto mark = [this, &visit](int index) {
+        if (visitMarks[index] != visitStamp) {
+            visitMarks[index] = visitStamp;
+            visit(index);
+        }
+    };
+
+    int left = cellOf(rect.left);
+    int top = cellOf(rect.top);
+    int right = cellOf(rect.right - 1);
+    int bottom = cellOf(rect.bottom - 1);
+
+    if (qint64(right - left + 1) * (bottom - top + 1) > cells.size()) {
+        // Fewer occupied cells than cells in the range: walk the occupied ones
+        for (auto cell = cells.constBegin(); cell != cells.constEnd(); ++cell) {
+            for (int index : cell.value()) {
+                mark(index);
+            }
+        }
+    } else {
+        for (int cy = top; cy <= bottom; ++cy) {
+            for (int cx = left; cx <= right; ++cx) {
+                auto cell = cells.constFind(cellKey(cx, cy));
+                if (cell != cells.constEnd()) {
+                    for (int index : cell.value()) {
+                        mark(index);
+                    }
+                }
+            }
+        }
+    }
+
+    for (int index : oversizedEntries) {
+        mark(index);
+    }
+}
+
+#pragma endregion
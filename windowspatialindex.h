@@ -0,0 +1,174 @@
+#ifndef WINDOWSPATIALINDEX_H
+#define WINDOWSPATIALINDEX_H
+
+#include <QVector>
+#include <QHash>
+#include "platform.h" // For the DWORD, HWND and RECT types
+
+/**
+ * @class WindowSpatialIndex
+ * @brief Uniform grid over window rectangles with z-order for hit-testing, overlap and occlusion queries.
+ *
+ * The desktop is divided into square cells; each cell lists the windows intersecting it, so a query only
+ * looks at the windows near its point or rectangle. Windows spanning too many cells (maximized across
+ * several monitors, parked far off-screen) are kept in a separate list that every query checks.
+ *
+ * Updates are incremental: between beginUpdate() and endUpdate() every current window is passed to
+ * setWindow(); windows whose rectangle did not change keep their cells (only their z-order is updated)
+ * and windows not passed again are removed by endUpdate().
+ *
+ * Queries reuse internal scratch state, so an index must only be used from one thread at a time.
+ */
+class WindowSpatialIndex {
+public:
+    #pragma region Constructors and Destructor
+
+    /**
+     * @brief Creates an empty index.
+     * @param cellSize Edge length of a grid cell in pixels.
+     */
+    explicit WindowSpatialIndex(int cellSize = 256);
+
+    /**
+     * @brief Destructor for WindowSpatialIndex.
+     */
+    ~WindowSpatialIndex();
+
+    #pragma endregion
+
+    #pragma region Updates
+
+    /**
+     * @brief Removes all windows.
+     */
+    void clear();
+
+    /**
+     * @brief Starts a full update pass.
+     */
+    void beginUpdate();
+
+    /**
+     * @brief Inserts a window or updates its geometry and z-order.
+     * @param hWnd The window handle.
+     * @param processId The owning process.
+     * @param rect The window rectangle in screen coordinates (right and bottom exclusive).
+     * @param zOrder Stacking position; 0 is the topmost window.
+     * @param opaque False for translucent windows, which do not hide the windows below.
+     * @return True if the window is new or its rectangle changed.
+     */
+    bool setWindow(HWND hWnd, DWORD processId, const RECT &rect, int zOrder, bool opaque = true);
+
+    /**
+     * @brief Ends an update pass, removing the windows not set since beginUpdate().
+     * @return The number of removed windows.
+     */
+    int endUpdate();
+
+    /**
+     * @brief Removes a single window.
+     * @return False if the window was not indexed.
+     */
+    bool removeWindow(HWND hWnd);
+
+    #pragma endregion
+
+    #pragma region Queries
+
+    /**
+     * @brief Returns the number of indexed windows.
+     */
+    int size() const;
+
+    /**
+     * @brief Returns true if the window is indexed.
+     */
+    bool contains(HWND hWnd) const;
+
+    /**
+     * @brief Reads the indexed rectangle of a window.
+     * @return False if the window is not indexed.
+     */
+    bool windowRect(HWND hWnd, RECT &rect) const;
+
+    /**
+     * @brief Returns the owning process of an indexed window, or 0.
+     */
+    DWORD windowProcessId(HWND hWnd) const;
+
+    /**
+     * @brief Returns the z-order of an indexed window (0 = topmost), or -1.
+     */
+    int windowZOrder(HWND hWnd) const;
+
+    /**
+     * @brief Returns the topmost window containing a point, or NULL.
+     */
+    HWND windowAt(int x, int y) const;
+
+    /**
+     * @brief Returns the windows intersecting a rectangle, topmost first.
+     */
+    QVector<HWND> overlapping(const RECT &rect) const;
+
+    /**
+     * @brief Returns the windows intersecting an indexed window (excluding itself), topmost first.
+     */
+    QVector<HWND> overlapping(HWND hWnd) const;
+
+    /**
+     * @brief Returns true if the opaque windows above an indexed window cover it completely.
+     *        Empty windows count as occluded; unknown windows and very fragmented coverage do not.
+     */
+    bool isOccluded(HWND hWnd) const;
+
+    /**
+     * @brief Returns all fully occluded windows.
+     */
+    QVector<HWND> occludedWindows() const;
+
+    #pragma endregion
+
+private:
+    /**
+     * @brief An indexed window and the cell range it is registered in.
+     */
+    struct Entry {
+        HWND hWnd;              // Window handle (NULL for free entries)
+        DWORD processId;        // Owning process
+        RECT rect;              // Screen rectangle
+        int zOrder;             // 0 = topmost
+        bool opaque;            // Hides the windows below
+        quint32 generation;     // Update pass that last set the window
+        bool oversized;         // Registered in oversizedEntries instead of cells
+        int cellLeft, cellTop, cellRight, cellBottom;   // Inclusive cell range (empty if right < left)
+    };
+
+    int cellOf(int coordinate) const;
+    static quint64 cellKey(int cellX, int cellY);
+    static bool isEmpty(const RECT &rect);
+    static bool intersects(const RECT &a, const RECT &b);
+
+    void registerCells(int index);
+    void unregisterCells(int index);
+    void removeEntry(int index);
+
+    template <typename Visitor>
+    void forEachCandidate(const RECT &rect, Visitor visit) const;
+
+    #pragma region Member Variables
+
+    int cellSize;                               // Cell edge length in pixels
+    QVector<Entry> entries;                     // Indexed windows, reused through freeEntries
+    QVector<int> freeEntries;                   // Unused entry indices
+    QHash<HWND, int> entryByHandle;             // Window handle -> entry index
+    QHash<quint64, QVector<int>> cells;         // Cell key -> entries intersecting the cell
+    QVector<int> oversizedEntries;              // Entries spanning more than maxCellsPerWindow cells
+    quint32 generation;                         // Current update pass
+    mutable QVector<quint32> visitMarks;        // Per-entry stamp used to report each entry once per query
+    mutable quint32 visitStamp;                 // Stamp of the current query
+
+    #pragma endregion
+};
+
+#endif // WINDOWSPATIALINDEX_H
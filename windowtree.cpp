@@ -0,0 +1,228 @@
+#include "windowtree.h"
+#include <QSet>
+#include "tracer.h"
+
+#pragma region Constructor and Destructor
+
+/**
+ * @brief Constructs an empty tree over the given backend.
+ */
+WindowTree::WindowTree(WindowBackend *backend, qint64 maxAgeMs)
+    : backend(backend), maxAgeMs(maxAgeMs) {}
+
+/**
+ * @brief Destructor for WindowTree.
+ */
+WindowTree::~WindowTree() {}
+
+#pragma endregion
+
+#pragma region Queries
+
+/**
+ * @brief Returns the cached children, or enumerates them when the window was never expanded or the list is too old.
+ */
+QVector<HWND> WindowTree::children(HWND parent) {
+    qint64 now = backend->tickCount();
+    auto it = nodes.constFind(parent);
+    if (it != nodes.constEnd() && it.value().expanded && now - it.value().expandedAt <= maxAgeMs) {
+        return it.value().children;
+    }
+
+    TRACE_SCOPE("WindowTree::expand");
+
+    // A destroyed window has no children; forget what was explored below it
+    if (parent != NULL && backend->windowProcessId(parent) == 0) {
+        removeSubtree(parent);
+        return QVector<HWND>();
+    }
+
+    QVector<HWND> current;
+    auto collect = [&current](HWND hWnd) {
+        current.append(hWnd);
+        return true;
+    };
+    if (parent == NULL) {
+        backend->enumerateWindows(collect);
+    } else {
+        backend->enumerateChildWindows(parent, collect);
+    }
+
+    // Keep the explored subtrees of the children that still exist, drop the others
+    QSet<HWND> currentSet;
+    currentSet.reserve(current.size());
+    for (HWND child : current) {
+        currentSet.insert(child);
+    }
+    const QVector<HWND> previous = nodes.value(parent).children;
+    for (HWND child : previous) {
+        if (!currentSet.contains(child) && nodes.value(child).parent == parent) {
+            removeSubtree(child);
+        }
+    }
+
+    for (HWND child : current) {
+        nodes[child].parent = parent;   // New windows get an unexpanded node; re-parented ones move
+    }
+
+    Node &node = nodes[parent];
+    node.children = current;
+    node.expanded = true;
+    node.expandedAt = now;
+    return current;
+}
+
+/**
+ * @brief Filters the top-level windows by owner.
+ */
+QVector<HWND> WindowTree::processWindows(DWORD processId) {
+    QVector<HWND> windows;
+    for (HWND hWnd : children(NULL)) {
+        if (backend->windowProcessId(hWnd) == processId) {
+            windows.append(hWnd);
+        }
+    }
+    return windows;
+}
+
+/**
+ * @brief Returns the parent recorded for an explored window.
+ */
+HWND WindowTree::parent(HWND hWnd) const {
+    auto it = nodes.constFind(hWnd);
+    return it != nodes.constEnd() ? it.value().parent : NULL;
+}
+
+/**
+ * @brief Walks the parents up to the top-level window.
+ */
+QVector<HWND> WindowTree::path(HWND hWnd) {
+    const int maxDepth = 256;   // Guards against a loop when windows are re-parented during the walk
+    QVector<HWND> path;
+    if (hWnd == NULL || backend->windowProcessId(hWnd) == 0) {
+        return path;
+    }
+    for (HWND current = hWnd; current != NULL && path.size() < maxDepth; current = backend->parentWindow(current)) {
+        path.prepend(current);
+    }
+    return path;
+}
+
+/**
+ * @brief Returns true if the window's children are cached.
+ */
+bool WindowTree::isExpanded(HWND hWnd) const {
+    auto it = nodes.constFind(hWnd);
+    return it != nodes.constEnd() && it.value().expanded;
+}
+
+/**
+ * @brief Depth-first search; a window's children are only enumerated when the search reaches it.
+ */
+HWND WindowTree::find(HWND root, const std::function<bool(HWND)> &predicate, int maxDepth) {
+    TRACE_SCOPE("WindowTree::find");
+    struct Pending {
+        HWND hWnd;
+        int depth;
+    };
+
+    QVector<Pending> pending;
+    auto pushChildren = [&](HWND hWnd, int depth) {
+        QVector<HWND> list = children(hWnd);
+        for (int i = list.size() - 1; i >= 0; --i) {   // Reversed, so the topmost child is visited first
+            pending.append(Pending{ list[i], depth });
+        }
+    };
+
+    pushChildren(root, 1);
+    while (!pending.isEmpty()) {
+        Pending current = pending.takeLast();
+        if (predicate(current.hWnd)) {
+            return current.hWnd;
+        }
+        if (current.depth < maxDepth) {
+            pushChildren(current.hWnd, current.depth + 1);
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief Reads the window text and state through the backend.
+ */
+WindowTree::WindowDescription WindowTree::describe(HWND hWnd) {
+    WindowDescription description;
+
+    char16_t buffer[256];
+    int length = backend->windowTitle(hWnd, buffer, 256);
+    description.title = QStringView(buffer, length).toString();
+    length = backend->windowClass(hWnd, buffer, 256);
+    description.className = QStringView(buffer, length).toString();
+
+    description.processId = backend->windowProcessId(hWnd);
+    description.visible = backend->isWindowVisible(hWnd);
+    return description;
+}
+
+/**
+ * @brief Returns the number of explored windows (the desktop node included once expanded).
+ */
+int WindowTree::size() const {
+    return nodes.size();
+}
+
+#pragma endregion
+
+#pragma region Invalidation
+
+/**
+ * @brief Keeps the window itself but forgets its children and everything below them.
+ */
+void WindowTree::invalidate(HWND hWnd) {
+    if (hWnd == NULL) {
+        clear();
+        return;
+    }
+
+    auto it = nodes.find(hWnd);
+    if (it == nodes.end()) {
+        return;
+    }
+
+    const QVector<HWND> previous = it.value().children;
+    it.value().children.clear();
+    it.value().expanded = false;
+    for (HWND child : previous) {
+        if (nodes.value(child).parent == hWnd) {
+            removeSubtree(child);
+        }
+    }
+}
+
+/**
+ * @brief Drops every node.
+ */
+void WindowTree::clear() {
+    nodes.clear();
+}
+
+// Remove a window and the windows explored below it
+void WindowTree::removeSubtree(HWND hWnd) {
+    QVector<HWND> pending;
+    pending.append(hWnd);
+    while (!pending.isEmpty()) {
+        HWND current = pending.takeLast();
+        auto it = nodes.find(current);
+        if (it == nodes.end()) {
+            continue;
+        }
+        for (HWND child : it.value().children) {
+            if (nodes.value(child).parent == current) {  // Skip windows re-parented elsewhere since they were listed
+                pending.append(child);
+            }
+        }
+        nodes.erase(it);
+    }
+}
+
+#pragma endregion
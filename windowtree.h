@@ -0,0 +1,139 @@
+#ifndef WINDOWTREE_H
+#define WINDOWTREE_H
+
+#include <QString>
+#include <QVector>
+#include <QHash>
+#include <functional>
+#include "platform.h" // For the DWORD and HWND types
+#include "windowbackend.h"
+
+/**
+ * @class WindowTree
+ * @brief Lazily explored window hierarchy: top-level windows and their child windows.
+ *
+ * Nothing is enumerated up front. The children of a window are listed through the backend the first
+ * time they are asked for and cached; a cached list is used for maxAgeMs and then refreshed on the next
+ * request, keeping the explored subtrees of the children that still exist. Memory and enumeration cost
+ * therefore grow only with the part of the hierarchy that was actually queried or shown.
+ *
+ * The NULL window stands for the desktop, whose children are the top-level windows.
+ */
+class WindowTree {
+public:
+    /**
+     * @brief Text and state of a window, read live (not cached).
+     */
+    struct WindowDescription {
+        QString title;          // Window text
+        QString className;      // Window class name
+        DWORD processId;        // Owning process (0 if the window no longer exists)
+        bool visible;           // Visibility
+    };
+
+    #pragma region Constructors and Destructor
+
+    /**
+     * @brief Creates an empty tree.
+     * @param backend The backend used to enumerate windows (not owned).
+     * @param maxAgeMs How long an enumerated child list is reused before it is refreshed.
+     */
+    explicit WindowTree(WindowBackend *backend, qint64 maxAgeMs = 2000);
+
+    /**
+     * @brief Destructor for WindowTree.
+     */
+    ~WindowTree();
+
+    #pragma endregion
+
+    #pragma region Queries
+
+    /**
+     * @brief Returns the direct children of a window in z-order, expanding it if needed.
+     * @param parent The parent window, or NULL for the top-level windows.
+     * @return The children; empty if the window has none or no longer exists.
+     */
+    QVector<HWND> children(HWND parent);
+
+    /**
+     * @brief Returns the top-level windows owned by a process, in z-order.
+     */
+    QVector<HWND> processWindows(DWORD processId);
+
+    /**
+     * @brief Returns the parent of an explored window as seen during enumeration (NULL for top-level or unknown windows).
+     */
+    HWND parent(HWND hWnd) const;
+
+    /**
+     * @brief Returns the windows from the top-level window down to a window, read live through the backend,
+     *        so the path is known even for windows that were never explored or were invalidated since.
+     * @return The path ending with hWnd; empty if the window no longer exists.
+     */
+    QVector<HWND> path(HWND hWnd);
+
+    /**
+     * @brief Returns true if the children of the window are cached.
+     */
+    bool isExpanded(HWND hWnd) const;
+
+    /**
+     * @brief Searches the subtree below a window depth-first, expanding only the windows it visits.
+     * @param root The window whose descendants are searched (NULL searches all windows).
+     * @param predicate Returns true for the window to find.
+     * @param maxDepth The number of levels below root to search.
+     * @return The first matching window, or NULL.
+     */
+    HWND find(HWND root, const std::function<bool(HWND)> &predicate, int maxDepth = 8);
+
+    /**
+     * @brief Reads the title, class, owner and visibility of a window.
+     */
+    WindowDescription describe(HWND hWnd);
+
+    /**
+     * @brief Returns the number of windows currently held in the tree.
+     */
+    int size() const;
+
+    #pragma endregion
+
+    #pragma region Invalidation
+
+    /**
+     * @brief Drops the cached children of a window and everything explored below them.
+     * @param hWnd The window, or NULL to invalidate the whole tree.
+     */
+    void invalidate(HWND hWnd);
+
+    /**
+     * @brief Drops all cached windows.
+     */
+    void clear();
+
+    #pragma endregion
+
+private:
+    /**
+     * @brief An explored window. Its children are only valid while expanded is set.
+     */
+    struct Node {
+        HWND parent = NULL;         // Parent seen during enumeration
+        QVector<HWND> children;     // Direct children in z-order
+        qint64 expandedAt = 0;      // Tick count of the last enumeration
+        bool expanded = false;      // Children are cached
+    };
+
+    void removeSubtree(HWND hWnd);
+
+    #pragma region Member Variables
+
+    WindowBackend *backend;         // Window enumeration (not owned)
+    qint64 maxAgeMs;                // Lifetime of a cached child list
+    QHash<HWND, Node> nodes;        // Explored windows; the NULL key is the desktop
+
+    #pragma endregion
+};
+
+#endif // WINDOWTREE_H
@@ -0,0 +1,246 @@
+#include "windowtreedialog.h"
+#include <QVBoxLayout>
+#include <QHBoxLayout>
+#include <QHeaderView>
+
+namespace {
+
+const int windowRole = Qt::UserRole;            // Window handle of an item
+const int populatedRole = Qt::UserRole + 1;     // Child items were added
+
+} // namespace
+
+//#region Constructor and Destructor
+
+/**
+ * Main constructor for WindowTreeDialog class.
+ * Creates the tree view, the target buttons and the status line.
+ */
+WindowTreeDialog::WindowTreeDialog(WindowTree *windowTree, QWidget *parent)
+    : QDialog(parent), windowTree(windowTree), processId(0), targetWindow(NULL)
+{
+    setWindowTitle("Window Tree");
+
+    treeWindows = new QTreeWidget(this);
+    treeWindows->setColumnCount(3);
+    treeWindows->setHeaderLabels({ "Window", "Class", "Handle" });
+    treeWindows->header()->setSectionResizeMode(0, QHeaderView::Stretch);
+
+    btnRefresh = new QPushButton("Refresh", this);
+    btnUseAsTarget = new QPushButton("Use as Target", this);
+    btnMainWindow = new QPushButton("Main Window", this);
+    lblStatus = new QLabel(this);
+
+    QHBoxLayout *buttons = new QHBoxLayout();
+    buttons->addWidget(btnRefresh);
+    buttons->addStretch();
+    buttons->addWidget(btnMainWindow);
+    buttons->addWidget(btnUseAsTarget);
+
+    QVBoxLayout *layout = new QVBoxLayout(this);
+    layout->addWidget(treeWindows);
+    layout->addLayout(buttons);
+    layout->addWidget(lblStatus);
+
+    connect(treeWindows, &QTreeWidget::itemExpanded, this, &WindowTreeDialog::onTreeWindows_ItemExpanded);
+    connect(treeWindows, &QTreeWidget::itemDoubleClicked, this, &WindowTreeDialog::onBtnUseAsTarget_Clicked);
+    connect(btnRefresh, &QPushButton::clicked, this, &WindowTreeDialog::onBtnRefresh_Clicked);
+    connect(btnUseAsTarget, &QPushButton::clicked, this, &WindowTreeDialog::onBtnUseAsTarget_Clicked);
+    connect(btnMainWindow, &QPushButton::clicked, this, &WindowTreeDialog::onBtnMainWindow_Clicked);
+
+    this->resize(560, 480);
+}
+
+/**
+ * Destructor for WindowTreeDialog class.
+ */
+WindowTreeDialog::~WindowTreeDialog()
+{
+}
+
+//#endregion
+
+//#region Slot Implementations
+
+/**
+ * Slot function called when a node is expanded.
+ * Only now are the children of that window enumerated.
+ */
+void WindowTreeDialog::onTreeWindows_ItemExpanded(QTreeWidgetItem *item)
+{
+    populate(item);
+}
+
+/**
+ * Slot function called when the "Refresh" button is clicked.
+ * Forgets the explored hierarchy and lists the windows of the process again.
+ */
+void WindowTreeDialog::onBtnRefresh_Clicked()
+{
+    windowTree->invalidate(NULL);
+    showProcess(processId, targetWindow);
+}
+
+/**
+ * Slot function called when the "Use as Target" button is clicked or an item is double-clicked.
+ * Makes the selected window the target of the window operations.
+ */
+void WindowTreeDialog::onBtnUseAsTarget_Clicked()
+{
+    QTreeWidgetItem *item = treeWindows->currentItem();
+    if (item == nullptr) {
+        return;
+    }
+
+    setTargetWindow(itemWindow(item));
+    emit targetWindowSelected(targetWindow);
+}
+
+/**
+ * Slot function called when the "Main Window" button is clicked.
+ * Removes the target window override.
+ */
+void WindowTreeDialog::onBtnMainWindow_Clicked()
+{
+    setTargetWindow(NULL);
+    treeWindows->clearSelection();
+    emit targetWindowSelected(NULL);
+}
+
+//#endregion
+
+//#region Helper Methods
+
+/**
+ * Lists the top-level windows of the process. If a target window is set, the nodes on its path are
+ * expanded (enumerating only those windows) and the target is selected.
+ */
+void WindowTreeDialog::showProcess(DWORD processId, HWND targetWindow)
+{
+    this->processId = processId;
+    this->targetWindow = targetWindow;
+
+    treeWindows->clear();
+    for (HWND hWnd : windowTree->processWindows(processId)) {
+        treeWindows->addTopLevelItem(createItem(hWnd));
+    }
+
+    if (targetWindow != NULL) {
+        // Path from the top-level window down to the target, read live so it survives a refresh
+        QTreeWidgetItem *item = nullptr;
+        for (HWND hWnd : windowTree->path(targetWindow)) {
+            QTreeWidgetItem *next = nullptr;
+            int count = item ? item->childCount() : treeWindows->topLevelItemCount();
+            for (int i = 0; i < count && next == nullptr; ++i) {
+                QTreeWidgetItem *candidate = item ? item->child(i) : treeWindows->topLevelItem(i);
+                if (itemWindow(candidate) == hWnd) {
+                    next = candidate;
+                }
+            }
+            if (next == nullptr) {
+                break;
+            }
+            if (hWnd != targetWindow) {
+                next->setExpanded(true);    // Populates through onTreeWindows_ItemExpanded
+            }
+            item = next;
+        }
+
+        if (item != nullptr && itemWindow(item) == targetWindow) {
+            treeWindows->setCurrentItem(item);
+        }
+    }
+
+    updateStatus();
+}
+
+/**
+ * Creates an item showing the title, class and handle of a window.
+ * The expand indicator is shown until the window turns out to have no children.
+ */
+QTreeWidgetItem *WindowTreeDialog::createItem(HWND hWnd)
+{
+    WindowTree::WindowDescription description = windowTree->describe(hWnd);
+
+    QString title = description.title.isEmpty() ? QString("(untitled)") : description.title;
+    if (!description.visible) {
+        title += " [hidden]";
+    }
+
+    QTreeWidgetItem *item = new QTreeWidgetItem();
+    item->setText(0, title);
+    item->setText(1, description.className);
+    item->setText(2, QString("0x%1").arg(reinterpret_cast<quintptr>(hWnd), 0, 16));
+    item->setData(0, windowRole, QVariant::fromValue(reinterpret_cast<quintptr>(hWnd)));
+    item->setChildIndicatorPolicy(QTreeWidgetItem::ShowIndicator);
+
+    if (hWnd == targetWindow) {
+        QFont font = item->font(0);
+        font.setBold(true);
+        item->setFont(0, font);
+    }
+    return item;
+}
+
+/**
+ * Adds the children of a window item, enumerating them through the window tree on first use.
+ */
+void WindowTreeDialog::populate(QTreeWidgetItem *item)
+{
+    if (item->data(0, populatedRole).toBool()) {
+        return;
+    }
+    item->setData(0, populatedRole, true);
+
+    QVector<HWND> children = windowTree->children(itemWindow(item));
+    for (HWND hWnd : children) {
+        item->addChild(createItem(hWnd));
+    }
+    if (children.isEmpty()) {
+        item->setChildIndicatorPolicy(QTreeWidgetItem::DontShowIndicatorWhenChildless);
+    }
+
+    updateStatus();
+}
+
+/**
+ * Returns the window handle stored in an item.
+ */
+HWND WindowTreeDialog::itemWindow(const QTreeWidgetItem *item)
+{
+    return reinterpret_cast<HWND>(item->data(0, windowRole).value<quintptr>());
+}
+
+/**
+ * Shows how much of the hierarchy has been enumerated.
+ */
+void WindowTreeDialog::updateStatus()
+{
+    lblStatus->setText(QString("%1 windows explored").arg(windowTree->size()));
+}
+
+/**
+ * Stores the target window and restyles the listed items; only the target is bold.
+ */
+void WindowTreeDialog::setTargetWindow(HWND hWnd)
+{
+    targetWindow = hWnd;
+
+    QVector<QTreeWidgetItem *> pending;
+    for (int i = 0; i < treeWindows->topLevelItemCount(); ++i) {
+        pending.append(treeWindows->topLevelItem(i));
+    }
+    while (!pending.isEmpty()) {
+        QTreeWidgetItem *item = pending.takeLast();
+        QFont font = item->font(0);
+        if (font.bold() != (itemWindow(item) == targetWindow)) {
+            font.setBold(itemWindow(item) == targetWindow);
+            item->setFont(0, font);
+        }
+        for (int i = 0; i < item->childCount(); ++i) {
+            pending.append(item->child(i));
+        }
+    }
+}
+
+//#endregion
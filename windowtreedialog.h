@@ -0,0 +1,103 @@
+#ifndef WINDOWTREEDIALOG_H
+#define WINDOWTREEDIALOG_H
+
+#include <QDialog>
+#include <QTreeWidget>
+#include <QPushButton>
+#include <QLabel>
+#include "windowtree.h"
+
+/**
+ * WindowTreeDialog class:
+ * Shows the windows of a process as a tree whose child windows are enumerated only when a node is expanded.
+ * Picking a window makes it the target of the window operations of the MainWindow.
+ */
+class WindowTreeDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    /**
+     * Constructor: Builds the window tree view and its buttons.
+     * @param windowTree The hierarchy to display (not owned).
+     * @param parent The parent widget.
+     */
+    explicit WindowTreeDialog(WindowTree *windowTree, QWidget *parent = nullptr);
+
+    /**
+     * Destructor: Cleans up the dialog.
+     */
+    ~WindowTreeDialog();
+
+    /**
+     * Lists the top-level windows of a process and expands the path to the current target window.
+     * @param processId The process whose windows are shown.
+     * @param targetWindow The current target window override (NULL for the main window).
+     */
+    void showProcess(DWORD processId, HWND targetWindow);
+
+signals:
+    /**
+     * Emitted when the user picks a window to operate on (NULL selects the main window again).
+     */
+    void targetWindowSelected(HWND hWnd);
+
+private slots:
+    /**
+     * Slot function: Enumerates the children of a window the first time its node is expanded.
+     */
+    void onTreeWindows_ItemExpanded(QTreeWidgetItem *item);
+
+    /**
+     * Slot function: Drops the cached hierarchy and lists the windows again.
+     */
+    void onBtnRefresh_Clicked();
+
+    /**
+     * Slot function: Makes the selected window the target window.
+     */
+    void onBtnUseAsTarget_Clicked();
+
+    /**
+     * Slot function: Targets the main window of the process again.
+     */
+    void onBtnMainWindow_Clicked();
+
+private:
+    /**
+     * Creates an unexpanded item for a window.
+     */
+    QTreeWidgetItem *createItem(HWND hWnd);
+
+    /**
+     * Adds the child items of a window item unless they were added before.
+     */
+    void populate(QTreeWidgetItem *item);
+
+    /**
+     * Returns the window handle stored in an item.
+     */
+    static HWND itemWindow(const QTreeWidgetItem *item);
+
+    /**
+     * Shows the number of explored windows.
+     */
+    void updateStatus();
+
+    /**
+     * Sets the target window and shows its item, if listed, in bold.
+     */
+    void setTargetWindow(HWND hWnd);
+
+    WindowTree *windowTree;         // Explored window hierarchy (not owned)
+    DWORD processId;                // Process whose windows are shown
+    HWND targetWindow;              // Current target window override
+
+    QTreeWidget *treeWindows;       // Displays the window hierarchy
+    QPushButton *btnRefresh;        // Re-enumerates the windows
+    QPushButton *btnUseAsTarget;    // Targets the selected window
+    QPushButton *btnMainWindow;     // Targets the main window again
+    QLabel *lblStatus;              // Shows the number of explored windows
+};
+
+#endif // WINDOWTREEDIALOG_H